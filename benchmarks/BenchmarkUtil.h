@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "mcp_sandtimer/AllocationTracker.h"
+
+// 极简计时工具：重复执行 fn 并输出每次调用的平均耗时；链接了分配钩子时同时输出每次调用的分配次数
+namespace mcp_sandtimer::bench {
+
+using mcp_sandtimer::AllocationTracker;
+
+// 防止编译器把被测结果优化掉
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+template <typename Fn>
+double Measure(const std::string& name, std::size_t iterations, Fn&& fn) {
+    for (std::size_t i = 0; i < iterations / 10 + 1; ++i) {
+        fn();
+    }
+    const std::uint64_t allocations = AllocationTracker::stats().allocations;
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    const double per_call = elapsed / static_cast<double>(iterations);
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(12) << std::fixed
+              << std::setprecision(1) << per_call << " ns/op";
+    if (AllocationTracker::installed()) {
+        // 按进程计数，后台线程（如 TimerClient 的 I/O 线程）的分配也算在内
+        const auto delta = AllocationTracker::stats().allocations - allocations;
+        std::cout << std::setw(10) << std::setprecision(2) << static_cast<double>(delta) / iterations
+                  << " allocs/op";
+    }
+    std::cout << std::endl;
+    return per_call;
+}
+
+// 在基准程序结束前输出内存占用
+inline void ReportMemory() {
+    const AllocationTracker::Stats stats = AllocationTracker::stats();
+    std::cout << "peak RSS: " << stats.peak_rss_bytes / 1024 << " KiB";
+    if (stats.installed) {
+        std::cout << ", peak live heap: " << stats.peak_live_bytes / 1024 << " KiB, " << stats.allocations
+                  << " allocations";
+    }
+    std::cout << std::endl;
+}
+
+}  // namespace mcp_sandtimer::bench
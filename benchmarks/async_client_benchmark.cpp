@@ -0,0 +1,37 @@
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtil.h"
+#include "StubSandtimer.h"
+
+// 单个线程向本地替身发送命令：逐条同步发送，与一次提交一批异步命令后等待全部完成
+int main() {
+    using mcp_sandtimer::bench::Measure;
+
+    mcp_sandtimer::testing::StubSandtimer stub;
+    mcp_sandtimer::TimerClient client("127.0.0.1", stub.port(), std::chrono::milliseconds(10000));
+    constexpr std::size_t kBatch = 64;
+    std::size_t sequence = 0;
+
+    Measure("sync start_timer", 200, [&] {
+        client.start_timer("timer-" + std::to_string(sequence++ % kBatch), 60);
+    });
+    const double batch = Measure("async start_timer x64 + wait", 10, [&] {
+        std::vector<std::future<void>> futures;
+        futures.reserve(kBatch);
+        for (std::size_t i = 0; i < kBatch; ++i) {
+            futures.push_back(client.start_timer_async("timer-" + std::to_string(i), 60));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    });
+    std::cout << "  async throughput: " << static_cast<double>(kBatch) * 1e9 / batch << " commands/s" << std::endl;
+    mcp_sandtimer::bench::ReportMemory();
+    return 0;
+}
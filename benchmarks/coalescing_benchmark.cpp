@@ -0,0 +1,89 @@
+#include "mcp_sandtimer/CommandCoalescer.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtil.h"
+#include "StubSandtimer.h"
+
+// 回放一段突发命令序列：每个 label 在几毫秒内连续发出 start/reset/cancel，多个 label 交错。
+// 对比直接发送与经过合并窗口时 sandtimer 实际收到的命令数
+namespace {
+
+using mcp_sandtimer::TimerCommand;
+using mcp_sandtimer::TimerOp;
+
+std::vector<TimerCommand> BurstTrace(int labels) {
+    const std::vector<std::vector<TimerOp>> patterns{
+        {TimerOp::Start, TimerOp::Reset, TimerOp::Reset, TimerOp::Cancel},
+        {TimerOp::Start, TimerOp::Reset, TimerOp::Reset},
+        {TimerOp::Start, TimerOp::Cancel, TimerOp::Start},
+        {TimerOp::Reset, TimerOp::Reset, TimerOp::Reset},
+    };
+    std::vector<TimerCommand> trace;
+    for (std::size_t step = 0; step < 4; ++step) {
+        for (int label = 0; label < labels; ++label) {
+            const auto& pattern = patterns[label % patterns.size()];
+            if (step < pattern.size()) {
+                trace.push_back(TimerCommand{pattern[step], "agent-" + std::to_string(label), 60});
+            }
+        }
+    }
+    return trace;
+}
+
+// 每条命令像一次独立的 tool 调用那样在自己的线程上提交，相邻两条间隔 interval
+std::size_t Replay(const std::vector<TimerCommand>& trace, std::chrono::microseconds interval,
+                   const std::function<void(const TimerCommand&)>& send) {
+    std::vector<std::future<void>> calls;
+    for (const auto& command : trace) {
+        calls.push_back(std::async(std::launch::async, [&send, command] { send(command); }));
+        std::this_thread::sleep_for(interval);
+    }
+    for (auto& call : calls) {
+        call.get();
+    }
+    return trace.size();
+}
+
+void Report(const std::string& name, std::size_t submitted, std::size_t received, double elapsed_ms) {
+    std::cout << std::left << std::setw(32) << name << std::right << std::setw(6) << submitted << " calls"
+              << std::setw(6) << received << " sent" << std::setw(10) << std::fixed << std::setprecision(1)
+              << elapsed_ms << " ms" << std::endl;
+}
+
+}  // namespace
+
+int main() {
+    const auto trace = BurstTrace(16);
+    const std::chrono::microseconds interval{500};
+
+    for (const int window : {0, 5, 20, 50}) {
+        mcp_sandtimer::testing::StubSandtimer stub;
+        mcp_sandtimer::TimerClient client("127.0.0.1", stub.port(), std::chrono::milliseconds(10000));
+        const auto begin = std::chrono::steady_clock::now();
+        std::size_t submitted = 0;
+        if (window == 0) {
+            submitted = Replay(trace, interval, [&client](const TimerCommand& command) { client.send(command); });
+        } else {
+            mcp_sandtimer::CommandCoalescer::Options options;
+            options.window = std::chrono::milliseconds(window);
+            mcp_sandtimer::CommandCoalescer coalescer(client, options);
+            submitted = Replay(trace, interval, [&coalescer](const TimerCommand& command) { coalescer.submit(command); });
+        }
+        const double elapsed =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Report(window == 0 ? "direct" : "coalesce " + std::to_string(window) + " ms", submitted,
+               stub.messages().size(), elapsed);
+    }
+    mcp_sandtimer::bench::ReportMemory();
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "mcp_sandtimer/CommandCodec.h"
+#include "mcp_sandtimer/Json.h"
+
+#include <iostream>
+#include <string>
+
+#include "BenchmarkUtil.h"
+
+// 一条 start 命令：旧的 json::Value 构造 + dump、直接写 JSON、二进制编码，以及对应的解码
+int main() {
+    using mcp_sandtimer::EncodedCommand;
+    using mcp_sandtimer::TimerCommand;
+    using mcp_sandtimer::TimerOp;
+    using mcp_sandtimer::WireFormat;
+    using mcp_sandtimer::bench::DoNotOptimize;
+    using mcp_sandtimer::bench::Measure;
+    using mcp_sandtimer::json::Value;
+
+    const TimerCommand command{TimerOp::Start, "pomodoro focus block", 1500};
+    constexpr std::size_t kIterations = 500000;
+
+    Measure("encode via json::Value + dump", kIterations, [&] {
+        Value payload = mcp_sandtimer::json::make_object({
+            {"cmd", Value(mcp_sandtimer::to_string(command.op))},
+            {"label", Value(command.label)}
+        });
+        payload.as_object()["time"] = Value(command.seconds);
+        const std::string text = payload.dump();
+        DoNotOptimize(text.size());
+    });
+    Measure("encode JSON into stack buffer", kIterations, [&] {
+        EncodedCommand encoded;
+        mcp_sandtimer::EncodeCommand(command, WireFormat::Json, encoded);
+        DoNotOptimize(encoded.view().size());
+    });
+    Measure("encode binary into stack buffer", kIterations, [&] {
+        EncodedCommand encoded;
+        mcp_sandtimer::EncodeCommand(command, WireFormat::Binary, encoded);
+        DoNotOptimize(encoded.view().size());
+    });
+
+    EncodedCommand json;
+    mcp_sandtimer::EncodeCommand(command, WireFormat::Json, json);
+    EncodedCommand binary;
+    mcp_sandtimer::EncodeCommand(command, WireFormat::Binary, binary);
+    std::cout << "  encoded size: " << json.view().size() << " bytes JSON vs " << binary.view().size()
+              << " bytes binary" << std::endl;
+    Measure("decode JSON", kIterations, [&] {
+        const TimerCommand decoded = mcp_sandtimer::DecodeCommand(json.view());
+        DoNotOptimize(decoded.seconds);
+    });
+    Measure("decode binary", kIterations, [&] {
+        const TimerCommand decoded = mcp_sandtimer::DecodeCommand(binary.view());
+        DoNotOptimize(decoded.seconds);
+    });
+    mcp_sandtimer::bench::ReportMemory();
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "mcp_sandtimer/CommandRing.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "BenchmarkUtil.h"
+#include "StubSandtimer.h"
+
+// 同一条 start 命令分别经共享内存环与回环 TCP 投递给同机的 sandtimer 替身
+int main() {
+    using mcp_sandtimer::CommandRing;
+    using mcp_sandtimer::TimerCommand;
+    using mcp_sandtimer::TimerOp;
+    using mcp_sandtimer::bench::DoNotOptimize;
+    using mcp_sandtimer::bench::Measure;
+
+    const std::string path = CommandRing::DefaultPath("mcp_sandtimer_benchmark_ring");
+    std::filesystem::remove(path);
+    const TimerCommand command{TimerOp::Start, "benchmark", 60};
+
+    {
+        // 同一线程写入再取出：记录拷贝与两端原子操作的开销，不含线程间传递
+        CommandRing consumer(path, CommandRing::Role::Consumer, 1024);
+        CommandRing producer(path, CommandRing::Role::Producer);
+        TimerCommand popped;
+        Measure("ring push + pop, same thread", 1000000, [&] {
+            producer.try_push(command);
+            consumer.try_pop(popped);
+            DoNotOptimize(popped.seconds);
+        });
+
+        // 消费者线程忙轮询，生产者写入后等待对方取走：一次完整的跨线程投递
+        std::atomic<bool> stopping{false};
+        std::thread poller([&] {
+            TimerCommand received;
+            while (!stopping.load(std::memory_order_relaxed)) {
+                if (consumer.try_pop(received)) {
+                    DoNotOptimize(received.seconds);
+                }
+            }
+        });
+        Measure("ring delivery to a busy-polling consumer", 2000, [&] {
+            producer.try_push(command);
+            // 单核机器上让出时间片，否则要等调度器切走才能看到消费者
+            while (consumer.size() != 0) {
+                std::this_thread::yield();
+            }
+        });
+        stopping = true;
+        poller.join();
+    }
+    std::filesystem::remove(path);
+
+    mcp_sandtimer::testing::SharedMemoryStub ring_stub(path);
+    mcp_sandtimer::TimerClient shared_client("127.0.0.1", 1);
+    shared_client.set_shared_memory_path(path);
+    Measure("TimerClient::send via shared memory", 20000, [&] {
+        shared_client.send(command);
+        while (ring_stub.stats().depth != 0) {
+            std::this_thread::yield();
+        }
+    });
+    ring_stub.stop();
+
+    mcp_sandtimer::testing::StubSandtimer tcp_stub;
+    mcp_sandtimer::TimerClient tcp_client("127.0.0.1", tcp_stub.port());
+    Measure("TimerClient::send via loopback TCP", 50, [&] { tcp_client.send(command); });
+    tcp_stub.stop();
+    std::filesystem::remove(path);
+    mcp_sandtimer::bench::ReportMemory();
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "mcp_sandtimer/Json.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include "BenchmarkUtil.h"
+
+// 解析吞吐量，以及恶意输入被拒绝前的开销
+int main() {
+    using mcp_sandtimer::bench::DoNotOptimize;
+    using mcp_sandtimer::bench::Measure;
+    using mcp_sandtimer::json::ParseError;
+    using mcp_sandtimer::json::PushParser;
+    using mcp_sandtimer::json::Value;
+
+    const std::string tool_call =
+        R"({"jsonrpc":"2.0","id":42,"method":"tools/call","params":{"name":"start_timer",)"
+        R"("arguments":{"label":"Tea brewing","time":180},"_meta":{"progressToken":"abc-123"}}})";
+    Measure("tools/call message (" + std::to_string(tool_call.size()) + " B)", 200000,
+            [&] { DoNotOptimize(Value::parse(tool_call)); });
+
+    std::string document = "[";
+    for (int i = 0; i < 1000; ++i) {
+        document += (i == 0 ? "" : ",");
+        document += R"({"id":)" + std::to_string(i) +
+                    R"(,"label":"timer number )" + std::to_string(i) + R"(","seconds":)" + std::to_string(i * 7) +
+                    R"(,"tags":["a","b"],"ratio":0.125,"active":true})";
+    }
+    document += "]";
+    const double per_document = Measure("1000-element array (" + std::to_string(document.size() / 1024) + " KiB)", 500,
+                                         [&] { DoNotOptimize(Value::parse(document)); });
+    std::cout << "  throughput: " << static_cast<double>(document.size()) / per_document * 1e9 / (1024 * 1024)
+              << " MiB/s" << std::endl;
+
+    // 增量解析：整段一次喂入，以及按 4 KiB / 64 B 分块（模拟逐包到达）
+    PushParser parser;
+    auto push_parse = [&](const std::string& text, std::size_t chunk) {
+        parser.reset();
+        for (std::size_t pos = 0; pos < text.size(); pos += chunk) {
+            parser.feed(text.data() + pos, std::min(chunk, text.size() - pos));
+        }
+        parser.finish();
+        DoNotOptimize(parser.take_value());
+    };
+    Measure("push parser, tools/call in one chunk", 200000, [&] { push_parse(tool_call, tool_call.size()); });
+    Measure("push parser, tools/call in 64 B chunks", 200000, [&] { push_parse(tool_call, 64); });
+    Measure("push parser, array in 4 KiB chunks", 500, [&] { push_parse(document, 4096); });
+    Measure("push parser, array in 64 B chunks", 500, [&] { push_parse(document, 64); });
+
+    // 最坏情况：超深嵌套与超限负载在分配之前被拒绝
+    const std::string deep(1 << 20, '[');
+    Measure("1 MiB of '[' (rejected at depth limit)", 1000, [&] {
+        try {
+            DoNotOptimize(Value::parse(deep));
+        } catch (const ParseError&) {
+        }
+    });
+    const std::string oversized(8 << 20, ' ');
+    Measure("8 MiB payload (rejected by size limit)", 1000, [&] {
+        try {
+            DoNotOptimize(Value::parse(oversized));
+        } catch (const ParseError&) {
+        }
+    });
+    mcp_sandtimer::bench::ReportMemory();
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "mcp_sandtimer/Logger.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "BenchmarkUtil.h"
+
+// 对比同步 std::endl 输出与异步日志在调用线程上的开销
+int main() {
+    using mcp_sandtimer::bench::Measure;
+
+    const auto directory = std::filesystem::temp_directory_path();
+    const std::string sync_path = (directory / "mcp_sandtimer_bench_sync.log").string();
+    const std::string async_path = (directory / "mcp_sandtimer_bench_async.jsonl").string();
+    const std::string method = "notifications/progress";
+
+    {
+        std::ofstream sync_log(sync_path);
+        Measure("ofstream << ... << std::endl", 100000,
+                [&] { sync_log << "Ignoring notification: " << method << std::endl; });
+    }
+
+    {
+        mcp_sandtimer::Logger logger;
+        mcp_sandtimer::Logger::Options options;
+        options.write_stderr = false;
+        options.file_path = async_path;
+        options.rate_limit_per_second = 0;
+        logger.configure(options);
+        Measure("Logger::info (ring enqueue)", 100000,
+                [&] { logger.info("notification.ignored", "Ignoring notification", method); });
+        logger.flush();
+        std::cout << "  " << logger.stats().ToJson().dump() << std::endl;
+
+        options.rate_limit_per_second = 20;
+        logger.configure(options);
+        Measure("Logger::info (rate limited)", 100000,
+                [&] { logger.info("notification.ignored", "Ignoring notification", method); });
+        Measure("Logger::debug (level filtered)", 1000000,
+                [&] { logger.debug("notification.ignored", "Ignoring notification", method); });
+    }
+
+    std::filesystem::remove(sync_path);
+    std::filesystem::remove(async_path);
+    mcp_sandtimer::bench::ReportMemory();
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include "mcp_sandtimer/MCPSandTimerServer.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "BenchmarkUtil.h"
+
+// 同样 1000 条 ping，分别以 Content-Length 与 NDJSON 分帧读入并写出回复
+int main() {
+    using mcp_sandtimer::bench::DoNotOptimize;
+    using mcp_sandtimer::bench::Measure;
+
+    constexpr int kMessages = 1000;
+    std::string framed;
+    std::string lines;
+    for (int i = 0; i < kMessages; ++i) {
+        const std::string ping = R"({"jsonrpc":"2.0","id":)" + std::to_string(i) + R"(,"method":"ping"})";
+        framed += "Content-Length: " + std::to_string(ping.size()) + "\r\n\r\n" + ping;
+        lines += ping + "\n";
+    }
+
+    auto serve = [](const std::string& text) {
+        std::istringstream input(text);
+        std::ostringstream output;
+        mcp_sandtimer::MCPSandTimerServer server(mcp_sandtimer::TimerClient("127.0.0.1", 1), input, output);
+        server.Serve();
+        DoNotOptimize(output.str().size());
+    };
+    const double content_length = Measure("1000 pings, Content-Length framing", 200, [&] { serve(framed); });
+    const double ndjson = Measure("1000 pings, NDJSON framing", 200, [&] { serve(lines); });
+    std::cout << "  per message: " << content_length / kMessages << " ns vs " << ndjson / kMessages << " ns"
+              << std::endl;
+    mcp_sandtimer::bench::ReportMemory();
+    return 0;
+}
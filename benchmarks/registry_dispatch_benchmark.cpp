@@ -0,0 +1,45 @@
+#include "mcp_sandtimer/ToolRegistry.h"
+
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtil.h"
+
+// 对比注册表查找与逐个字符串比较的 if 链在工具数量增长时的开销
+int main() {
+    using mcp_sandtimer::bench::DoNotOptimize;
+    using mcp_sandtimer::bench::Measure;
+    using mcp_sandtimer::json::Value;
+
+    for (int count : {3, 30, 300}) {
+        mcp_sandtimer::ToolRegistry registry;
+        std::vector<std::string> names;
+        for (int i = 0; i < count; ++i) {
+            names.push_back("generated_tool_" + std::to_string(i));
+            registry.register_tool(mcp_sandtimer::ToolDefinition{names.back(), "", Value::parse(R"({"type":"object"})")},
+                                   [](const Value&) { return std::string(); });
+        }
+        const std::string& last = names.back();
+        Measure("if-chain, last of " + std::to_string(count), 1000000, [&] {
+            for (const auto& name : names) {
+                if (name == last) {
+                    DoNotOptimize(&name);
+                    break;
+                }
+            }
+        });
+        Measure("registry, last of " + std::to_string(count), 1000000,
+                [&] { DoNotOptimize(registry.find_tool(last)); });
+    }
+
+    // tools/list 结果共享预生成的定义节点，而不是逐个深拷贝 schema
+    mcp_sandtimer::ToolRegistry builtins;
+    for (const auto& definition : mcp_sandtimer::GetToolDefinitions()) {
+        builtins.register_tool(definition, [](const Value&) { return std::string(); });
+    }
+    Measure("tool_list(), builtin tools", 200000, [&] { DoNotOptimize(builtins.tool_list()); });
+    Measure("ToolDefinition::ToJson(), start_timer", 200000,
+            [&] { DoNotOptimize(mcp_sandtimer::GetToolDefinitions().front().ToJson()); });
+    mcp_sandtimer::bench::ReportMemory();
+    return 0;
+}
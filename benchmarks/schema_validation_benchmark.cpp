@@ -0,0 +1,63 @@
+#include "mcp_sandtimer/SchemaValidator.h"
+#include "mcp_sandtimer/ToolDefinition.h"
+
+#include <cctype>
+#include <string>
+
+#include "BenchmarkUtil.h"
+
+namespace {
+
+using mcp_sandtimer::json::Value;
+
+std::string Trim(const std::string& value) {
+    std::size_t start = 0;
+    while (start < value.size() && std::isspace(static_cast<unsigned char>(value[start]))) {
+        ++start;
+    }
+    std::size_t end = value.size();
+    while (end > start && std::isspace(static_cast<unsigned char>(value[end - 1]))) {
+        --end;
+    }
+    return value.substr(start, end - start);
+}
+
+// 旧版 HandleStart/ExtractLabel 中手写的参数检查
+bool AdHocValidateStart(const Value& arguments) {
+    const auto& object = arguments.as_object();
+    auto iter = object.find("label");
+    if (iter == object.end() || !iter->second.is_string()) {
+        return false;
+    }
+    if (Trim(iter->second.as_string()).empty()) {
+        return false;
+    }
+    auto time_iter = object.find("time");
+    if (time_iter == object.end() || !time_iter->second.is_number()) {
+        return false;
+    }
+    return time_iter->second.as_number() > 0;
+}
+
+}  // namespace
+
+int main() {
+    using mcp_sandtimer::bench::DoNotOptimize;
+    using mcp_sandtimer::bench::Measure;
+
+    const auto validator =
+        mcp_sandtimer::SchemaValidator::compile(mcp_sandtimer::FindToolDefinition("start_timer")->input_schema);
+    const Value valid = Value::parse(R"({"label":"a fairly descriptive timer label","time":180})");
+    const Value invalid = Value::parse(R"({"label":"tea","time":0})");
+    constexpr std::size_t kIterations = 2000000;
+
+    Measure("ad-hoc checks (valid)", kIterations, [&] { DoNotOptimize(AdHocValidateStart(valid)); });
+    Measure("compiled schema (valid)", kIterations, [&] { DoNotOptimize(validator.validate(valid)); });
+    Measure("ad-hoc checks (invalid)", kIterations, [&] { DoNotOptimize(AdHocValidateStart(invalid)); });
+    Measure("compiled schema (invalid, no error detail)", kIterations, [&] { DoNotOptimize(validator.validate(invalid)); });
+    mcp_sandtimer::ValidationError error;
+    Measure("compiled schema (invalid, with error path)", kIterations / 4,
+            [&] { DoNotOptimize(validator.validate(invalid, &error)); });
+    mcp_sandtimer::bench::ReportMemory();
+    return 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp_sandtimer/Json.h"
+
+// 堆分配统计：src/AllocationHooks.cpp 替换全局 operator new/delete，把每次分配计入
+// 当前线程所在的标签、全局计数与线程计数。只有链接了该文件的程序才有数据
+// （mcp-sandtimer 需以 -DENABLE_ALLOCATION_TRACKING=ON 构建），否则 installed() 为 false、计数恒为 0。
+// 峰值 RSS 来自操作系统，与是否安装钩子无关
+namespace mcp_sandtimer {
+
+// 分配所属的子系统，由 AllocationScope 按线程设置
+enum class AllocationTag : std::uint8_t { Other = 0, JsonParser = 1, Framing = 2, TimerClient = 3 };
+
+const char* to_string(AllocationTag tag) noexcept;
+
+class AllocationTracker {
+public:
+    static constexpr std::size_t kTagCount = 4;
+
+    struct TagStats {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;  // 累计分配的字节数
+        std::int64_t live_bytes = 0;
+    };
+
+    struct Stats {
+        bool installed = false;
+        std::uint64_t allocations = 0;
+        std::uint64_t deallocations = 0;
+        std::int64_t live_bytes = 0;
+        std::int64_t peak_live_bytes = 0;
+        std::size_t peak_rss_bytes = 0;
+        std::array<TagStats, kTagCount> tags{};
+
+        json::Value ToJson() const;
+    };
+
+    static bool installed() noexcept { return installed_.load(std::memory_order_relaxed); }
+    // 当前线程累计的分配次数；前后两次读数之差即一段代码的分配次数
+    static std::uint64_t thread_allocations() noexcept { return thread_allocations_; }
+    static Stats stats() noexcept;
+    // 进程的峰值常驻内存，无法获取时为 0
+    static std::size_t peak_rss_bytes() noexcept;
+
+    // 以下只由 AllocationHooks.cpp 中的 operator new/delete 调用
+    static void mark_installed() noexcept { installed_.store(true, std::memory_order_relaxed); }
+    static AllocationTag current_tag() noexcept { return current_tag_; }
+    static void record_allocation(std::size_t size, AllocationTag tag) noexcept;
+    static void record_deallocation(std::size_t size, AllocationTag tag) noexcept;
+
+private:
+    friend class AllocationScope;
+
+    struct TagCounters {
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> bytes{0};
+        std::atomic<std::int64_t> live_bytes{0};
+    };
+
+    static std::atomic<bool> installed_;
+    static std::atomic<std::uint64_t> deallocations_;
+    static std::atomic<std::int64_t> live_bytes_;
+    static std::atomic<std::int64_t> peak_live_bytes_;
+    static TagCounters tags_[kTagCount];
+    static thread_local std::uint64_t thread_allocations_;
+    static thread_local AllocationTag current_tag_;
+};
+
+// 在作用域内把当前线程的分配计入 tag，离开时恢复之前的标签，可以嵌套
+class AllocationScope {
+public:
+    explicit AllocationScope(AllocationTag tag) noexcept : previous_(AllocationTracker::current_tag_) {
+        AllocationTracker::current_tag_ = tag;
+    }
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+    ~AllocationScope() { AllocationTracker::current_tag_ = previous_; }
+
+private:
+    AllocationTag previous_;
+};
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "mcp_sandtimer/Json.h"
+
+// 针对单个 sandtimer 端点的熔断器：连续失败达到阈值后打开，
+// 打开期间直接拒绝请求；冷却结束或后台探测成功后进入半开状态放行一次试探。
+// 线程安全；关闭状态下的 allow_request/record_success/state 只读写原子变量，不加锁。
+namespace mcp_sandtimer {
+
+class CircuitBreaker {
+public:
+    using clock = std::chrono::steady_clock;
+
+    enum class State { Closed, Open, HalfOpen };
+
+    struct Options {
+        int failure_threshold = 3;                      // 连续失败多少次后打开
+        std::chrono::milliseconds open_interval{2000};  // 打开后多久允许半开试探
+        std::chrono::milliseconds probe_interval{500};  // 打开期间后台探测的间隔
+    };
+
+    struct Stats {
+        State state = State::Closed;
+        int consecutive_failures = 0;
+        std::uint64_t successes = 0;
+        std::uint64_t failures = 0;
+        std::uint64_t rejected = 0;
+        std::uint64_t abandoned = 0;
+        std::uint64_t opened = 0;       // Closed/HalfOpen -> Open 次数
+        std::uint64_t half_opened = 0;  // Open -> HalfOpen 次数
+        std::uint64_t closed = 0;       // HalfOpen -> Closed 次数
+
+        json::Value ToJson() const;
+    };
+
+    CircuitBreaker();
+    explicit CircuitBreaker(Options options);
+
+    // 请求前调用；返回 false 表示熔断中，调用方应立即失败
+    bool allow_request();
+    void record_success();
+    // 返回 true 表示这次失败使熔断器进入打开状态
+    bool record_failure();
+    // 调用被取消或超出调用方截止时间：不计成败，只归还半开状态的试探名额
+    void record_abandoned();
+    // 后台探测连通后调用，提前进入半开状态
+    void record_probe_success();
+
+    State state() const;
+    Stats stats() const;
+    const Options& options() const noexcept { return options_; }
+
+private:
+    Options options_;
+    mutable std::mutex mutex_;
+    Stats stats_;  // successes 以 successes_ 为准
+    // 以下原子变量在 mutex_ 内更新，供无锁快路径读取
+    std::atomic<State> state_{State::Closed};
+    std::atomic<bool> healthy_{true};  // Closed 且没有连续失败，record_success 无需改动任何状态
+    std::atomic<std::uint64_t> successes_{0};
+    clock::time_point open_until_{};
+    bool trial_in_flight_ = false;
+
+    void open_locked();
+    void publish_locked();
+};
+
+const char* to_string(CircuitBreaker::State state) noexcept;
+
+}  // namespace mcp_sandtimer
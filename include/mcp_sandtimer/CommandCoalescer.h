@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/TimerClient.h"
+#include "mcp_sandtimer/TimerCommand.h"
+
+// 发往 TimerClient 之前的合并窗口：每条命令先停留 window，期间同一 label 上被取代的命令不再发送。
+// start/cancel 取代该 label 之前所有待发命令；紧跟在待发 start/reset 之后的 reset 并入前一条。
+// 留下的命令按提交顺序交给 TimerClient 的异步接口，调用方阻塞到自己的命令（或取代它的命令）有结果
+namespace mcp_sandtimer {
+
+class CommandCoalescer {
+public:
+    // 一条命令的去向
+    enum class Outcome {
+        Sent,        // 原样发出并已送达
+        Merged,      // 并入同一 label 上待发的 start/reset，随其送达
+        Superseded,  // 被同一 label 上后来的 start/cancel 取代，没有发出
+    };
+
+    struct Options {
+        std::chrono::milliseconds window{20};
+    };
+
+    struct Stats {
+        std::uint64_t submitted = 0;
+        std::uint64_t sent = 0;  // 实际交给 TimerClient 的命令数
+        std::uint64_t merged = 0;
+        std::uint64_t superseded = 0;
+        std::uint64_t withdrawn = 0;  // 等待期间被取消或超过截止时间而撤回的命令
+        std::uint64_t failed = 0;
+        std::size_t pending = 0;
+
+        json::Value ToJson() const;
+    };
+
+    CommandCoalescer(TimerClient client, Options options);
+    CommandCoalescer(const CommandCoalescer&) = delete;
+    CommandCoalescer& operator=(const CommandCoalescer&) = delete;
+    // 立即发出所有待发命令并等待它们完成
+    ~CommandCoalescer();
+
+    // 阻塞直到命令有结果。送达失败时抛出 TimerClientError；
+    // 还在窗口内时被取消或超过截止时间则撤回并抛出 RequestCancelledError / DeadlineExceededError
+    Outcome submit(const TimerCommand& command, const CallOptions& options = {});
+
+    Stats stats() const;
+    const Options& options() const noexcept { return options_; }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Ticket {
+        Outcome outcome = Outcome::Sent;
+        std::exception_ptr error;
+        bool done = false;
+    };
+    struct Pending {
+        TimerCommand command;
+        clock::time_point due;
+        std::vector<std::shared_ptr<Ticket>> tickets;  // 第一张属于提交这条命令的调用，其余是并入的 reset
+        bool live = true;
+    };
+
+    TimerClient client_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_;  // 有新命令或需要停止
+    std::condition_variable done_;  // 有命令得到结果
+    std::deque<Pending> queue_;
+    std::uint64_t first_sequence_ = 0;  // queue_.front() 的序号
+    // label -> 队列中仍待发的命令序号，按提交顺序
+    std::unordered_map<Label, std::vector<std::uint64_t>> pending_by_label_;
+    std::size_t in_flight_ = 0;
+    bool stopping_ = false;
+    Stats stats_;
+    std::thread flusher_;
+
+    Pending& at_locked(std::uint64_t sequence) { return queue_[sequence - first_sequence_]; }
+    void resolve_locked(Ticket& ticket, std::exception_ptr error);
+    bool withdraw_locked(const TimerCommand& command, const std::shared_ptr<Ticket>& ticket);
+    void dispatch(Pending pending);
+    void run();
+};
+
+const char* to_string(CommandCoalescer::Outcome outcome) noexcept;
+
+}  // namespace mcp_sandtimer
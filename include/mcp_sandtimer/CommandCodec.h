@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "mcp_sandtimer/TimerCommand.h"
+
+// 发往 sandtimer 的命令编码。JSON 是现有 GUI 能识别的格式；二进制格式为定长头 + label 字节：
+//   [0] 0xA5 魔数  [1] 版本  [2] op  [3] 保留  [4..7] seconds (int32)  [8..11] label 长度 (uint32)，小端
+// 魔数不可能是 JSON 文本的首字节，接收端据此在同一端口上区分两种格式。
+// 两种编码都直接写入调用方栈上的缓冲区，不构造 json::Value。
+namespace mcp_sandtimer {
+
+enum class WireFormat { Json, Binary };
+
+class CommandCodecError : public std::runtime_error {
+public:
+    explicit CommandCodecError(const std::string& message);
+};
+
+// 编码结果：常见长度的 label 放在对象内的定长缓冲区里，只有超长时才分配
+class EncodedCommand {
+public:
+    static constexpr std::size_t kInlineCapacity = 512;
+
+    EncodedCommand() = default;
+    EncodedCommand(const EncodedCommand&) = delete;
+    EncodedCommand& operator=(const EncodedCommand&) = delete;
+
+    std::string_view view() const noexcept { return {heap_.empty() ? inline_.data() : heap_.data(), size_}; }
+
+    // 预留至少 capacity 字节并返回写入位置；commit 记录实际写入的长度
+    char* reserve(std::size_t capacity);
+    void commit(std::size_t size) noexcept { size_ = size; }
+
+private:
+    std::array<char, kInlineCapacity> inline_;
+    std::string heap_;
+    std::size_t size_ = 0;
+};
+
+namespace codec {
+constexpr unsigned char kBinaryMagic = 0xA5;
+constexpr std::uint8_t kBinaryVersion = 1;
+constexpr std::size_t kBinaryHeaderSize = 12;
+}  // namespace codec
+
+void EncodeCommand(const TimerCommand& command, WireFormat format, EncodedCommand& out);
+// 按首字节识别格式并解码；格式错误或字段缺失时抛出 CommandCodecError
+TimerCommand DecodeCommand(std::string_view payload);
+// 只识别格式不解码：首字节为魔数时是二进制，否则按 JSON 处理
+WireFormat DetectWireFormat(std::string_view payload) noexcept;
+
+const char* to_string(WireFormat format) noexcept;
+// 解析 "json" / "binary"，无法识别时抛出 std::invalid_argument
+WireFormat ParseWireFormat(const std::string& text);
+
+}  // namespace mcp_sandtimer
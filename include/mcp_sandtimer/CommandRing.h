@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/TimerCommand.h"
+
+// 同机 sandtimer 的共享内存命令通道：单生产者/单消费者的无锁环，记录定长。
+// 生产者只写 head、消费者只写 tail；消费者空闲时睡在共享的 futex 字上，
+// 生产者仅在对方睡眠时才发起唤醒，消费者忙轮询时投递一条命令不经过任何系统调用。
+namespace mcp_sandtimer {
+
+class MappedFile;
+
+class CommandRingError : public std::runtime_error {
+public:
+    explicit CommandRingError(const std::string& message);
+};
+
+class CommandRing {
+public:
+    enum class Role { Producer, Consumer };
+
+    struct Stats {
+        std::size_t capacity = 0;
+        std::size_t depth = 0;
+        std::uint64_t pushed = 0;
+        std::uint64_t popped = 0;
+        std::uint64_t wakeups = 0;  // 生产者发起的 futex 唤醒次数
+        bool consumer_online = false;
+
+        json::Value ToJson() const;
+    };
+
+    static constexpr std::size_t kMaxLabelLength = 200;
+    static constexpr std::size_t kDefaultCapacity = 1024;
+
+    // 消费者创建区域（已有且格式相同则保留未取走的命令）并标记在线；
+    // 生产者只打开消费者建好的区域，区域不存在或格式不符时抛出 CommandRingError
+    CommandRing(const std::string& path, Role role, std::size_t capacity = kDefaultCapacity);
+    CommandRing(const CommandRing&) = delete;
+    CommandRing& operator=(const CommandRing&) = delete;
+    ~CommandRing();
+
+    // 共享内存区域的默认位置：Linux 上是 /dev/shm 下的文件（等同 shm_open），其他平台放在临时目录
+    static std::string DefaultPath(const std::string& name);
+
+    // 生产者：写入一条命令，环满时返回 false；label 超过 kMaxLabelLength 时抛出 CommandRingError
+    bool try_push(const TimerCommand& command);
+    // 消费者：取出一条命令，环空时返回 false
+    bool try_pop(TimerCommand& command);
+    // 消费者：先自旋等待，仍为空时睡眠直到有命令或超时
+    bool pop(TimerCommand& command, std::chrono::milliseconds timeout);
+
+    bool consumer_online() const noexcept;
+    std::size_t capacity() const noexcept { return capacity_; }
+    std::size_t size() const noexcept;
+    Stats stats() const;
+    Role role() const noexcept { return role_; }
+    const std::string& path() const noexcept { return path_; }
+
+private:
+    struct Header;
+    struct Record;
+
+    std::string path_;
+    Role role_;
+    std::unique_ptr<MappedFile> file_;
+    Header* header_ = nullptr;
+    Record* records_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::uint64_t mask_ = 0;
+    // 生产者缓存的 tail，只有看起来满了才重新读取，避免每次都拉取消费者的缓存行
+    std::uint64_t cached_tail_ = 0;
+
+    void initialize();
+    void wake_consumer();
+};
+
+}  // namespace mcp_sandtimer
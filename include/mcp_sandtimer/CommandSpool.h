@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/TimerClient.h"
+#include "mcp_sandtimer/TimerCommand.h"
+
+// 落盘的出站命令队列：sandtimer 不可达时先把命令写入内存映射的环形文件，
+// 由后台线程按顺序补发。进程重启后未送达的命令会继续发送。
+namespace mcp_sandtimer {
+
+class MappedFile;
+
+class SpoolError : public std::runtime_error {
+public:
+    explicit SpoolError(const std::string& message);
+};
+
+class CommandSpool {
+public:
+    // 队列满时的处理策略
+    enum class Backpressure { Reject, DropOldest, Block };
+
+    struct Options {
+        std::string path;
+        std::size_t capacity = 1024;                     // 环形文件中的记录槽数
+        Backpressure backpressure = Backpressure::Reject;
+        std::chrono::milliseconds block_timeout{1000};   // Block 策略下最长等待时间
+        std::chrono::milliseconds retry_interval{500};   // 发送失败后的重试间隔
+    };
+
+    struct Stats {
+        std::size_t depth = 0;  // 环中尚未释放的记录数（含已被覆盖的）
+        std::uint64_t appended = 0;
+        std::uint64_t delivered = 0;
+        std::uint64_t superseded = 0;
+        std::uint64_t dropped = 0;
+        std::uint64_t rejected = 0;
+        std::uint64_t send_failures = 0;
+        std::uint64_t recovered = 0;  // 启动时从文件中恢复的待发命令
+
+        json::Value ToJson() const;
+    };
+
+    static constexpr std::size_t kMaxLabelLength = 200;
+
+    // 打开（或创建）spool 文件并启动后台发送线程
+    CommandSpool(TimerClient client, Options options);
+    CommandSpool(const CommandSpool&) = delete;
+    CommandSpool& operator=(const CommandSpool&) = delete;
+    ~CommandSpool();
+
+    // 追加一条命令，同一 label 上被取代的待发命令会被合并掉。队列满且策略不允许时抛出 SpoolError
+    void append(const TimerCommand& command);
+
+    std::size_t pending() const;
+    bool wait_until_drained(std::chrono::milliseconds timeout) const;
+    Stats stats() const;
+    const Options& options() const noexcept { return options_; }
+
+private:
+    struct Header;
+    struct Record;
+
+    TimerClient client_;
+    Options options_;
+    std::unique_ptr<MappedFile> file_;
+    Header* header_ = nullptr;
+    Record* records_ = nullptr;
+
+    mutable std::mutex mutex_;
+    mutable std::condition_variable work_;   // 有新命令或需要停止
+    mutable std::condition_variable space_;  // 有空槽或队列清空
+    bool stopping_ = false;
+    Stats stats_;
+    // label -> 环中待发记录的位置，用于合并被取代的命令
+    std::unordered_map<Label, std::vector<std::uint64_t>> pending_by_label_;
+    std::thread sender_;
+
+    Record& slot(std::uint64_t position) const;
+    void initialize_file();
+    void recover();
+    void release_head_locked();
+    void run();
+};
+
+const char* to_string(CommandSpool::Backpressure policy) noexcept;
+// 解析 "reject" / "drop-oldest" / "block"，无法识别时抛出 std::invalid_argument
+CommandSpool::Backpressure ParseBackpressure(const std::string& text);
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 一致性哈希环：每个节点在环上放置若干虚拟节点，key 归属顺时针方向遇到的第一个虚拟节点。
+// 虚拟节点的位置只取决于节点自身的名字，增删一个节点只会移动约 1/N 的 key。
+namespace mcp_sandtimer {
+
+class HashRing {
+public:
+    static constexpr std::size_t kDefaultVirtualNodes = 160;
+
+    HashRing() = default;
+    explicit HashRing(const std::vector<std::string>& nodes, std::size_t virtual_nodes = kDefaultVirtualNodes);
+
+    std::size_t node_count() const noexcept { return node_count_; }
+    bool empty() const noexcept { return points_.empty(); }
+
+    // key 所属节点的下标（对应构造时 nodes 中的位置）；环为空时返回 0
+    std::size_t locate(std::string_view key) const noexcept { return locate(key, [](std::size_t) { return true; }); }
+
+    // 跳过 usable 返回 false 的节点，顺时针继续寻找；全部不可用时返回原本的归属节点。
+    // 只有落在不可用节点上的 key 会被转移，其余 key 的归属不变
+    template <typename Usable>
+    std::size_t locate(std::string_view key, Usable&& usable) const {
+        if (points_.empty()) {
+            return 0;
+        }
+        const std::uint64_t hash = Hash(key);
+        auto it = std::lower_bound(points_.begin(), points_.end(), hash,
+                                   [](const Point& point, std::uint64_t value) { return point.hash < value; });
+        const std::size_t start = it == points_.end() ? 0 : static_cast<std::size_t>(it - points_.begin());
+        const std::size_t owner = points_[start].node;
+        for (std::size_t step = 0; step < points_.size(); ++step) {
+            const std::size_t node = points_[(start + step) % points_.size()].node;
+            if (usable(node)) {
+                return node;
+            }
+        }
+        return owner;
+    }
+
+    // 节点在环上占据的比例（各虚拟节点负责的弧长之和），用于观察负载是否均衡
+    std::vector<double> ownership() const;
+
+    // FNV-1a 后接 64 位混合，短 key 也能均匀分布
+    static std::uint64_t Hash(std::string_view key) noexcept;
+
+private:
+    struct Point {
+        std::uint64_t hash;
+        std::uint32_t node;
+    };
+
+    std::vector<Point> points_;
+    std::size_t node_count_ = 0;
+};
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+// 重试的 tools/call 的幂等缓存：按 key 保存成功的结果，有界 LRU，条目在 ttl 后过期。
+// 同一 key 正在执行时，后到的调用等待它的结果（single-flight），不重复执行；
+// 执行失败的结果不缓存，等待者中的一个重新执行
+namespace mcp_sandtimer {
+
+class IdempotencyCache {
+public:
+    struct Options {
+        std::size_t capacity = 1024;
+        std::chrono::milliseconds ttl{10000};
+    };
+
+    // 结果的来源
+    enum class Source {
+        Computed,  // 本次调用执行得到
+        Cached,    // 取自未过期的缓存
+        Joined,    // 等待同一 key 上正在执行的调用得到
+    };
+
+    struct Result {
+        std::string value;
+        Source source = Source::Computed;
+    };
+
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t joined = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t expired = 0;
+        std::uint64_t evicted = 0;
+        std::size_t entries = 0;
+        std::size_t in_flight = 0;
+
+        json::Value ToJson() const;
+    };
+
+    explicit IdempotencyCache(Options options);
+    IdempotencyCache(const IdempotencyCache&) = delete;
+    IdempotencyCache& operator=(const IdempotencyCache&) = delete;
+
+    // 有未过期的结果时直接返回；同一 key 正在执行时等待；否则在当前线程执行 compute 并缓存结果。
+    // compute 的异常原样抛给本次调用；等待期间被取消或超过截止时间时抛出 RequestCancelledError / DeadlineExceededError
+    Result run(const std::string& key, const CallOptions& options, const std::function<std::string()>& compute);
+
+    Stats stats() const;
+    const Options& options() const noexcept { return options_; }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string key;
+        std::string value;
+        clock::time_point expires;
+    };
+    struct Flight {
+        std::string value;
+        bool done = false;
+        bool failed = false;
+    };
+
+    Options options_;
+    mutable std::mutex mutex_;
+    std::condition_variable done_;
+    std::list<Entry> entries_;  // 最近使用的在前
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights_;
+    Stats stats_;
+
+    void store_locked(const std::string& key, const std::string& value);
+};
+
+const char* to_string(IdempotencyCache::Source source) noexcept;
+
+}  // namespace mcp_sandtimer
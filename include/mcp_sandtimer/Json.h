@@ -1,11 +1,14 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <initializer_list>
 #include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -18,11 +21,21 @@ public:
 };
 // JSON 解析错误时抛出的异常类型，继承自 std::runtime_error
 
+// 解析上限：超出时抛出 ParseError，且在为超限部分分配内存之前就拒绝
+struct ParseLimits {
+    std::size_t max_depth = 128;                      // 对象/数组的最大嵌套层数
+    std::size_t max_payload = 4 * 1024 * 1024;        // 单个文档的最大字节数
+    std::size_t max_string_length = 1024 * 1024;      // 单个字符串（含键）解码后的最大字节数
+};
+
+// 多个线程可以同时读取、拷贝同一个 Value；修改（非 const 访问）必须独占该 Value，
+// 不能与其他线程对它的任何访问并发。不同 Value 之间共享的节点只读，修改前总是先克隆
 class Value {
 public:
     // 值类型
     enum class Type { Null, Boolean, Number, String, Object, Array };
-    using Object = std::map<std::string, Value>;
+    // std::less<> 允许直接用 string_view / const char* 查找而不构造临时 std::string
+    using Object = std::map<std::string, Value, std::less<>>;
     using Array = std::vector<Value>;
 
     Value();
@@ -32,6 +45,8 @@ public:
     Value(double value);
     Value(const char* value);
     Value(const std::string& value);
+    Value(std::string&& value);
+    Value(std::string_view value);
     Value(const Object& value);
     Value(Object&& value);
     Value(const Array& value);
@@ -56,22 +71,40 @@ public:
     double as_number() const;
     const std::string& as_string() const;
     const Object& as_object() const;
+    // 非 const 访问先把共享的节点克隆为独占；此后拷贝这个 Value 会复制一层，
+    // 所以之前取得的引用的修改不会出现在副本中
     Object& as_object();
     const Array& as_array() const;
     Array& as_array();
+    // 借用视图：返回的 string_view 在 Value 被修改或销毁前有效
+    std::string_view as_string_view() const { return as_string(); }
+
+    // 对象成员查找；不是对象或成员不存在时返回 nullptr，不分配内存
+    const Value* find(std::string_view key) const;
+
+    // 把内容移出，之后 Value 变为 null；类型不符时抛出 ParseError
+    std::string take_string();
+    Object take_object();
+    Array take_array();
 
     std::string dump() const;
 
     static Value parse(const std::string& text);
     static Value parse(const char* data, std::size_t size);
+    static Value parse(const char* data, std::size_t size, const ParseLimits& limits);
 
 private:
     Type type_{Type::Null};
     bool bool_value_{false};
     double number_value_{0.0};
     std::string string_value_;
-    std::unique_ptr<Object> object_value_;
-    std::unique_ptr<Array> array_value_;
+    // 对象/数组节点写时复制：拷贝 Value 只增加引用计数，并把两边都标记为 shared_，
+    // 被共享的节点从此只读，通过非 const 的 as_object()/as_array() 访问时先克隆一层。
+    // 不依赖 use_count()：它在其他线程同时拷贝时并不可靠
+    std::shared_ptr<Object> object_value_;
+    std::shared_ptr<Array> array_value_;
+    mutable std::atomic<bool> shared_{false};  // const 的拷贝源也要标记，多个线程可能同时拷贝
+    bool exclusive_{false};                    // 已交出可变引用，拷贝时必须复制而不能共享
 
     void copy_from(const Value& other);
     void move_from(Value&& other) noexcept;
@@ -79,7 +112,63 @@ private:
     void dump_to(std::string& out) const;
 };
 
-Value make_object(std::initializer_list<std::pair<const std::string, Value>> items);
+// make_object 的成员。initializer_list 的元素是 const，value 声明为 mutable
+// 才能把临时构造的子树移动进结果对象，而不是整棵拷贝
+struct Member {
+    Member(std::string_view key, Value value) : key(key), value(std::move(value)) {}
+
+    std::string_view key;
+    mutable Value value;
+};
+
+// 传入的临时值被移动；传入左值时只在构造 Member 时拷贝一次
+Value make_object(std::initializer_list<Member> members);
+
+template <typename... Items>
+Value make_array(Items&&... items) {
+    Value::Array array;
+    array.reserve(sizeof...(Items));
+    (array.emplace_back(std::forward<Items>(items)), ...);
+    return Value(std::move(array));
+}
+
+// 兼容旧接口：std::pair 列表（包括具名的 initializer_list 变量）与 initializer_list<Value>，元素逐个拷贝。
+// pair 版本写成模板，花括号列表无法推导它，{{"key", value}} 形式仍只匹配上面的 Member 版本
+template <typename Pair, typename = std::enable_if_t<std::is_same_v<Pair, std::pair<const std::string, Value>>>>
+Value make_object(std::initializer_list<Pair> items) {
+    return Value(Value::Object(items.begin(), items.end()));
+}
+
 Value make_array(std::initializer_list<Value> items);
 
+// 可续传的流式解析器：按到达顺序分块喂入字节，状态跨块保留，结果与 Value::parse 一致。
+// 顶层值结束后 feed 会吃掉其后的空白并停在下一个非空白字节前，consumed() 给出本次用掉的字节数，
+// 剩余字节（下一条消息或多余数据）由调用方处理。
+class PushParser {
+public:
+    enum class Status { NeedMore, Done, Error };
+
+    explicit PushParser(const ParseLimits& limits = ParseLimits{});
+    PushParser(PushParser&& other) noexcept;
+    PushParser& operator=(PushParser&& other) noexcept;
+    ~PushParser();
+
+    Status feed(const char* data, std::size_t size);
+    // 输入结束：补全顶层数字等需要终止符的值；仍不完整时返回 Error
+    Status finish();
+
+    Status status() const noexcept;
+    std::size_t consumed() const noexcept;
+    // Error 时的原因
+    const std::string& error() const noexcept;
+    // Done 之后取出结果
+    Value take_value();
+    // 丢弃当前状态，准备解析下一个文档（保留已分配的缓冲区）
+    void reset();
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
 }  // namespace mcp_sandtimer::json
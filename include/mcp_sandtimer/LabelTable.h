@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mcp_sandtimer/Json.h"
+
+// 全局的 label 驻留表：每个不同的 label 只保存一份，得到稳定的 32 位 ID 与 string_view。
+// 查找不加锁（开放寻址，槽位是原子变量）；新 label 在互斥锁内插入，扩容时旧索引保留到表析构，
+// 正在查找的线程不受影响。label 一经驻留便不再释放，总数与总字节数有上限
+namespace mcp_sandtimer {
+
+class LabelTable {
+public:
+    using Id = std::uint32_t;
+
+    static constexpr std::size_t kMaxLabels = std::size_t{1} << 20;
+    static constexpr std::size_t kMaxBytes = std::size_t{64} << 20;
+
+    struct Stats {
+        std::size_t labels = 0;  // 不含 ID 0 的空 label
+        std::size_t bytes = 0;
+        std::size_t slots = 0;   // 当前索引的槽位数
+
+        json::Value ToJson() const;
+    };
+
+    static LabelTable& global();
+
+    LabelTable();
+    LabelTable(const LabelTable&) = delete;
+    LabelTable& operator=(const LabelTable&) = delete;
+    ~LabelTable();
+
+    // 返回 label 的 ID，第一次见到时插入；空字符串固定为 0。超出上限时抛出 std::length_error
+    Id intern(std::string_view label);
+    // 只查找不插入；不存在时返回 false
+    bool find(std::string_view label, Id& id) const noexcept;
+    // 视图在表的生命周期内有效
+    std::string_view view(Id id) const noexcept;
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string_view text;
+        std::size_t hash = 0;
+    };
+    // 槽位：高 32 位是哈希的高位，低 32 位是 ID；0 表示空槽
+    struct Index {
+        explicit Index(std::size_t size);
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+    };
+
+    static constexpr unsigned kSegmentBits = 12;
+    static constexpr std::size_t kSegmentSize = std::size_t{1} << kSegmentBits;
+    static constexpr std::size_t kArenaChunk = 64 * 1024;
+
+    // 按 ID 分段存放的条目，段一经分配不再移动
+    std::unique_ptr<std::atomic<Entry*>[]> segments_;
+    std::atomic<Index*> index_;
+
+    mutable std::mutex mutex_;  // 以下只在插入时访问
+    std::vector<std::unique_ptr<Entry[]>> owned_segments_;
+    std::vector<std::unique_ptr<Index>> indexes_;  // 含当前索引与扩容前的旧索引
+    std::vector<std::unique_ptr<char[]>> arena_;  // label 文本，块不移动，视图一直有效
+    char* chunk_ = nullptr;  // 正在填充的块
+    std::size_t chunk_used_ = 0;
+    std::size_t count_ = 0;
+    std::size_t bytes_ = 0;
+
+    bool find(std::string_view label, std::size_t hash, Id& id) const noexcept;
+    const char* store_locked(std::string_view label);
+    void insert_locked(Index& index, Id id, std::size_t hash) noexcept;
+};
+
+// 驻留后的 label：只有一个 ID，可以按值传递、比较与哈希，不分配内存。
+// 从字符串隐式构造时驻留到 LabelTable::global()
+class Label {
+public:
+    Label() noexcept = default;
+    Label(std::string_view text) : id_(LabelTable::global().intern(text)) {}
+    Label(const char* text) : Label(std::string_view(text)) {}
+    Label(const std::string& text) : Label(std::string_view(text)) {}
+    // id 须来自 LabelTable::global()
+    static Label from_id(LabelTable::Id id) noexcept {
+        Label label;
+        label.id_ = id;
+        return label;
+    }
+
+    LabelTable::Id id() const noexcept { return id_; }
+    std::string_view view() const noexcept { return LabelTable::global().view(id_); }
+    operator std::string_view() const noexcept { return view(); }
+    std::string str() const { return std::string(view()); }
+    const char* data() const noexcept { return view().data(); }
+    std::size_t size() const noexcept { return view().size(); }
+    bool empty() const noexcept { return id_ == 0; }
+
+    friend bool operator==(Label a, Label b) noexcept { return a.id_ == b.id_; }
+    friend bool operator!=(Label a, Label b) noexcept { return a.id_ != b.id_; }
+
+private:
+    LabelTable::Id id_ = 0;
+};
+
+std::ostream& operator<<(std::ostream& out, Label label);
+
+}  // namespace mcp_sandtimer
+
+template <>
+struct std::hash<mcp_sandtimer::Label> {
+    std::size_t operator()(mcp_sandtimer::Label label) const noexcept { return label.id(); }
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "mcp_sandtimer/Json.h"
+
+// 异步结构化日志：调用方只把记录写入无锁环形缓冲区，由后台线程批量写到 stderr
+// 以及可选的 JSON Lines 文件。缓冲区满时丢弃而不是阻塞；同一事件按秒限流。
+namespace mcp_sandtimer {
+
+enum class LogLevel : std::uint8_t { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+const char* to_string(LogLevel level) noexcept;
+// 解析 "debug" / "info" / "warn" / "error" / "off"，无法识别时抛出 std::invalid_argument
+LogLevel ParseLogLevel(const std::string& text);
+
+class Logger {
+public:
+    struct Options {
+        LogLevel level = LogLevel::Info;
+        bool write_stderr = true;
+        std::string file_path;                 // 非空时追加写入 JSON Lines
+        std::uint32_t rate_limit_per_second = 20;  // 每个事件每秒最多记录的条数，0 表示不限
+    };
+
+    struct Stats {
+        std::uint64_t written = 0;
+        std::uint64_t dropped = 0;     // 缓冲区满被丢弃
+        std::uint64_t suppressed = 0;  // 被限流
+
+        json::Value ToJson() const;
+    };
+
+    static constexpr std::size_t kCapacity = 1024;        // 环形缓冲区槽数（2 的幂）
+    static constexpr std::size_t kMaxTextLength = 240;    // 单条 message + detail 的最大字节数
+
+    // 进程级默认实例
+    static Logger& instance();
+
+    Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+    ~Logger();
+
+    // 重新配置输出；可在运行中调用
+    void configure(const Options& options);
+
+    bool enabled(LogLevel level) const noexcept {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    // event 必须是静态存储期的字符串（如字面量），用作限流键和结构化字段
+    void log(LogLevel level, const char* event, std::string_view message, std::string_view detail = {});
+
+    void debug(const char* event, std::string_view message, std::string_view detail = {}) {
+        log(LogLevel::Debug, event, message, detail);
+    }
+    void info(const char* event, std::string_view message, std::string_view detail = {}) {
+        log(LogLevel::Info, event, message, detail);
+    }
+    void warn(const char* event, std::string_view message, std::string_view detail = {}) {
+        log(LogLevel::Warn, event, message, detail);
+    }
+    void error(const char* event, std::string_view message, std::string_view detail = {}) {
+        log(LogLevel::Error, event, message, detail);
+    }
+
+    // 等待调用前写入的记录全部输出
+    void flush();
+    Stats stats() const;
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        LogLevel level = LogLevel::Info;
+        std::int64_t timestamp_us = 0;
+        const char* event = nullptr;
+        std::uint16_t message_length = 0;
+        std::uint16_t detail_length = 0;
+        char text[kMaxTextLength];
+    };
+
+    // 每个事件独占一个限流窗口：从哈希位置线性探测，event 为空的桶由第一个到达的事件占用
+    struct RateBucket {
+        std::atomic<std::int64_t> window_start_us{0};
+        std::atomic<std::uint32_t> count{0};
+        std::atomic<std::uint32_t> suppressed{0};
+        std::atomic<const char*> event{nullptr};
+    };
+    static constexpr std::size_t kRateBuckets = 64;
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(64) std::size_t dequeue_pos_ = 0;  // 仅后台线程访问
+    RateBucket buckets_[kRateBuckets];
+
+    std::atomic<LogLevel> level_{LogLevel::Info};
+    std::atomic<std::uint32_t> rate_limit_{20};
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> suppressed_{0};
+
+    std::mutex mutex_;  // 保护下面的输出配置与后台线程状态
+    std::condition_variable wake_;
+    std::condition_variable drained_;
+    bool stopping_ = false;
+    bool write_stderr_ = true;
+    std::FILE* file_ = nullptr;
+    std::uint64_t flush_requests_ = 0;
+    std::uint64_t flushes_done_ = 0;
+    std::thread drain_thread_;
+
+    bool admit(const char* event, std::int64_t now_us);
+    RateBucket* bucket_for(const char* event) noexcept;
+    bool push(LogLevel level, const char* event, std::int64_t now_us, std::string_view message, std::string_view detail,
+              std::size_t* position_out = nullptr);
+    void run();
+    std::size_t drain_into(std::string& text, std::string& jsonl);
+    void collect_suppressed(std::int64_t now_us, bool force);
+    void write_out(const std::string& text, const std::string& jsonl);
+};
+
+}  // namespace mcp_sandtimer
@@ -1,16 +1,32 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ostream>
+#include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#include "mcp_sandtimer/CommandCoalescer.h"
+#include "mcp_sandtimer/CommandSpool.h"
+#include "mcp_sandtimer/IdempotencyCache.h"
 #include "mcp_sandtimer/Json.h"
 #include "mcp_sandtimer/TimerClient.h"
+#include "mcp_sandtimer/TimerEngine.h"
 #include "mcp_sandtimer/ToolDefinition.h"
+#include "mcp_sandtimer/ToolRegistry.h"
 
 namespace mcp_sandtimer {
 
@@ -29,34 +45,135 @@ private:
     std::optional<json::Value> data_;
 };
 
+// stdio 上的消息分帧：LSP 风格的 Content-Length 头部，或每行一条 JSON（NDJSON）
+enum class MessageFraming { Auto, ContentLength, Ndjson };
+
+const char* to_string(MessageFraming framing) noexcept;
+MessageFraming ParseMessageFraming(const std::string& text);
+
 class MCPSandTimerServer {
 public:
     MCPSandTimerServer(TimerClient client, std::istream& input = std::cin, std::ostream& output = std::cout);
+    // 注册表中的处理函数捕获了 this，不可拷贝
+    MCPSandTimerServer(const MCPSandTimerServer&) = delete;
+    MCPSandTimerServer& operator=(const MCPSandTimerServer&) = delete;
+    ~MCPSandTimerServer();
 
+    // 返回前等待所有在途的 tools/call 完成
     void Serve();
+    // 启用落盘队列：tool 调用只写入 spool 并立即返回，由后台线程补发
+    void EnableSpool(std::shared_ptr<CommandSpool> spool);
+    // 启用合并窗口：tool 调用的命令先在窗口内合并，再交给 TimerClient；同时启用 spool 时以 spool 为准
+    void EnableCoalescing(std::shared_ptr<CommandCoalescer> coalescer);
+    // 启用幂等缓存：带相同 _meta.idempotencyKey 的同一工具调用在缓存期内直接返回上次的结果；不带 key 的调用照常执行
+    void EnableIdempotency(std::shared_ptr<IdempotencyCache> cache);
+    // 入站消息的大小与嵌套上限；超过 max_payload 的消息在读取前即被丢弃
+    void SetParseLimits(const json::ParseLimits& limits) {
+        parse_limits_ = limits;
+        parser_ = json::PushParser(limits);
+    }
+    // 默认 Auto：根据第一条消息的首个非空白字节判断，之后的回复使用相同的分帧
+    void SetFraming(MessageFraming framing) noexcept { framing_.store(framing); }
+    MessageFraming framing() const noexcept { return framing_.load(); }
+    // 执行请求的工作线程数；tools/call 按 label 固定分到一个线程，同一 label 的命令按到达顺序执行。
+    // 默认 0：在读取线程上同步执行，此时取消通知无法打断在途请求
+    void SetWorkerCount(std::size_t count) noexcept { worker_count_ = count; }
+    // tools/call 的默认截止时间，客户端可用 params._meta.timeoutMs 缩短；0 表示只受 TimerClient 超时约束
+    void SetRequestTimeout(std::chrono::milliseconds timeout) noexcept { request_timeout_ = timeout; }
 
+    // 内置工具定义；运行时实际提供的工具以 registry() 为准
     static const std::vector<ToolDefinition>& ToolDefinitions();
 
+    // 嵌入方可在 Serve() 之前注册额外的方法和工具
+    ToolRegistry& registry() noexcept { return registry_; }
+    const ToolRegistry& registry() const noexcept { return registry_; }
+
 private:
+    struct InFlightRequest;
+
     TimerClient timer_client_;
+    std::shared_ptr<CommandSpool> spool_;
+    std::shared_ptr<CommandCoalescer> coalescer_;
+    std::shared_ptr<IdempotencyCache> idempotency_;
+    json::ParseLimits parse_limits_;
+    json::PushParser parser_{parse_limits_};  // 跨消息复用，保留内部缓冲区
+    std::atomic<MessageFraming> framing_{MessageFraming::Auto};  // 读取线程检测，工作线程与通知线程回复时读取
+    // NDJSON 模式的读缓冲区：[line_begin_, line_end_) 为未处理的数据，line_scanned_ 之前已确认没有换行
+    std::vector<char> line_buffer_;
+    std::size_t line_begin_ = 0;
+    std::size_t line_end_ = 0;
+    std::size_t line_scanned_ = 0;
+    ToolRegistry registry_;
     std::istream& input_;
     std::ostream& output_;
     bool shutdown_requested_ = false;
-    bool initialized_ = false;
+    std::mutex output_mutex_;  // 工作线程与读取线程都会写响应
+
+    // 在途请求按 id 的 JSON 文本登记，notifications/cancelled 据此找到取消信号
+    std::chrono::milliseconds request_timeout_{0};
+    std::mutex in_flight_mutex_;
+    std::map<std::string, std::shared_ptr<InFlightRequest>, std::less<>> in_flight_;
+    std::atomic<std::uint64_t> cancelled_requests_{0};
+    std::atomic<std::uint64_t> expired_requests_{0};
+
+    // 每条消息的分配次数：读取线程上的分帧与解析加上执行线程上的处理，需链接分配钩子才有数据
+    std::atomic<std::uint64_t> counted_messages_{0};
+    std::atomic<std::uint64_t> message_allocations_{0};
+    std::atomic<std::uint64_t> max_message_allocations_{0};
+
+    // 镜像已转发的命令，到期时推送 notifications/timer/expired；订阅的资源另发 resources/updated
+    TimerEngine timer_engine_;
+    std::mutex subscriptions_mutex_;
+    std::set<std::string, std::less<>> subscriptions_;
+
+    // 每个工作线程有自己的队列；不属于某个 label 的请求进入所有队列，作为屏障保持前后顺序
+    struct WorkerLane {
+        std::deque<std::function<void()>> tasks;
+        std::condition_variable ready;
+        std::thread thread;
+    };
+    std::size_t worker_count_ = 0;
+    std::mutex tasks_mutex_;
+    std::vector<std::unique_ptr<WorkerLane>> lanes_;
+    bool workers_stopping_ = false;
 
+    void RegisterBuiltins();
     std::optional<json::Value> ReadMessage();
+    bool DetectFraming();
+    std::optional<json::Value> ReadContentLengthMessage();
+    std::optional<json::Value> ReadLineMessage();
+    void Submit(json::Value message, std::uint64_t read_allocations);
+    void Process(const json::Value& message);
+    void ProcessCounted(const json::Value& message, std::uint64_t read_allocations);
     void Dispatch(const json::Value& message);
+    std::shared_ptr<InFlightRequest> BeginRequest(const json::Value& message);
+    void EndRequest(const std::shared_ptr<InFlightRequest>& request);
+    void RunOnWorker(const json::Value& message, std::function<void()> task);
+    void WorkerLoop(WorkerLane& lane);
+    void StopWorkers();
+    void HandleCancelled(const json::Value& params);
+    json::Value HandleResourceList();
+    json::Value HandleResourceRead(const json::Value& params);
+    json::Value HandleSubscribe(const json::Value& params, bool subscribe);
+    void OnTimerExpired(const TimerEngine::Timer& timer);
+    void NotifyResourceUpdated(std::string_view label);
     void HandleNotification(const std::string& method, const json::Value& params);
     json::Value HandleRequest(const std::string& method, const json::Value& params);
     json::Value HandleInitialize(const json::Value& params);
+    json::Value HandleMetrics();
     json::Value HandleToolCall(const json::Value& params);
     std::string HandleStart(const json::Value& arguments);
     std::string HandleReset(const json::Value& arguments);
     std::string HandleCancel(const json::Value& arguments);
-    std::string ExtractLabel(const json::Value& arguments);
+    // 返回 arguments 中去掉首尾空白并驻留后的 label
+    Label ExtractLabel(const json::Value& arguments);
+    // 命令的去向，决定 tool 的回复措辞
+    enum class Delivery { Sent, Queued, Merged, Superseded };
+    Delivery Forward(const TimerCommand& command);
     void Send(const json::Value& payload);
-    void SendResponse(const json::Value& id, const json::Value& result);
+    void SendResponse(const json::Value& id, json::Value result);
     void SendError(const json::Value& id, const JSONRPCError& error);
+    void SendNotification(const char* method, json::Value params);
 };
 
 }  // namespace mcp_sandtimer
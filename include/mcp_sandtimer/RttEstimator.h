@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "mcp_sandtimer/Json.h"
+
+// 针对单个 sandtimer 端点的往返时间估计，算法同 TCP 的 RTO（RFC 6298）：
+// SRTT/RTTVAR 做指数平滑，超时取 SRTT + 4·RTTVAR；超时一次翻倍退避，下一个样本恢复。
+// 线程安全；timeout() 只读原子变量，不加锁。
+namespace mcp_sandtimer {
+
+class RttEstimator {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::uint64_t samples = 0;
+        std::uint64_t timeouts = 0;
+        double srtt_ms = 0;
+        double rttvar_ms = 0;
+        double timeout_ms = 0;  // 未经上下限裁剪的估计值，尚无样本时为 0
+        int backoff = 0;        // 连续超时后的翻倍次数
+
+        json::Value ToJson() const;
+    };
+
+    RttEstimator() = default;
+    RttEstimator(const RttEstimator&) = delete;
+    RttEstimator& operator=(const RttEstimator&) = delete;
+
+    // 一次成功的连接加发送所用的时间
+    void record_sample(clock::duration rtt);
+    // 一次在估计的超时之内没有完成的投递
+    void record_timeout();
+
+    // 当前超时，裁剪到 [floor, ceiling]；尚无样本时为 ceiling
+    std::chrono::milliseconds timeout(std::chrono::milliseconds floor, std::chrono::milliseconds ceiling) const;
+    Stats stats() const;
+
+private:
+    static constexpr int kMaxBackoff = 16;
+
+    mutable std::mutex mutex_;
+    Stats stats_;
+    std::int64_t srtt_us_ = 0;
+    std::int64_t rttvar_us_ = 0;
+    // 在 mutex_ 内更新，已包含退避；0 表示尚无样本
+    std::atomic<std::int64_t> timeout_us_{0};
+
+    void publish_locked();
+};
+
+}  // namespace mcp_sandtimer
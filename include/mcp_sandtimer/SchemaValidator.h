@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mcp_sandtimer/Json.h"
+
+// 把 tool 的 inputSchema 预编译成扁平的校验程序，运行时单趟遍历参数且不分配内存。
+// 支持的关键字：type、properties、required、additionalProperties(布尔)、items、
+// minLength、maxLength、minimum、maximum、exclusiveMinimum、exclusiveMaximum，其余关键字忽略。
+namespace mcp_sandtimer {
+
+class SchemaError : public std::runtime_error {
+public:
+    explicit SchemaError(const std::string& message);
+};
+
+// 校验失败的位置（JSON Pointer，如 "/time"）与原因；只在失败时填充
+struct ValidationError {
+    std::string path;
+    std::string message;
+};
+
+class SchemaValidator {
+public:
+    SchemaValidator() = default;
+
+    // 编译失败（不支持的结构）时抛出 SchemaError
+    static SchemaValidator compile(const json::Value& schema);
+
+    bool validate(const json::Value& instance, ValidationError* error = nullptr) const;
+
+    bool empty() const noexcept { return nodes_.empty(); }
+
+private:
+    enum TypeBit : std::uint8_t {
+        kNull = 1 << 0,
+        kBoolean = 1 << 1,
+        kNumber = 1 << 2,
+        kInteger = 1 << 3,
+        kString = 1 << 4,
+        kObject = 1 << 5,
+        kArray = 1 << 6,
+    };
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+    static constexpr std::size_t kMaxProperties = 64;
+
+    struct Node {
+        std::uint8_t types = 0;  // 0 表示不限类型
+        bool closed = false;     // additionalProperties: false
+        bool has_minimum = false;
+        bool has_maximum = false;
+        bool exclusive_minimum = false;
+        bool exclusive_maximum = false;
+        double minimum = 0.0;
+        double maximum = 0.0;
+        std::size_t min_length = 0;
+        std::size_t max_length = static_cast<std::size_t>(-1);
+        std::uint32_t first_property = 0;  // properties_ 中按名称排序的区间
+        std::uint32_t property_count = 0;
+        std::uint64_t required_mask = 0;   // 按区间内下标置位
+        std::uint32_t items = kNone;
+    };
+
+    struct Property {
+        std::string name;
+        std::uint32_t node;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<Property> properties_;
+
+    std::uint32_t compile_node(const json::Value& schema);
+    bool validate_node(std::uint32_t index, const json::Value& instance, ValidationError* error) const;
+};
+
+}  // namespace mcp_sandtimer
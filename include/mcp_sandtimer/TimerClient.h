@@ -1,11 +1,23 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "mcp_sandtimer/CircuitBreaker.h"
+#include "mcp_sandtimer/CommandCodec.h"
 #include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/TimerCommand.h"
 
 namespace mcp_sandtimer {
 
@@ -14,31 +26,164 @@ public:
     explicit TimerClientError(const std::string& message);
 };
 
+// 熔断器打开时抛出，不会触达网络
+class CircuitOpenError : public TimerClientError {
+public:
+    explicit CircuitOpenError(const std::string& message);
+};
+
+// 调用被取消（连接或发送尚未完成时收到取消信号）
+class RequestCancelledError : public TimerClientError {
+public:
+    explicit RequestCancelledError(const std::string& message);
+};
+
+// 调用超过了调用方给定的截止时间
+class DeadlineExceededError : public TimerClientError {
+public:
+    explicit DeadlineExceededError(const std::string& message);
+};
+
+// 由发起方持有、其他线程可置位的取消信号；在途的连接与发送会在约 10ms 内放弃
+class CancellationToken {
+public:
+    void cancel() noexcept { cancelled_.store(true, std::memory_order_release); }
+    bool cancelled() const noexcept { return cancelled_.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+// 单次调用的截止时间与取消信号，缺省时只受 timeout() 约束
+struct CallOptions {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    const CancellationToken* cancellation = nullptr;
+};
+
+// 一个 sandtimer 端点
+struct TimerEndpoint {
+    std::string host;
+    std::uint16_t port = 0;
+};
+
+// 副本模式下一次调用何时算成功：任一副本收到、过半副本收到或全部副本收到
+enum class ReplicationPolicy { FirstAck, Quorum, All };
+
+const char* to_string(ReplicationPolicy policy) noexcept;
+// 解析 "first" / "quorum" / "all"，无法识别时抛出 std::invalid_argument
+ReplicationPolicy ParseReplicationPolicy(const std::string& text);
+
+// 异步调用的完成回调：成功时 error 为空。通常在客户端的 I/O 线程上调用，应尽快返回；
+// 命令当场就有结果（经共享内存送达、熔断打开、无法解析）时直接在调用线程上调用
+using TimerCompletion = std::function<void(std::exception_ptr error)>;
+
+// 线程安全：任意线程可以同时调用发送方法、setter 与 metrics()。配置保存在不可变快照里，
+// setter 复制当前快照、修改后整体替换（RCU 风格）；发送方法开始时取一次快照，
+// 之后的 setter 不影响已经开始的调用。取快照经 std::atomic_load，并非无锁：标准库用一把短暂的内部锁
+// 保护 shared_ptr 的复制，持锁时间只有一次引用计数递增，不会等待发送或 setter 的其余部分。
+// 拷贝出的 TimerClient 与原对象共享端点健康状态、共享内存通道和异步队列，之后各自修改配置
 class TimerClient {
 public:
     using milliseconds = std::chrono::milliseconds; // 超时单位
 
+    static constexpr std::size_t kDefaultAsyncQueueCapacity = 1024;
+    static constexpr milliseconds kDefaultMinTimeout{50};
+
     TimerClient();
     TimerClient(std::string host, std::uint16_t port, milliseconds timeout = milliseconds{5000});
+    TimerClient(const TimerClient& other);
+    TimerClient& operator=(const TimerClient& other);
+    ~TimerClient();
 
-    const std::string& host() const noexcept { return host_; }
-    std::uint16_t port() const noexcept { return port_; }
-    milliseconds timeout() const noexcept { return timeout_; }
+    // 读取当前快照中的值；返回副本，其他线程随后的修改不会使其失效
+    std::string host() const;
+    std::uint16_t port() const;
+    milliseconds timeout() const;
+    milliseconds min_timeout() const;
+    milliseconds connect_attempt_delay() const;
+    CircuitBreaker::Options breaker_options() const;
+    WireFormat wire_format() const;
+    std::vector<TimerEndpoint> endpoints() const;
+    std::vector<TimerEndpoint> replicas() const;
+    ReplicationPolicy replication_policy() const;
 
-    void set_host(std::string host) { host_ = std::move(host); }
-    void set_port(std::uint16_t port) noexcept { port_ = port; }
-    void set_timeout(milliseconds timeout) noexcept { timeout_ = timeout; }
+    // 修改端点或熔断参数会重置该端点的健康状态；set_host/set_port 同时退出分片与副本模式
+    void set_host(std::string host);
+    void set_port(std::uint16_t port);
+    // 配置两个及以上端点时按 label 一致性哈希分片：同一 label 的 start/reset/cancel 总是发往同一端点，
+    // 熔断打开的端点上的 label 暂时顺延到环上的下一个端点，其余 label 不受影响。
+    // 第一个端点同时成为 host()/port()；少于两个端点时恢复单端点模式。与副本模式互斥
+    void set_endpoints(std::vector<TimerEndpoint> endpoints);
+    // 副本模式：每条命令经非阻塞 socket 同时发给所有副本，按 policy 收到足够的确认（字节全部写出）即返回，
+    // 尚未完成的副本由后台线程继续投递直到超时。空列表退出副本模式；与分片模式互斥
+    void set_replicas(std::vector<TimerEndpoint> replicas, ReplicationPolicy policy = ReplicationPolicy::All);
+    // 每个端点按实测往返时间估计超时（同 TCP 的 RTO），连接与发送的截止时间取估计值，
+    // 裁剪到 [min_timeout, timeout]；尚无样本时用 timeout。timeout 为 0 表示不设超时
+    void set_timeout(milliseconds timeout);
+    // 自适应超时的下限；设为与 timeout 相同即关闭自适应
+    void set_min_timeout(milliseconds timeout);
+    // 多个解析地址之间错峰发起连接的间隔（RFC 8305 建议 250ms）
+    void set_connect_attempt_delay(milliseconds delay);
+    void set_breaker_options(CircuitBreaker::Options options);
+    // TCP 上的命令编码；默认 JSON，只有确认接收端支持时才切换为二进制
+    void set_wire_format(WireFormat format);
+    // 同机 sandtimer 在 path 提供共享内存命令环时，命令直接写入环；
+    // 环不存在、消费者不在线、环已满或 label 过长时回退到 TCP。空字符串关闭该通道
+    void set_shared_memory_path(std::string path);
+    std::string shared_memory_path() const;
 
     void start_timer(const std::string& label, int seconds) const;
     void reset_timer(const std::string& label) const;
     void cancel_timer(const std::string& label) const;
+    void send(const TimerCommand& command) const;
+    // 取消时抛出 RequestCancelledError，超过 options.deadline 时抛出 DeadlineExceededError
+    void send(const TimerCommand& command, const CallOptions& options) const;
+
+    // 异步版本：命令交给内部的 I/O 线程后立即返回，单个线程就能连续发出大量命令。
+    // 同一 label 的命令按提交顺序逐条投递；未完成的命令达到 async_queue_capacity() 时调用方阻塞等待。
+    // 不支持 CallOptions，每条命令受 timeout() 约束
+    std::future<void> start_timer_async(const std::string& label, int seconds) const;
+    std::future<void> reset_timer_async(const std::string& label) const;
+    std::future<void> cancel_timer_async(const std::string& label) const;
+    std::future<void> send_async(const TimerCommand& command) const;
+    void start_timer_async(const std::string& label, int seconds, TimerCompletion completion) const;
+    void reset_timer_async(const std::string& label, TimerCompletion completion) const;
+    void cancel_timer_async(const std::string& label, TimerCompletion completion) const;
+    void send_async(const TimerCommand& command, TimerCompletion completion) const;
+    // 之后的异步命令进入新的队列；旧队列中的命令继续投递完
+    void set_async_queue_capacity(std::size_t capacity);
+    std::size_t async_queue_capacity() const;
+
+    CircuitBreaker::State breaker_state() const;
+    // 端点与熔断器统计，供服务端 metrics 输出
+    json::Value metrics() const;
 
 private:
-    std::string host_;
-    std::uint16_t port_;
-    milliseconds timeout_;
-    // JSON序列化后发到 sandtimer 监听的 TCP 端口
-    void send_payload(const json::Value& payload) const;
+    struct EndpointHealth;
+    struct SharedMemoryChannel;
+    struct Shard;
+    struct Sharding;
+    struct Replica;
+    struct Replication;
+    struct AsyncJob;
+    struct AsyncChannel;
+    struct Config;
+
+    // 当前配置快照，只经 std::atomic_load/atomic_store 访问
+    std::shared_ptr<const Config> config_;
+    // 串行化 setter 的复制-修改-发布
+    std::mutex update_mutex_;
+
+    std::shared_ptr<const Config> snapshot() const;
+    void publish(std::shared_ptr<Config> config);
+    template <typename Mutate>
+    void update(Mutate&& mutate);
+
+    // 把编码好的命令发到 sandtimer 监听的 TCP 端口
+    static void send_payload(const Config& config, std::string_view message, const CallOptions& options,
+                             const std::string& host, std::uint16_t port, EndpointHealth& health);
+    // 副本模式：一次并发投递给所有副本
+    static void send_replicated(const Config& config, std::string_view message, const CallOptions& options);
 };
 
 }  // namespace mcp_sandtimer
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include "mcp_sandtimer/LabelTable.h"
+
+// 发往 sandtimer 的一条命令（start/reset/cancel），供客户端、落盘队列等共用
+namespace mcp_sandtimer {
+
+enum class TimerOp : std::uint8_t { Start = 1, Reset = 2, Cancel = 3 };
+
+struct TimerCommand {
+    TimerOp op = TimerOp::Start;
+    Label label;
+    int seconds = 0;  // 仅 Start 使用
+};
+
+inline const char* to_string(TimerOp op) noexcept {
+    switch (op) {
+        case TimerOp::Start:
+            return "start";
+        case TimerOp::Reset:
+            return "reset";
+        case TimerOp::Cancel:
+            return "cancel";
+    }
+    return "unknown";
+}
+
+}  // namespace mcp_sandtimer
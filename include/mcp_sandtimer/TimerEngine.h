@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/TimerCommand.h"
+
+// 内置计时引擎：镜像发往 sandtimer 的 start/reset/cancel 命令，在倒计时结束时回调。
+// sandtimer 协议本身没有回传通道，服务端据此向客户端推送到期通知。
+namespace mcp_sandtimer {
+
+class TimerEngine {
+public:
+    using clock = std::chrono::steady_clock;
+    using wall_clock = std::chrono::system_clock;
+
+    struct Timer {
+        Label label;
+        int seconds = 0;
+        wall_clock::time_point started_at;
+        wall_clock::time_point expires_at;
+        bool expired = false;
+
+        json::Value ToJson() const;
+    };
+
+    struct Stats {
+        std::size_t running = 0;
+        std::size_t expired = 0;  // 仍保留、可被读取的已到期计时器
+        std::uint64_t fired = 0;
+
+        json::Value ToJson() const;
+    };
+
+    // 已到期的计时器最多保留这么多个，超出时丢弃最早到期的
+    static constexpr std::size_t kMaxExpired = 256;
+
+    using ExpiredCallback = std::function<void(const Timer&)>;
+
+    // 回调在引擎线程上执行，不持有引擎的锁
+    explicit TimerEngine(ExpiredCallback on_expired);
+    TimerEngine(const TimerEngine&) = delete;
+    TimerEngine& operator=(const TimerEngine&) = delete;
+    ~TimerEngine();
+
+    // Start 重新开始计时；Reset 按原时长重新开始（未知 label 忽略）；Cancel 移除
+    void apply(const TimerCommand& command);
+    std::optional<Timer> find(std::string_view label) const;
+    // 按 label 排序
+    std::vector<Timer> timers() const;
+    Stats stats() const;
+    // 停止引擎线程，之后不再回调
+    void stop();
+
+private:
+    struct Entry {
+        Timer timer;
+        clock::time_point deadline;
+        std::uint64_t generation = 0;
+    };
+    // 最小堆中的到期项；label 重新计时或取消后 generation 不再匹配，出堆时跳过
+    struct Due {
+        clock::time_point deadline;
+        std::uint64_t generation;
+        Label label;
+
+        bool operator>(const Due& other) const { return deadline > other.deadline; }
+    };
+
+    ExpiredCallback on_expired_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::unordered_map<Label, Entry> entries_;
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> due_;
+    std::uint64_t next_generation_ = 1;
+    std::uint64_t fired_ = 0;
+    bool stopping_ = false;
+    std::thread worker_;
+
+    void schedule_locked(Entry& entry);
+    void evict_expired_locked();
+    void run();
+};
+
+// ISO 8601 UTC，毫秒精度
+std::string FormatTimestamp(TimerEngine::wall_clock::time_point time);
+
+}  // namespace mcp_sandtimer
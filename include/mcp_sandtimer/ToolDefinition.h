@@ -17,5 +17,7 @@ struct ToolDefinition {
 };
 
 const std::vector<ToolDefinition>& GetToolDefinitions();
+// 按名称查找工具定义，找不到返回 nullptr
+const ToolDefinition* FindToolDefinition(const std::string& name);
 
 }  // namespace mcp_sandtimer
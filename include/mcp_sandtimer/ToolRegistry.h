@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/SchemaValidator.h"
+#include "mcp_sandtimer/ToolDefinition.h"
+
+// JSON-RPC 方法与 MCP 工具的注册表。名称通过开放寻址的扁平哈希表查找，
+// 查找开销与注册数量无关；嵌入方可以在不修改服务端代码的情况下注册新工具。
+namespace mcp_sandtimer {
+
+class ToolRegistry {
+public:
+    using MethodHandler = std::function<json::Value(const json::Value& params)>;
+    // 返回工具结果中的文本内容
+    using ToolHandler = std::function<std::string(const json::Value& arguments)>;
+
+    struct MethodEntry {
+        std::string name;
+        MethodHandler handler;
+    };
+
+    struct ToolEntry {
+        ToolDefinition definition;
+        ToolHandler handler;
+        json::Value definition_json;  // 注册时预先生成的 ToJson() 结果
+        SchemaValidator validator;    // 注册时由 input_schema 编译，tools/call 时用来校验 arguments
+    };
+
+    // 同名重复注册会替换原有条目
+    void register_method(std::string name, MethodHandler handler);
+    // 注册时编译 definition.input_schema；schema 不受支持时抛出 SchemaError
+    void register_tool(ToolDefinition definition, ToolHandler handler);
+
+    // 返回的指针在注册表存续期间保持有效
+    const MethodEntry* find_method(std::string_view name) const;
+    const ToolEntry* find_tool(std::string_view name) const;
+
+    std::size_t method_count() const noexcept { return methods_.entries.size(); }
+    std::size_t tool_count() const noexcept { return tools_.entries.size(); }
+
+    // tools/list 的结果（按注册顺序）
+    json::Value tool_list() const;
+
+private:
+    // 槽位保存名称哈希与条目下标；kEmpty 表示空槽
+    struct Slot {
+        std::uint64_t hash = 0;
+        std::uint32_t index = kEmpty;
+    };
+    static constexpr std::uint32_t kEmpty = 0xFFFFFFFFu;
+
+    template <typename Entry>
+    struct Table {
+        std::deque<Entry> entries;  // deque 保证扩容时条目地址不变
+        std::vector<Slot> slots;
+    };
+
+    Table<MethodEntry> methods_;
+    Table<ToolEntry> tools_;
+
+    static std::uint64_t hash_name(std::string_view name) noexcept;
+    template <typename Entry, typename NameFn>
+    static std::uint32_t lookup(const Table<Entry>& table, std::string_view name, NameFn&& name_of);
+    template <typename Entry, typename NameFn>
+    static void insert(Table<Entry>& table, Entry entry, NameFn&& name_of);
+};
+
+}  // namespace mcp_sandtimer
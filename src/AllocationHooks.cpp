@@ -0,0 +1,109 @@
+#include "mcp_sandtimer/AllocationTracker.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// 替换全局 operator new/delete，把每次分配交给 AllocationTracker 计数。
+// 不属于 mcp_sandtimer_lib：只有需要统计的程序才链接本文件（见 ENABLE_ALLOCATION_TRACKING），
+// 自带 operator new 的测试不受影响
+namespace {
+
+using mcp_sandtimer::AllocationTag;
+using mcp_sandtimer::AllocationTracker;
+
+// 每块内存前的头部：记录大小、标签与 malloc 返回的原始地址，释放时据此记账并归还
+struct Header {
+    std::size_t size_and_tag;  // size << 8 | tag
+    void* base;
+};
+constexpr std::size_t kHeaderSpace = 16;
+static_assert(sizeof(Header) <= kHeaderSpace, "allocation header does not fit");
+
+const bool kInstalled = (AllocationTracker::mark_installed(), true);
+
+void* Allocate(std::size_t size, std::size_t alignment) noexcept {
+    const std::size_t extra = alignment > kHeaderSpace ? alignment : 0;
+    // 加上头部后不能溢出，且 size << 8 不能丢掉高位；超限按分配失败处理，由调用方抛出 bad_alloc
+    if (size > (SIZE_MAX >> 8) - kHeaderSpace - extra) {
+        return nullptr;
+    }
+    void* base = std::malloc(size + kHeaderSpace + extra);
+    if (base == nullptr) {
+        return nullptr;
+    }
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(base) + kHeaderSpace;
+    if (extra != 0) {
+        address = (address + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+    }
+    const AllocationTag tag = AllocationTracker::current_tag();
+    Header* header = reinterpret_cast<Header*>(address) - 1;
+    header->size_and_tag = size << 8 | static_cast<std::size_t>(tag);
+    header->base = base;
+    AllocationTracker::record_allocation(size, tag);
+    return reinterpret_cast<void*>(address);
+}
+
+void Release(void* pointer) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+    const Header* header = static_cast<const Header*>(pointer) - 1;
+    AllocationTracker::record_deallocation(header->size_and_tag >> 8,
+                                           static_cast<AllocationTag>(header->size_and_tag & 0xff));
+    std::free(header->base);
+}
+
+// 与标准库的行为一致：失败时调用 new_handler，没有时抛出 bad_alloc
+void* AllocateOrThrow(std::size_t size, std::size_t alignment) {
+    for (;;) {
+        if (void* pointer = Allocate(size, alignment)) {
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* AllocateNoThrow(std::size_t size, std::size_t alignment) noexcept {
+    try {
+        return AllocateOrThrow(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new[](std::size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return AllocateNoThrow(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return AllocateNoThrow(size, 0); }
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateNoThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateNoThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept { Release(pointer); }
+void operator delete[](void* pointer) noexcept { Release(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { Release(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { Release(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { Release(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { Release(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { Release(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { Release(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { Release(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { Release(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { Release(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { Release(pointer); }
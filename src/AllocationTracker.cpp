@@ -0,0 +1,115 @@
+#include "mcp_sandtimer/AllocationTracker.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace mcp_sandtimer {
+
+std::atomic<bool> AllocationTracker::installed_{false};
+std::atomic<std::uint64_t> AllocationTracker::deallocations_{0};
+std::atomic<std::int64_t> AllocationTracker::live_bytes_{0};
+std::atomic<std::int64_t> AllocationTracker::peak_live_bytes_{0};
+AllocationTracker::TagCounters AllocationTracker::tags_[AllocationTracker::kTagCount];
+thread_local std::uint64_t AllocationTracker::thread_allocations_ = 0;
+thread_local AllocationTag AllocationTracker::current_tag_ = AllocationTag::Other;
+
+const char* to_string(AllocationTag tag) noexcept {
+    switch (tag) {
+        case AllocationTag::Other:
+            return "other";
+        case AllocationTag::JsonParser:
+            return "jsonParser";
+        case AllocationTag::Framing:
+            return "framing";
+        case AllocationTag::TimerClient:
+            return "timerClient";
+    }
+    return "unknown";
+}
+
+void AllocationTracker::record_allocation(std::size_t size, AllocationTag tag) noexcept {
+    ++thread_allocations_;
+    TagCounters& counters = tags_[static_cast<std::size_t>(tag)];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+    counters.live_bytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    const std::int64_t live = live_bytes_.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed) +
+                              static_cast<std::int64_t>(size);
+    std::int64_t peak = peak_live_bytes_.load(std::memory_order_relaxed);
+    while (live > peak && !peak_live_bytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void AllocationTracker::record_deallocation(std::size_t size, AllocationTag tag) noexcept {
+    deallocations_.fetch_add(1, std::memory_order_relaxed);
+    tags_[static_cast<std::size_t>(tag)].live_bytes.fetch_sub(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    live_bytes_.fetch_sub(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+}
+
+AllocationTracker::Stats AllocationTracker::stats() noexcept {
+    Stats stats;
+    stats.installed = installed();
+    for (std::size_t i = 0; i < kTagCount; ++i) {
+        stats.tags[i].allocations = tags_[i].allocations.load(std::memory_order_relaxed);
+        stats.tags[i].bytes = tags_[i].bytes.load(std::memory_order_relaxed);
+        stats.tags[i].live_bytes = tags_[i].live_bytes.load(std::memory_order_relaxed);
+        stats.allocations += stats.tags[i].allocations;
+    }
+    stats.deallocations = deallocations_.load(std::memory_order_relaxed);
+    stats.live_bytes = live_bytes_.load(std::memory_order_relaxed);
+    stats.peak_live_bytes = peak_live_bytes_.load(std::memory_order_relaxed);
+    stats.peak_rss_bytes = peak_rss_bytes();
+    return stats;
+}
+
+std::size_t AllocationTracker::peak_rss_bytes() noexcept {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);  // macOS 以字节为单位
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;  // Linux 以 KiB 为单位
+#endif
+#endif
+}
+
+json::Value AllocationTracker::Stats::ToJson() const {
+    json::Value result = json::make_object({
+        {"installed", json::Value(installed)},
+        {"peakRssBytes", json::Value(static_cast<double>(peak_rss_bytes))}
+    });
+    if (!installed) {
+        return result;
+    }
+    auto& object = result.as_object();
+    object["allocations"] = json::Value(static_cast<double>(allocations));
+    object["deallocations"] = json::Value(static_cast<double>(deallocations));
+    object["liveBytes"] = json::Value(static_cast<double>(live_bytes));
+    object["peakLiveBytes"] = json::Value(static_cast<double>(peak_live_bytes));
+    json::Value::Object by_tag;
+    for (std::size_t i = 0; i < kTagCount; ++i) {
+        by_tag[to_string(static_cast<AllocationTag>(i))] = json::make_object({
+            {"allocations", json::Value(static_cast<double>(tags[i].allocations))},
+            {"bytes", json::Value(static_cast<double>(tags[i].bytes))},
+            {"liveBytes", json::Value(static_cast<double>(tags[i].live_bytes))}
+        });
+    }
+    object["tags"] = json::Value(std::move(by_tag));
+    return result;
+}
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,138 @@
+#include "mcp_sandtimer/CircuitBreaker.h"
+
+#include <algorithm>
+
+namespace mcp_sandtimer {
+
+CircuitBreaker::CircuitBreaker() : CircuitBreaker(Options{}) {}
+
+CircuitBreaker::CircuitBreaker(Options options) : options_(options) {
+    options_.failure_threshold = std::max(1, options_.failure_threshold);
+}
+
+bool CircuitBreaker::allow_request() {
+    if (state_.load(std::memory_order_acquire) == State::Closed) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (stats_.state) {
+        case State::Closed:
+            return true;
+        case State::Open:
+            if (clock::now() < open_until_) {
+                ++stats_.rejected;
+                return false;
+            }
+            stats_.state = State::HalfOpen;
+            ++stats_.half_opened;
+            trial_in_flight_ = false;
+            publish_locked();
+            [[fallthrough]];
+        case State::HalfOpen:
+            // 半开状态只放行一个试探请求，其余继续快速失败
+            if (trial_in_flight_) {
+                ++stats_.rejected;
+                return false;
+            }
+            trial_in_flight_ = true;
+            return true;
+    }
+    return true;
+}
+
+void CircuitBreaker::record_success() {
+    successes_.fetch_add(1, std::memory_order_relaxed);
+    // 与并发的 record_failure 竞争时，相当于这次成功发生在那次失败之前
+    if (healthy_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.consecutive_failures = 0;
+    if (stats_.state != State::Closed) {
+        stats_.state = State::Closed;
+        ++stats_.closed;
+    }
+    trial_in_flight_ = false;
+    publish_locked();
+}
+
+bool CircuitBreaker::record_failure() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.failures;
+    ++stats_.consecutive_failures;
+    if (stats_.state == State::HalfOpen ||
+        (stats_.state == State::Closed && stats_.consecutive_failures >= options_.failure_threshold)) {
+        open_locked();
+        return true;
+    }
+    publish_locked();
+    return false;
+}
+
+void CircuitBreaker::record_abandoned() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.abandoned;
+    trial_in_flight_ = false;
+}
+
+void CircuitBreaker::record_probe_success() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stats_.state == State::Open) {
+        stats_.state = State::HalfOpen;
+        ++stats_.half_opened;
+        trial_in_flight_ = false;
+        publish_locked();
+    }
+}
+
+CircuitBreaker::State CircuitBreaker::state() const {
+    return state_.load(std::memory_order_acquire);
+}
+
+CircuitBreaker::Stats CircuitBreaker::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.successes = successes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void CircuitBreaker::open_locked() {
+    stats_.state = State::Open;
+    ++stats_.opened;
+    open_until_ = clock::now() + options_.open_interval;
+    trial_in_flight_ = false;
+    publish_locked();
+}
+
+void CircuitBreaker::publish_locked() {
+    state_.store(stats_.state, std::memory_order_release);
+    healthy_.store(stats_.state == State::Closed && stats_.consecutive_failures == 0, std::memory_order_release);
+}
+
+json::Value CircuitBreaker::Stats::ToJson() const {
+    return json::make_object({
+        {"state", json::Value(to_string(state))},
+        {"consecutiveFailures", json::Value(consecutive_failures)},
+        {"successes", json::Value(static_cast<double>(successes))},
+        {"failures", json::Value(static_cast<double>(failures))},
+        {"rejected", json::Value(static_cast<double>(rejected))},
+        {"abandoned", json::Value(static_cast<double>(abandoned))},
+        {"opened", json::Value(static_cast<double>(opened))},
+        {"halfOpened", json::Value(static_cast<double>(half_opened))},
+        {"closed", json::Value(static_cast<double>(closed))}
+    });
+}
+
+const char* to_string(CircuitBreaker::State state) noexcept {
+    switch (state) {
+        case CircuitBreaker::State::Closed:
+            return "closed";
+        case CircuitBreaker::State::Open:
+            return "open";
+        case CircuitBreaker::State::HalfOpen:
+            return "half-open";
+    }
+    return "unknown";
+}
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,213 @@
+#include "mcp_sandtimer/CommandCoalescer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace mcp_sandtimer {
+
+namespace {
+// 带取消信号等待时的轮询间隔，与 TimerClient 放弃在途连接的粒度一致
+constexpr std::chrono::milliseconds kCancellationPoll{10};
+}  // namespace
+
+CommandCoalescer::CommandCoalescer(TimerClient client, Options options)
+    : client_(std::move(client)), options_(options) {
+    flusher_ = std::thread([this] { run(); });
+}
+
+CommandCoalescer::~CommandCoalescer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_.notify_all();
+    flusher_.join();
+}
+
+CommandCoalescer::Outcome CommandCoalescer::submit(const TimerCommand& command, const CallOptions& options) {
+    auto ticket = std::make_shared<Ticket>();
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+        throw TimerClientError("Command coalescer is shutting down");
+    }
+    ++stats_.submitted;
+    auto& sequences = pending_by_label_[command.label];
+    if (command.op == TimerOp::Reset && !sequences.empty() &&
+        at_locked(sequences.back()).command.op != TimerOp::Cancel) {
+        // 紧跟在待发 start/reset 之后的 reset 没有额外效果，随前一条一起完成
+        ticket->outcome = Outcome::Merged;
+        at_locked(sequences.back()).tickets.push_back(ticket);
+    } else {
+        if (command.op != TimerOp::Reset) {
+            for (std::uint64_t sequence : sequences) {
+                Pending& pending = at_locked(sequence);
+                pending.live = false;
+                for (const auto& superseded : pending.tickets) {
+                    superseded->outcome = Outcome::Superseded;
+                    resolve_locked(*superseded, nullptr);
+                }
+            }
+            sequences.clear();
+            done_.notify_all();
+        }
+        queue_.push_back(Pending{command, clock::now() + options_.window, {ticket}});
+        sequences.push_back(first_sequence_ + queue_.size() - 1);
+        work_.notify_one();
+    }
+
+    while (!ticket->done) {
+        const bool cancelled = options.cancellation != nullptr && options.cancellation->cancelled();
+        if (cancelled || clock::now() >= options.deadline) {
+            // 还在窗口内的命令直接撤回；已经交给 TimerClient 的命令不再等待，结果仍计入统计
+            if (withdraw_locked(command, ticket)) {
+                ++stats_.withdrawn;
+            }
+            if (cancelled) {
+                throw RequestCancelledError("Request was cancelled before the command completed");
+            }
+            throw DeadlineExceededError("Request deadline expired before the command completed");
+        }
+        auto wake = options.deadline;
+        if (options.cancellation != nullptr) {
+            wake = std::min(wake, clock::now() + kCancellationPoll);
+        }
+        if (wake == clock::time_point::max()) {
+            done_.wait(lock);
+        } else {
+            done_.wait_until(lock, wake);
+        }
+    }
+    if (ticket->error) {
+        std::rethrow_exception(ticket->error);
+    }
+    return ticket->outcome;
+}
+
+void CommandCoalescer::resolve_locked(Ticket& ticket, std::exception_ptr error) {
+    ticket.done = true;
+    ticket.error = std::move(error);
+    if (ticket.error) {
+        ++stats_.failed;
+        return;
+    }
+    switch (ticket.outcome) {
+        case Outcome::Sent:
+            break;
+        case Outcome::Merged:
+            ++stats_.merged;
+            break;
+        case Outcome::Superseded:
+            ++stats_.superseded;
+            break;
+    }
+}
+
+// 从待发命令中取下这张票；命令因此不再有等待者时不再发送
+bool CommandCoalescer::withdraw_locked(const TimerCommand& command, const std::shared_ptr<Ticket>& ticket) {
+    const auto iter = pending_by_label_.find(command.label);
+    if (iter == pending_by_label_.end()) {
+        return false;
+    }
+    auto& sequences = iter->second;
+    for (auto sequence = sequences.begin(); sequence != sequences.end(); ++sequence) {
+        Pending& pending = at_locked(*sequence);
+        const auto found = std::find(pending.tickets.begin(), pending.tickets.end(), ticket);
+        if (found == pending.tickets.end()) {
+            continue;
+        }
+        pending.tickets.erase(found);
+        if (pending.tickets.empty()) {
+            pending.live = false;
+            sequences.erase(sequence);
+            if (sequences.empty()) {
+                pending_by_label_.erase(iter);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+void CommandCoalescer::dispatch(Pending pending) {
+    auto tickets = std::make_shared<std::vector<std::shared_ptr<Ticket>>>(std::move(pending.tickets));
+    client_.send_async(pending.command, [this, tickets](std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& ticket : *tickets) {
+            resolve_locked(*ticket, error);
+        }
+        --in_flight_;
+        done_.notify_all();
+    });
+}
+
+// 按提交顺序取出到期的命令交给 TimerClient；停止时不再等待窗口，发完后等在途命令完成
+void CommandCoalescer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        while (!queue_.empty() && !queue_.front().live) {
+            queue_.pop_front();
+            ++first_sequence_;
+        }
+        if (queue_.empty()) {
+            if (stopping_) {
+                break;
+            }
+            work_.wait(lock);
+            continue;
+        }
+        if (!stopping_ && clock::now() < queue_.front().due) {
+            work_.wait_until(lock, queue_.front().due);
+            continue;
+        }
+        Pending pending = std::move(queue_.front());
+        queue_.pop_front();
+        ++first_sequence_;
+        // 队首是该 label 最早的待发命令
+        const auto iter = pending_by_label_.find(pending.command.label);
+        iter->second.erase(iter->second.begin());
+        if (iter->second.empty()) {
+            pending_by_label_.erase(iter);
+        }
+        ++stats_.sent;
+        ++in_flight_;
+        lock.unlock();
+        dispatch(std::move(pending));
+        lock.lock();
+    }
+    done_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+CommandCoalescer::Stats CommandCoalescer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    for (const auto& [label, sequences] : pending_by_label_) {
+        stats.pending += sequences.size();
+    }
+    return stats;
+}
+
+json::Value CommandCoalescer::Stats::ToJson() const {
+    return json::make_object({
+        {"submitted", json::Value(static_cast<double>(submitted))},
+        {"sent", json::Value(static_cast<double>(sent))},
+        {"merged", json::Value(static_cast<double>(merged))},
+        {"superseded", json::Value(static_cast<double>(superseded))},
+        {"withdrawn", json::Value(static_cast<double>(withdrawn))},
+        {"failed", json::Value(static_cast<double>(failed))},
+        {"pending", json::Value(static_cast<double>(pending))}
+    });
+}
+
+const char* to_string(CommandCoalescer::Outcome outcome) noexcept {
+    switch (outcome) {
+        case CommandCoalescer::Outcome::Sent:
+            return "sent";
+        case CommandCoalescer::Outcome::Merged:
+            return "merged";
+        case CommandCoalescer::Outcome::Superseded:
+            return "superseded";
+    }
+    return "unknown";
+}
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,217 @@
+#include "mcp_sandtimer/CommandCodec.h"
+
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+#include "mcp_sandtimer/Json.h"
+
+namespace mcp_sandtimer {
+namespace {
+
+// 与 json::Value::dump 的字符串转义保持一致，GUI 收到的字节与以前完全相同
+char* write_json_string(std::string_view text, char* out) {
+    static const char* hex = "0123456789ABCDEF";
+    *out++ = '"';
+    for (char ch : text) {
+        switch (ch) {
+            case '"':
+                *out++ = '\\';
+                *out++ = '"';
+                break;
+            case '\\':
+                *out++ = '\\';
+                *out++ = '\\';
+                break;
+            case '\b':
+                *out++ = '\\';
+                *out++ = 'b';
+                break;
+            case '\f':
+                *out++ = '\\';
+                *out++ = 'f';
+                break;
+            case '\n':
+                *out++ = '\\';
+                *out++ = 'n';
+                break;
+            case '\r':
+                *out++ = '\\';
+                *out++ = 'r';
+                break;
+            case '\t':
+                *out++ = '\\';
+                *out++ = 't';
+                break;
+            default: {
+                const auto uc = static_cast<unsigned char>(ch);
+                if (uc < 0x20) {
+                    std::memcpy(out, "\\u00", 4);
+                    out += 4;
+                    *out++ = hex[(uc >> 4) & 0x0F];
+                    *out++ = hex[uc & 0x0F];
+                } else {
+                    *out++ = ch;
+                }
+                break;
+            }
+        }
+    }
+    *out++ = '"';
+    return out;
+}
+
+char* write_literal(char* out, std::string_view text) {
+    std::memcpy(out, text.data(), text.size());
+    return out + text.size();
+}
+
+void encode_json(const TimerCommand& command, EncodedCommand& out) {
+    // 最坏情况：每个字节都转义为 \u00XX
+    char* const begin = out.reserve(64 + command.label.size() * 6);
+    char* cursor = write_literal(begin, "{\"cmd\":");
+    cursor = write_json_string(to_string(command.op), cursor);
+    cursor = write_literal(cursor, ",\"label\":");
+    cursor = write_json_string(command.label, cursor);
+    if (command.op == TimerOp::Start) {
+        cursor = write_literal(cursor, ",\"time\":");
+        cursor = std::to_chars(cursor, cursor + 16, command.seconds).ptr;
+    }
+    *cursor++ = '}';
+    out.commit(static_cast<std::size_t>(cursor - begin));
+}
+
+void store_u32(char* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+std::uint32_t load_u32(const char* in) {
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+void encode_binary(const TimerCommand& command, EncodedCommand& out) {
+    if (command.label.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw CommandCodecError("Label is too long for the binary encoding");
+    }
+    char* const begin = out.reserve(codec::kBinaryHeaderSize + command.label.size());
+    begin[0] = static_cast<char>(codec::kBinaryMagic);
+    begin[1] = static_cast<char>(codec::kBinaryVersion);
+    begin[2] = static_cast<char>(command.op);
+    begin[3] = 0;
+    store_u32(begin + 4, static_cast<std::uint32_t>(command.op == TimerOp::Start ? command.seconds : 0));
+    store_u32(begin + 8, static_cast<std::uint32_t>(command.label.size()));
+    std::memcpy(begin + codec::kBinaryHeaderSize, command.label.data(), command.label.size());
+    out.commit(codec::kBinaryHeaderSize + command.label.size());
+}
+
+TimerCommand decode_binary(std::string_view payload) {
+    if (payload.size() < codec::kBinaryHeaderSize) {
+        throw CommandCodecError("Truncated binary command header");
+    }
+    if (static_cast<std::uint8_t>(payload[1]) != codec::kBinaryVersion) {
+        throw CommandCodecError("Unsupported binary command version");
+    }
+    const auto op = static_cast<std::uint8_t>(payload[2]);
+    if (op < static_cast<std::uint8_t>(TimerOp::Start) || op > static_cast<std::uint8_t>(TimerOp::Cancel)) {
+        throw CommandCodecError("Unknown binary command op");
+    }
+    const std::uint32_t label_length = load_u32(payload.data() + 8);
+    if (payload.size() - codec::kBinaryHeaderSize != label_length) {
+        throw CommandCodecError("Binary command length does not match its label");
+    }
+    TimerCommand command;
+    command.op = static_cast<TimerOp>(op);
+    command.seconds = static_cast<std::int32_t>(load_u32(payload.data() + 4));
+    command.label = Label(std::string_view(payload.data() + codec::kBinaryHeaderSize, label_length));
+    return command;
+}
+
+TimerCommand decode_json(std::string_view payload) {
+    json::Value message;
+    try {
+        message = json::Value::parse(payload.data(), payload.size(), json::ParseLimits{});
+    } catch (const json::ParseError& error) {
+        throw CommandCodecError(std::string("Malformed JSON command: ") + error.what());
+    }
+    const json::Value* cmd = message.find("cmd");
+    const json::Value* label = message.find("label");
+    if (cmd == nullptr || !cmd->is_string() || label == nullptr || !label->is_string()) {
+        throw CommandCodecError("JSON command requires string \"cmd\" and \"label\" members");
+    }
+    TimerCommand command;
+    command.label = Label(label->as_string_view());
+    const std::string& name = cmd->as_string();
+    if (name == "start") {
+        const json::Value* time = message.find("time");
+        if (time == nullptr || !time->is_number()) {
+            throw CommandCodecError("JSON start command requires a numeric \"time\"");
+        }
+        command.op = TimerOp::Start;
+        command.seconds = static_cast<int>(time->as_number());
+    } else if (name == "reset") {
+        command.op = TimerOp::Reset;
+    } else if (name == "cancel") {
+        command.op = TimerOp::Cancel;
+    } else {
+        throw CommandCodecError("Unknown JSON command: " + name);
+    }
+    return command;
+}
+
+}  // namespace
+
+CommandCodecError::CommandCodecError(const std::string& message) : std::runtime_error(message) {}
+
+char* EncodedCommand::reserve(std::size_t capacity) {
+    size_ = 0;
+    if (capacity <= kInlineCapacity) {
+        heap_.clear();
+        return inline_.data();
+    }
+    heap_.resize(capacity);
+    return heap_.data();
+}
+
+void EncodeCommand(const TimerCommand& command, WireFormat format, EncodedCommand& out) {
+    if (format == WireFormat::Binary) {
+        encode_binary(command, out);
+    } else {
+        encode_json(command, out);
+    }
+}
+
+WireFormat DetectWireFormat(std::string_view payload) noexcept {
+    return !payload.empty() && static_cast<unsigned char>(payload[0]) == codec::kBinaryMagic ? WireFormat::Binary
+                                                                                             : WireFormat::Json;
+}
+
+TimerCommand DecodeCommand(std::string_view payload) {
+    return DetectWireFormat(payload) == WireFormat::Binary ? decode_binary(payload) : decode_json(payload);
+}
+
+const char* to_string(WireFormat format) noexcept {
+    switch (format) {
+        case WireFormat::Json:
+            return "json";
+        case WireFormat::Binary:
+            return "binary";
+    }
+    return "unknown";
+}
+
+WireFormat ParseWireFormat(const std::string& text) {
+    for (WireFormat format : {WireFormat::Json, WireFormat::Binary}) {
+        if (text == to_string(format)) {
+            return format;
+        }
+    }
+    throw std::invalid_argument("Unknown wire format: " + text);
+}
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,286 @@
+#include "mcp_sandtimer/CommandRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include "MappedFile.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace mcp_sandtimer {
+namespace {
+constexpr char kMagic[8] = {'S', 'T', 'R', 'I', 'N', 'G', '0', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr int kSpinIterations = 4096;
+// 没有 futex 的平台上，睡眠中的消费者按这个间隔重新检查
+constexpr auto kPollInterval = std::chrono::milliseconds(1);
+
+enum ConsumerState : std::uint32_t { kOffline = 0, kPolling = 1, kSleeping = 2 };
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "ring positions must be lock-free to be shared");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "futex word must be lock-free to be shared");
+
+inline void cpu_relax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// 区域是跨进程映射的，futex 不能带 FUTEX_PRIVATE_FLAG
+void wait_on(std::atomic<std::uint32_t>& word, std::uint32_t expected, std::chrono::nanoseconds timeout) {
+#if defined(__linux__)
+    timespec relative{};
+    relative.tv_sec = static_cast<std::time_t>(timeout.count() / 1000000000);
+    relative.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+#else
+    if (word.load(std::memory_order_acquire) == expected) {
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, kPollInterval));
+    }
+#endif
+}
+
+void wake_one(std::atomic<std::uint32_t>& word) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+std::size_t round_up_power_of_two(std::size_t value) {
+    std::size_t result = 2;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+}  // namespace
+
+// 区域布局：Header 后紧跟 capacity 个定长 Record。head/tail 为单调递增的位置，槽位 = 位置 & (capacity - 1)。
+// 生产者与消费者各自写入的字段放在不同的缓存行上，避免伪共享
+struct CommandRing::Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint64_t capacity;
+    alignas(64) std::atomic<std::uint64_t> head;  // 生产者写
+    alignas(64) std::atomic<std::uint64_t> tail;  // 消费者写
+    alignas(64) std::atomic<std::uint32_t> consumer_state;
+    std::atomic<std::uint32_t> wake_sequence;  // futex 字，生产者唤醒前递增
+    std::atomic<std::uint64_t> wakeups;
+};
+
+struct alignas(64) CommandRing::Record {
+    std::uint8_t op;
+    std::uint8_t reserved;
+    std::uint16_t label_length;
+    std::int32_t seconds;
+    char label[kMaxLabelLength];
+};
+
+CommandRingError::CommandRingError(const std::string& message) : std::runtime_error(message) {}
+
+json::Value CommandRing::Stats::ToJson() const {
+    return json::make_object({
+        {"capacity", json::Value(static_cast<double>(capacity))},
+        {"depth", json::Value(static_cast<double>(depth))},
+        {"pushed", json::Value(static_cast<double>(pushed))},
+        {"popped", json::Value(static_cast<double>(popped))},
+        {"wakeups", json::Value(static_cast<double>(wakeups))},
+        {"consumerOnline", json::Value(consumer_online)}
+    });
+}
+
+CommandRing::CommandRing(const std::string& path, Role role, std::size_t capacity)
+    : path_(path), role_(role), file_(std::make_unique<MappedFile>()) {
+    if (path_.empty()) {
+        throw CommandRingError("Shared-memory ring path must not be empty");
+    }
+    try {
+        if (role_ == Role::Consumer) {
+            capacity_ = round_up_power_of_two(capacity);
+            mask_ = capacity_ - 1;
+            file_->open(path_, sizeof(Header) + capacity_ * sizeof(Record));
+        } else {
+            std::error_code error;
+            const auto size = std::filesystem::file_size(path_, error);
+            if (error || size < sizeof(Header)) {
+                throw CommandRingError("No shared-memory ring at " + path_);
+            }
+            file_->open(path_, static_cast<std::size_t>(size));
+        }
+    } catch (const CommandRingError&) {
+        throw;
+    } catch (const std::runtime_error& error) {
+        throw CommandRingError(error.what());
+    }
+    header_ = reinterpret_cast<Header*>(file_->data());
+    records_ = reinterpret_cast<Record*>(file_->data() + sizeof(Header));
+
+    // 消费者最后写入 magic，生产者看到 magic 时其余字段已经就绪
+    const bool formatted = std::memcmp(header_->magic, kMagic, sizeof(kMagic)) == 0 &&
+                           header_->version == kVersion && header_->record_size == sizeof(Record);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (role_ == Role::Consumer) {
+        if (!file_->existed() || !formatted) {
+            initialize();
+        } else if (header_->capacity != capacity_) {
+            throw CommandRingError("Shared-memory ring " + path_ + " was created with a different capacity");
+        }
+        header_->consumer_state.store(kPolling, std::memory_order_release);
+        return;
+    }
+    if (!formatted || header_->capacity < 2 || (header_->capacity & (header_->capacity - 1)) != 0 ||
+        sizeof(Header) + header_->capacity * sizeof(Record) > file_->size()) {
+        throw CommandRingError("Shared-memory ring " + path_ + " is not initialised");
+    }
+    capacity_ = static_cast<std::size_t>(header_->capacity);
+    cached_tail_ = header_->tail.load(std::memory_order_acquire);
+    mask_ = capacity_ - 1;
+}
+
+CommandRing::~CommandRing() {
+    if (role_ == Role::Consumer && header_ != nullptr) {
+        header_->consumer_state.store(kOffline, std::memory_order_release);
+    }
+    file_->close();
+}
+
+std::string CommandRing::DefaultPath(const std::string& name) {
+#if defined(__linux__)
+    return "/dev/shm/" + name;
+#else
+    return (std::filesystem::temp_directory_path() / name).string();
+#endif
+}
+
+void CommandRing::initialize() {
+    std::memset(header_->magic, 0, sizeof(header_->magic));
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->version = kVersion;
+    header_->record_size = sizeof(Record);
+    header_->capacity = capacity_;
+    header_->head.store(0, std::memory_order_relaxed);
+    header_->tail.store(0, std::memory_order_relaxed);
+    header_->consumer_state.store(kOffline, std::memory_order_relaxed);
+    header_->wake_sequence.store(0, std::memory_order_relaxed);
+    header_->wakeups.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, kMagic, sizeof(kMagic));
+}
+
+bool CommandRing::try_push(const TimerCommand& command) {
+    if (command.label.size() > kMaxLabelLength) {
+        throw CommandRingError("Label is too long for the shared-memory ring");
+    }
+    const std::uint64_t head = header_->head.load(std::memory_order_relaxed);
+    if (head - cached_tail_ >= capacity_) {
+        cached_tail_ = header_->tail.load(std::memory_order_acquire);
+        if (head - cached_tail_ >= capacity_) {
+            return false;
+        }
+    }
+    Record& record = records_[head & mask_];
+    record.op = static_cast<std::uint8_t>(command.op);
+    record.label_length = static_cast<std::uint16_t>(command.label.size());
+    record.seconds = command.seconds;
+    std::memcpy(record.label, command.label.data(), command.label.size());
+    // 与消费者“先标记睡眠再检查 head”配对（seq_cst），双方至少有一方看到对方的写入，唤醒不会丢
+    header_->head.store(head + 1, std::memory_order_seq_cst);
+    wake_consumer();
+    return true;
+}
+
+void CommandRing::wake_consumer() {
+    std::uint32_t expected = kSleeping;
+    if (header_->consumer_state.load(std::memory_order_seq_cst) != kSleeping ||
+        !header_->consumer_state.compare_exchange_strong(expected, kPolling, std::memory_order_seq_cst)) {
+        return;
+    }
+    header_->wake_sequence.fetch_add(1, std::memory_order_release);
+    header_->wakeups.fetch_add(1, std::memory_order_relaxed);
+    wake_one(header_->wake_sequence);
+}
+
+bool CommandRing::try_pop(TimerCommand& command) {
+    const std::uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    if (header_->head.load(std::memory_order_acquire) == tail) {
+        return false;
+    }
+    const Record& record = records_[tail & mask_];
+    command.op = static_cast<TimerOp>(record.op);
+    command.seconds = record.seconds;
+    command.label = Label(std::string_view(record.label, std::min<std::size_t>(record.label_length, kMaxLabelLength)));
+    header_->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool CommandRing::pop(TimerCommand& command, std::chrono::milliseconds timeout) {
+    if (try_pop(command)) {
+        return true;
+    }
+    for (int spin = 0; spin < kSpinIterations; ++spin) {
+        cpu_relax();
+        if (try_pop(command)) {
+            return true;
+        }
+    }
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        const std::uint32_t sequence = header_->wake_sequence.load(std::memory_order_acquire);
+        header_->consumer_state.store(kSleeping, std::memory_order_seq_cst);
+        if (header_->head.load(std::memory_order_seq_cst) != header_->tail.load(std::memory_order_relaxed)) {
+            header_->consumer_state.store(kPolling, std::memory_order_relaxed);
+            return try_pop(command);
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            header_->consumer_state.store(kPolling, std::memory_order_relaxed);
+            return false;
+        }
+        wait_on(header_->wake_sequence, sequence, deadline - now);
+        header_->consumer_state.store(kPolling, std::memory_order_relaxed);
+        if (try_pop(command)) {
+            return true;
+        }
+    }
+}
+
+bool CommandRing::consumer_online() const noexcept {
+    return header_->consumer_state.load(std::memory_order_acquire) != kOffline;
+}
+
+std::size_t CommandRing::size() const noexcept {
+    const std::uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    const std::uint64_t head = header_->head.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(head - tail);
+}
+
+CommandRing::Stats CommandRing::stats() const {
+    Stats stats;
+    stats.capacity = capacity_;
+    stats.popped = header_->tail.load(std::memory_order_acquire);
+    stats.pushed = header_->head.load(std::memory_order_acquire);
+    stats.depth = static_cast<std::size_t>(stats.pushed - stats.popped);
+    stats.wakeups = header_->wakeups.load(std::memory_order_relaxed);
+    stats.consumer_online = consumer_online();
+    return stats;
+}
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,310 @@
+#include "mcp_sandtimer/CommandSpool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "MappedFile.h"
+
+namespace mcp_sandtimer {
+namespace {
+constexpr char kMagic[8] = {'S', 'T', 'S', 'P', 'O', 'O', 'L', '1'};
+constexpr std::uint32_t kVersion = 1;
+
+enum RecordState : std::uint8_t { kEmpty = 0, kPending = 1, kSuperseded = 2 };
+}  // namespace
+
+// 文件布局：Header 后紧跟 capacity 个定长 Record。head/tail 为单调递增的位置，槽位 = 位置 % capacity
+struct CommandSpool::Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint64_t capacity;
+    std::uint64_t head;
+    std::uint64_t tail;
+    std::uint64_t next_sequence;
+};
+
+struct CommandSpool::Record {
+    std::uint64_t sequence;
+    std::uint8_t state;
+    std::uint8_t op;
+    std::uint16_t label_length;
+    std::int32_t seconds;
+    char label[kMaxLabelLength];
+};
+
+SpoolError::SpoolError(const std::string& message) : std::runtime_error(message) {}
+
+CommandSpool::CommandSpool(TimerClient client, Options options)
+    : client_(std::move(client)), options_(std::move(options)), file_(std::make_unique<MappedFile>()) {
+    if (options_.path.empty()) {
+        throw SpoolError("Spool path must not be empty");
+    }
+    options_.capacity = std::max<std::size_t>(1, options_.capacity);
+    const std::size_t size = sizeof(Header) + options_.capacity * sizeof(Record);
+    try {
+        file_->open(options_.path, size);
+    } catch (const std::runtime_error& error) {
+        throw SpoolError(error.what());
+    }
+    header_ = reinterpret_cast<Header*>(file_->data());
+    records_ = reinterpret_cast<Record*>(file_->data() + sizeof(Header));
+
+    const bool valid = file_->existed() && std::memcmp(header_->magic, kMagic, sizeof(kMagic)) == 0 &&
+                       header_->version == kVersion && header_->record_size == sizeof(Record);
+    if (!valid) {
+        initialize_file();
+    } else if (header_->capacity != options_.capacity) {
+        throw SpoolError("Spool file " + options_.path + " was created with a different capacity");
+    } else {
+        recover();
+    }
+    sender_ = std::thread([this] { run(); });
+}
+
+CommandSpool::~CommandSpool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_.notify_all();
+    space_.notify_all();
+    if (sender_.joinable()) {
+        sender_.join();
+    }
+    file_->close();
+}
+
+CommandSpool::Record& CommandSpool::slot(std::uint64_t position) const {
+    return records_[position % header_->capacity];
+}
+
+void CommandSpool::initialize_file() {
+    std::memset(file_->data(), 0, file_->size());
+    std::memcpy(header_->magic, kMagic, sizeof(kMagic));
+    header_->version = kVersion;
+    header_->record_size = sizeof(Record);
+    header_->capacity = options_.capacity;
+    header_->head = 0;
+    header_->tail = 0;
+    header_->next_sequence = 1;
+    file_->flush();
+}
+
+// 重启后重建 label 索引；上次写到一半（状态仍为空）的记录直接丢弃
+void CommandSpool::recover() {
+    if (header_->tail < header_->head || header_->tail - header_->head > header_->capacity) {
+        initialize_file();
+        return;
+    }
+    for (std::uint64_t position = header_->head; position < header_->tail; ++position) {
+        Record& record = slot(position);
+        if (record.state != kPending) {
+            continue;
+        }
+        const std::size_t length = std::min<std::size_t>(record.label_length, kMaxLabelLength);
+        pending_by_label_[Label(std::string_view(record.label, length))].push_back(position);
+        ++stats_.recovered;
+    }
+}
+
+void CommandSpool::append(const TimerCommand& command) {
+    if (command.label.size() > kMaxLabelLength) {
+        throw SpoolError("Label is too long to be spooled");
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    const std::string_view label = command.label;
+    const bool supersedes = command.op != TimerOp::Reset;
+
+    // 紧跟在待发 start/reset 之后的 reset 没有额外效果，直接丢弃
+    auto iter = pending_by_label_.find(command.label);
+    if (!supersedes && iter != pending_by_label_.end() && !iter->second.empty() &&
+        static_cast<TimerOp>(slot(iter->second.back()).op) != TimerOp::Cancel) {
+        ++stats_.superseded;
+        return;
+    }
+
+    // 先腾出空间再合并：因队列满而抛出时，同一 label 之前的待发命令原样保留。
+    // 队首若是这条 start/cancel 将要覆盖的命令，可以直接释放
+    while (header_->tail - header_->head >= header_->capacity) {
+        if (header_->head < header_->tail) {
+            const Record& head = slot(header_->head);
+            if (head.state != kPending) {
+                release_head_locked();
+                continue;
+            }
+            if (supersedes &&
+                std::string_view(head.label, std::min<std::size_t>(head.label_length, kMaxLabelLength)) == label) {
+                release_head_locked();
+                ++stats_.superseded;
+                continue;
+            }
+        }
+        switch (options_.backpressure) {
+            case Backpressure::Reject:
+                ++stats_.rejected;
+                throw SpoolError("Command spool is full");
+            case Backpressure::DropOldest:
+                release_head_locked();
+                ++stats_.dropped;
+                break;
+            case Backpressure::Block:
+                if (!space_.wait_for(lock, options_.block_timeout, [this] {
+                        return stopping_ || header_->tail - header_->head < header_->capacity;
+                    })) {
+                    ++stats_.rejected;
+                    throw SpoolError("Timed out waiting for space in the command spool");
+                }
+                if (stopping_) {
+                    throw SpoolError("Command spool is shutting down");
+                }
+                break;
+        }
+    }
+
+    // 空间已经有了，再合并同一 label 上被取代的命令：start/cancel 覆盖之前所有待发命令。
+    // 等待期间索引可能变化，重新查找
+    iter = pending_by_label_.find(command.label);
+    if (supersedes && iter != pending_by_label_.end()) {
+        for (std::uint64_t position : iter->second) {
+            slot(position).state = kSuperseded;
+            ++stats_.superseded;
+        }
+        iter->second.clear();
+    }
+
+    const std::uint64_t position = header_->tail;
+    Record& record = slot(position);
+    record.state = kEmpty;
+    record.sequence = header_->next_sequence++;
+    record.op = static_cast<std::uint8_t>(command.op);
+    record.seconds = command.seconds;
+    record.label_length = static_cast<std::uint16_t>(command.label.size());
+    std::memcpy(record.label, command.label.data(), command.label.size());
+    // 先写完记录内容再标记为待发并推进 tail
+    record.state = kPending;
+    header_->tail = position + 1;
+    pending_by_label_[command.label].push_back(position);
+    ++stats_.appended;
+    lock.unlock();
+    work_.notify_one();
+}
+
+void CommandSpool::release_head_locked() {
+    Record& record = slot(header_->head);
+    if (record.state == kPending) {
+        const Label label(std::string_view(record.label, std::min<std::size_t>(record.label_length, kMaxLabelLength)));
+        auto iter = pending_by_label_.find(label);
+        if (iter != pending_by_label_.end()) {
+            auto& positions = iter->second;
+            positions.erase(std::remove(positions.begin(), positions.end(), header_->head), positions.end());
+            if (positions.empty()) {
+                pending_by_label_.erase(iter);
+            }
+        }
+    }
+    record.state = kEmpty;
+    ++header_->head;
+    space_.notify_all();
+}
+
+// 后台发送线程：按顺序取出队首命令发送，失败后间隔重试，送达后才释放记录
+void CommandSpool::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_.wait(lock, [this] { return stopping_ || header_->head < header_->tail; });
+        if (stopping_) {
+            break;
+        }
+        Record& record = slot(header_->head);
+        if (record.state != kPending) {
+            release_head_locked();
+            continue;
+        }
+        const std::uint64_t sequence = record.sequence;
+        TimerCommand command;
+        command.op = static_cast<TimerOp>(record.op);
+        command.label = Label(std::string_view(record.label, std::min<std::size_t>(record.label_length, kMaxLabelLength)));
+        command.seconds = record.seconds;
+
+        lock.unlock();
+        bool delivered = true;
+        try {
+            client_.send(command);
+        } catch (const TimerClientError&) {
+            delivered = false;
+        }
+        lock.lock();
+
+        if (delivered) {
+            ++stats_.delivered;
+            // 发送期间这条记录可能已被 DropOldest 挤掉
+            if (header_->head < header_->tail && slot(header_->head).sequence == sequence) {
+                release_head_locked();
+            }
+            continue;
+        }
+        ++stats_.send_failures;
+        work_.wait_for(lock, options_.retry_interval, [this] { return stopping_; });
+    }
+    file_->flush();
+}
+
+std::size_t CommandSpool::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<std::size_t>(header_->tail - header_->head);
+}
+
+bool CommandSpool::wait_until_drained(std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return space_.wait_for(lock, timeout, [this] { return header_->head == header_->tail; });
+}
+
+CommandSpool::Stats CommandSpool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.depth = static_cast<std::size_t>(header_->tail - header_->head);
+    return stats;
+}
+
+json::Value CommandSpool::Stats::ToJson() const {
+    return json::make_object({
+        {"depth", json::Value(static_cast<double>(depth))},
+        {"appended", json::Value(static_cast<double>(appended))},
+        {"delivered", json::Value(static_cast<double>(delivered))},
+        {"superseded", json::Value(static_cast<double>(superseded))},
+        {"dropped", json::Value(static_cast<double>(dropped))},
+        {"rejected", json::Value(static_cast<double>(rejected))},
+        {"sendFailures", json::Value(static_cast<double>(send_failures))},
+        {"recovered", json::Value(static_cast<double>(recovered))}
+    });
+}
+
+const char* to_string(CommandSpool::Backpressure policy) noexcept {
+    switch (policy) {
+        case CommandSpool::Backpressure::Reject:
+            return "reject";
+        case CommandSpool::Backpressure::DropOldest:
+            return "drop-oldest";
+        case CommandSpool::Backpressure::Block:
+            return "block";
+    }
+    return "unknown";
+}
+
+CommandSpool::Backpressure ParseBackpressure(const std::string& text) {
+    if (text == "reject") {
+        return CommandSpool::Backpressure::Reject;
+    }
+    if (text == "drop-oldest") {
+        return CommandSpool::Backpressure::DropOldest;
+    }
+    if (text == "block") {
+        return CommandSpool::Backpressure::Block;
+    }
+    throw std::invalid_argument("Unknown spool backpressure policy: " + text);
+}
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,50 @@
+#include "mcp_sandtimer/HashRing.h"
+
+namespace mcp_sandtimer {
+
+HashRing::HashRing(const std::vector<std::string>& nodes, std::size_t virtual_nodes) : node_count_(nodes.size()) {
+    virtual_nodes = std::max<std::size_t>(1, virtual_nodes);
+    points_.reserve(nodes.size() * virtual_nodes);
+    for (std::size_t node = 0; node < nodes.size(); ++node) {
+        for (std::size_t replica = 0; replica < virtual_nodes; ++replica) {
+            points_.push_back(Point{Hash(nodes[node] + '#' + std::to_string(replica)), static_cast<std::uint32_t>(node)});
+        }
+    }
+    // 哈希相同时按节点下标排序，同样的节点列表总能得到同样的环
+    std::sort(points_.begin(), points_.end(), [](const Point& a, const Point& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.node < b.node;
+    });
+}
+
+std::vector<double> HashRing::ownership() const {
+    std::vector<double> shares(node_count_, 0.0);
+    if (points_.size() == 1) {
+        shares[points_.front().node] = 1.0;
+    }
+    if (points_.size() <= 1) {
+        return shares;
+    }
+    constexpr double kRingSize = 18446744073709551616.0;  // 2^64
+    for (std::size_t i = 0; i < points_.size(); ++i) {
+        // 虚拟节点负责 (前一个点, 自身] 这段弧；第一个点还负责环尾回绕的部分
+        const std::uint64_t previous = i == 0 ? points_.back().hash : points_[i - 1].hash;
+        shares[points_[i].node] += static_cast<double>(points_[i].hash - previous) / kRingSize;
+    }
+    return shares;
+}
+
+std::uint64_t HashRing::Hash(std::string_view key) noexcept {
+    std::uint64_t hash = 1469598103934665603ull;
+    for (char ch : key) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 1099511628211ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+}  // namespace mcp_sandtimer
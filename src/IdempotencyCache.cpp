@@ -0,0 +1,137 @@
+#include "mcp_sandtimer/IdempotencyCache.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace mcp_sandtimer {
+
+namespace {
+// 带取消信号等待时的轮询间隔，与 TimerClient 放弃在途连接的粒度一致
+constexpr std::chrono::milliseconds kCancellationPoll{10};
+}  // namespace
+
+IdempotencyCache::IdempotencyCache(Options options) : options_(options) {}
+
+IdempotencyCache::Result IdempotencyCache::run(const std::string& key, const CallOptions& options,
+                                               const std::function<std::string()>& compute) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool joined = false;
+    for (;;) {
+        const auto cached = index_.find(key);
+        if (cached != index_.end()) {
+            if (clock::now() < cached->second->expires) {
+                entries_.splice(entries_.begin(), entries_, cached->second);
+                ++stats_.hits;
+                return Result{cached->second->value, Source::Cached};
+            }
+            entries_.erase(cached->second);
+            index_.erase(cached);
+            ++stats_.expired;
+        }
+        const auto pending = flights_.find(key);
+        if (pending == flights_.end()) {
+            break;
+        }
+        const std::shared_ptr<Flight> flight = pending->second;
+        if (!joined) {
+            joined = true;
+            ++stats_.joined;
+        }
+        while (!flight->done) {
+            const bool cancelled = options.cancellation != nullptr && options.cancellation->cancelled();
+            if (cancelled) {
+                throw RequestCancelledError("Request was cancelled while waiting for an identical request");
+            }
+            if (clock::now() >= options.deadline) {
+                throw DeadlineExceededError("Request deadline expired while waiting for an identical request");
+            }
+            auto wake = options.deadline;
+            if (options.cancellation != nullptr) {
+                wake = std::min(wake, clock::now() + kCancellationPoll);
+            }
+            if (wake == clock::time_point::max()) {
+                done_.wait(lock);
+            } else {
+                done_.wait_until(lock, wake);
+            }
+        }
+        if (!flight->failed) {
+            return Result{flight->value, Source::Joined};
+        }
+        // 执行的那次调用失败了（可能只是它自己被取消），重新查找，必要时由本次调用执行
+    }
+
+    ++stats_.misses;
+    const auto flight = std::make_shared<Flight>();
+    flights_.emplace(key, flight);
+    lock.unlock();
+    std::string value;
+    try {
+        value = compute();
+    } catch (...) {
+        lock.lock();
+        flight->done = true;
+        flight->failed = true;
+        flights_.erase(key);
+        done_.notify_all();
+        throw;
+    }
+    lock.lock();
+    flight->value = value;
+    flight->done = true;
+    flights_.erase(key);
+    store_locked(key, value);
+    done_.notify_all();
+    return Result{std::move(value), Source::Computed};
+}
+
+// 插入到最前；先丢掉队尾已过期的条目，仍超出容量时淘汰最久未用的
+void IdempotencyCache::store_locked(const std::string& key, const std::string& value) {
+    const clock::time_point now = clock::now();
+    while (!entries_.empty() && entries_.back().expires <= now) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+        ++stats_.expired;
+    }
+    entries_.push_front(Entry{key, value, now + options_.ttl});
+    index_[key] = entries_.begin();
+    while (entries_.size() > std::max<std::size_t>(options_.capacity, 1)) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+        ++stats_.evicted;
+    }
+}
+
+IdempotencyCache::Stats IdempotencyCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.entries = entries_.size();
+    stats.in_flight = flights_.size();
+    return stats;
+}
+
+json::Value IdempotencyCache::Stats::ToJson() const {
+    return json::make_object({
+        {"hits", json::Value(static_cast<double>(hits))},
+        {"joined", json::Value(static_cast<double>(joined))},
+        {"misses", json::Value(static_cast<double>(misses))},
+        {"expired", json::Value(static_cast<double>(expired))},
+        {"evicted", json::Value(static_cast<double>(evicted))},
+        {"entries", json::Value(static_cast<double>(entries))},
+        {"inFlight", json::Value(static_cast<double>(in_flight))}
+    });
+}
+
+const char* to_string(IdempotencyCache::Source source) noexcept {
+    switch (source) {
+        case IdempotencyCache::Source::Computed:
+            return "computed";
+        case IdempotencyCache::Source::Cached:
+            return "cached";
+        case IdempotencyCache::Source::Joined:
+            return "joined";
+    }
+    return "unknown";
+}
+
+}  // namespace mcp_sandtimer
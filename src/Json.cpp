@@ -11,21 +11,87 @@
 #include <stdexcept>
 #include <string_view>
 #include <utility>
+#include <vector>
+
+#include "mcp_sandtimer/AllocationTracker.h"
 
 namespace mcp_sandtimer::json {
 
 namespace {
 
+void append_utf8(uint32_t codepoint, std::string& out) {
+    if (codepoint <= 0x7F) {
+        out.push_back(static_cast<char>(codepoint));
+    } else if (codepoint <= 0x7FF) {
+        out.push_back(static_cast<char>(0xC0 | ((codepoint >> 6) & 0x1F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    } else if (codepoint <= 0xFFFF) {
+        out.push_back(static_cast<char>(0xE0 | ((codepoint >> 12) & 0x0F)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | ((codepoint >> 18) & 0x07)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+// 把已经通过语法检查的数字文本转换为 Value；批量解析与流式解析共用
+Value number_from_text(std::string_view slice) {
+    // 常见的短整数直接累加，避免 strtod 与临时字符串
+    const bool negative = slice.front() == '-';
+    const std::size_t digits = slice.size() - (negative ? 1 : 0);
+    if (digits <= 15 && slice.find_first_of(".eE") == std::string_view::npos) {
+        std::int64_t integer = 0;
+        for (std::size_t i = negative ? 1 : 0; i < slice.size(); ++i) {
+            integer = integer * 10 + (slice[i] - '0');
+        }
+        return Value(negative ? -static_cast<double>(integer) : static_cast<double>(integer));
+    }
+    std::string buffer(slice);
+    char* end_ptr = nullptr;
+    double value = std::strtod(buffer.c_str(), &end_ptr);
+    if (end_ptr == buffer.c_str()) {
+        throw ParseError("Failed to parse numeric value");
+    }
+    return Value(value);
+}
+
+// 十六进制数字的值，非法字符返回 -1
+int hex_digit(char ch) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return 10 + (ch - 'a');
+    }
+    if (ch >= 'A' && ch <= 'F') {
+        return 10 + (ch - 'A');
+    }
+    return -1;
+}
+
+bool is_whitespace(char ch) {
+    return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t';
+}
+
+// 显式栈的迭代解析器：嵌套深度、负载大小与字符串长度都有上限，
+// 恶意输入在分配内存之前就会被拒绝，也不会耗尽调用栈
 class Parser {
 public:
-    Parser(const char* data, std::size_t size) : data_(data), size_(size) {}
+    Parser(const char* data, std::size_t size, const ParseLimits& limits)
+        : data_(data), size_(size), limits_(limits) {}
 
     Value parse() {
+        if (size_ > limits_.max_payload) {
+            throw ParseError("JSON payload exceeds the maximum size of " + std::to_string(limits_.max_payload) + " bytes");
+        }
         skip_whitespace();
         if (pos_ >= size_) {
             throw ParseError("Unexpected end of input");
         }
-        Value result = parse_value();
+        Value result = parse_document();
         skip_whitespace();
         if (pos_ != size_) {
             throw ParseError("Unexpected trailing data in JSON payload");
@@ -34,18 +100,23 @@ public:
     }
 
 private:
+    // 尚未闭合的容器；对象成员的键在读到值之前暂存在 key 中
+    struct Frame {
+        bool is_object;
+        Value::Object object;
+        Value::Array array;
+        std::string key;
+    };
+
     const char* data_;
     std::size_t size_;
+    const ParseLimits& limits_;
     std::size_t pos_ = 0;
+    std::vector<Frame> stack_;
 
     void skip_whitespace() {
-        while (pos_ < size_) {
-            unsigned char ch = static_cast<unsigned char>(data_[pos_]);
-            if (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t') {
-                ++pos_;
-            } else {
-                break;
-            }
+        while (pos_ < size_ && is_whitespace(data_[pos_])) {
+            ++pos_;
         }
     }
 
@@ -68,21 +139,101 @@ private:
         return data_[pos_++];
     }
 
-    Value parse_value() {
+    Value parse_document() {
+        Value value;
+        for (;;) {
+            // 读一个值；遇到非空容器时压栈，继续读它的第一个元素
+            const char ch = peek();
+            if (ch == '{' || ch == '[') {
+                if (stack_.size() >= limits_.max_depth) {
+                    throw ParseError("JSON nesting exceeds the maximum depth of " + std::to_string(limits_.max_depth));
+                }
+                ++pos_;
+                skip_whitespace();
+                if (ch == '{') {
+                    if (consume('}')) {
+                        value = Value(Value::Object{});
+                    } else {
+                        stack_.push_back(Frame{true, {}, {}, {}});
+                        read_key(stack_.back().key);
+                        continue;
+                    }
+                } else if (consume(']')) {
+                    value = Value(Value::Array{});
+                } else {
+                    stack_.push_back(Frame{false, {}, {}, {}});
+                    continue;
+                }
+            } else {
+                value = parse_scalar();
+            }
+
+            // 把值挂到父容器上；父容器结束时出栈并继续向上挂
+            for (;;) {
+                if (stack_.empty()) {
+                    return value;
+                }
+                Frame& top = stack_.back();
+                if (top.is_object) {
+                    top.object.try_emplace(std::move(top.key), std::move(value));
+                } else {
+                    top.array.push_back(std::move(value));
+                }
+                skip_whitespace();
+                if (consume(',')) {
+                    skip_whitespace();
+                    if (top.is_object) {
+                        read_key(top.key);
+                    }
+                    break;
+                }
+                if (top.is_object) {
+                    if (!consume('}')) {
+                        throw ParseError("Expected comma in object");
+                    }
+                    value = Value(std::move(top.object));
+                } else {
+                    if (!consume(']')) {
+                        throw ParseError("Expected comma in array");
+                    }
+                    value = Value(std::move(top.array));
+                }
+                stack_.pop_back();
+            }
+        }
+    }
+
+    // 读取 "key" : 并停在值的第一个字符上
+    void read_key(std::string& key) {
+        if (peek() != '"') {
+            throw ParseError("Expected string key in object");
+        }
+        key.clear();
+        parse_string_into(key);
+        skip_whitespace();
+        if (!consume(':')) {
+            throw ParseError("Expected ':' after object key");
+        }
+        skip_whitespace();
+    }
+
+    Value parse_scalar() {
         char ch = peek();
         switch (ch) {
             case 'n':
-                return parse_null();
+                expect_literal("null");
+                return Value(nullptr);
             case 't':
-                return parse_true();
+                expect_literal("true");
+                return Value(true);
             case 'f':
-                return parse_false();
-            case '"':
-                return parse_string();
-            case '{':
-                return parse_object();
-            case '[':
-                return parse_array();
+                expect_literal("false");
+                return Value(false);
+            case '"': {
+                std::string text;
+                parse_string_into(text);
+                return Value(std::move(text));
+            }
             default:
                 if (ch == '-' || std::isdigit(static_cast<unsigned char>(ch))) {
                     return parse_number();
@@ -91,21 +242,6 @@ private:
         }
     }
 
-    Value parse_null() {
-        expect_literal("null");
-        return Value(nullptr);
-    }
-
-    Value parse_true() {
-        expect_literal("true");
-        return Value(true);
-    }
-
-    Value parse_false() {
-        expect_literal("false");
-        return Value(false);
-    }
-
     void expect_literal(std::string_view literal) {
         if (size_ - pos_ < literal.size()) {
             throw ParseError("Unexpected end of input");
@@ -116,70 +252,81 @@ private:
         pos_ += literal.size();
     }
 
-    Value parse_string() {
+    void check_string_length(std::size_t length) const {
+        if (length > limits_.max_string_length) {
+            throw ParseError("JSON string exceeds the maximum length of " + std::to_string(limits_.max_string_length) +
+                             " bytes");
+        }
+    }
+
+    void parse_string_into(std::string& result) {
         if (!consume('"')) {
             throw ParseError("Expected opening quote for string");
         }
-        std::string result;
-        while (pos_ < size_) {
-            char ch = get();
-            if (ch == '"') {
-                return Value(std::move(result));
+        while (true) {
+            // 不含转义的片段整段追加
+            const std::size_t start = pos_;
+            while (pos_ < size_ && data_[pos_] != '"' && data_[pos_] != '\\') {
+                ++pos_;
             }
-            if (ch == '\\') {
-                if (pos_ >= size_) {
-                    throw ParseError("Invalid escape sequence");
-                }
-                char escape = get();
-                switch (escape) {
-                    case '"':
-                        result.push_back('"');
-                        break;
-                    case '\\':
-                        result.push_back('\\');
-                        break;
-                    case '/':
-                        result.push_back('/');
-                        break;
-                    case 'b':
-                        result.push_back('\b');
-                        break;
-                    case 'f':
-                        result.push_back('\f');
-                        break;
-                    case 'n':
-                        result.push_back('\n');
-                        break;
-                    case 'r':
-                        result.push_back('\r');
-                        break;
-                    case 't':
-                        result.push_back('\t');
-                        break;
-                    case 'u': {
-                        uint32_t codepoint = parse_hex4();
-                        if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
-                            // High surrogate; expect another \uXXXX sequence.
-                            if (!(consume('\\') && consume('u'))) {
-                                throw ParseError("Invalid Unicode surrogate pair");
-                            }
-                            uint32_t low = parse_hex4();
-                            if (low < 0xDC00 || low > 0xDFFF) {
-                                throw ParseError("Invalid Unicode surrogate pair");
-                            }
-                            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+            check_string_length(result.size() + (pos_ - start));
+            result.append(data_ + start, pos_ - start);
+            if (pos_ >= size_) {
+                throw ParseError("Unterminated string literal");
+            }
+            if (data_[pos_++] == '"') {
+                return;
+            }
+            if (pos_ >= size_) {
+                throw ParseError("Invalid escape sequence");
+            }
+            char escape = get();
+            switch (escape) {
+                case '"':
+                    result.push_back('"');
+                    break;
+                case '\\':
+                    result.push_back('\\');
+                    break;
+                case '/':
+                    result.push_back('/');
+                    break;
+                case 'b':
+                    result.push_back('\b');
+                    break;
+                case 'f':
+                    result.push_back('\f');
+                    break;
+                case 'n':
+                    result.push_back('\n');
+                    break;
+                case 'r':
+                    result.push_back('\r');
+                    break;
+                case 't':
+                    result.push_back('\t');
+                    break;
+                case 'u': {
+                    uint32_t codepoint = parse_hex4();
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                        // High surrogate; expect another \uXXXX sequence.
+                        if (!(consume('\\') && consume('u'))) {
+                            throw ParseError("Invalid Unicode surrogate pair");
                         }
-                        append_utf8(codepoint, result);
-                        break;
+                        uint32_t low = parse_hex4();
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            throw ParseError("Invalid Unicode surrogate pair");
+                        }
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
                     }
-                    default:
-                        throw ParseError("Invalid escape sequence");
+                    append_utf8(codepoint, result);
+                    break;
                 }
-            } else {
-                result.push_back(ch);
+                default:
+                    throw ParseError("Invalid escape sequence");
             }
+            check_string_length(result.size());
         }
-        throw ParseError("Unterminated string literal");
     }
 
     uint32_t parse_hex4() {
@@ -188,39 +335,15 @@ private:
         }
         uint32_t value = 0;
         for (int i = 0; i < 4; ++i) {
-            char ch = data_[pos_++];
-            value <<= 4;
-            if (ch >= '0' && ch <= '9') {
-                value |= static_cast<uint32_t>(ch - '0');
-            } else if (ch >= 'a' && ch <= 'f') {
-                value |= static_cast<uint32_t>(10 + (ch - 'a'));
-            } else if (ch >= 'A' && ch <= 'F') {
-                value |= static_cast<uint32_t>(10 + (ch - 'A'));
-            } else {
+            const int digit = hex_digit(data_[pos_++]);
+            if (digit < 0) {
                 throw ParseError("Invalid character in Unicode escape");
             }
+            value = (value << 4) | static_cast<uint32_t>(digit);
         }
         return value;
     }
 
-    void append_utf8(uint32_t codepoint, std::string& out) {
-        if (codepoint <= 0x7F) {
-            out.push_back(static_cast<char>(codepoint));
-        } else if (codepoint <= 0x7FF) {
-            out.push_back(static_cast<char>(0xC0 | ((codepoint >> 6) & 0x1F)));
-            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-        } else if (codepoint <= 0xFFFF) {
-            out.push_back(static_cast<char>(0xE0 | ((codepoint >> 12) & 0x0F)));
-            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
-            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-        } else {
-            out.push_back(static_cast<char>(0xF0 | ((codepoint >> 18) & 0x07)));
-            out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
-            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
-            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-        }
-    }
-
     Value parse_number() {
         std::size_t start = pos_;
         if (consume('-')) {
@@ -261,71 +384,7 @@ private:
             }
         }
 
-        std::string_view slice(data_ + start, pos_ - start);
-        std::string buffer(slice);
-        char* end_ptr = nullptr;
-        double value = std::strtod(buffer.c_str(), &end_ptr);
-        if (end_ptr == buffer.c_str()) {
-            throw ParseError("Failed to parse numeric value");
-        }
-        return Value(value);
-    }
-
-    Value parse_array() {
-        if (!consume('[')) {
-            throw ParseError("Expected '[' to begin array");
-        }
-        Value::Array elements;
-        skip_whitespace();
-        if (consume(']')) {
-            return Value(std::move(elements));
-        }
-        while (true) {
-            skip_whitespace();
-            elements.emplace_back(parse_value());
-            skip_whitespace();
-            if (consume(']')) {
-                break;
-            }
-            if (!consume(',')) {
-                throw ParseError("Expected comma in array");
-            }
-        }
-        return Value(std::move(elements));
-    }
-
-    Value parse_object() {
-        if (!consume('{')) {
-            throw ParseError("Expected '{' to begin object");
-        }
-        Value::Object members;
-        skip_whitespace();
-        if (consume('}')) {
-            return Value(std::move(members));
-        }
-        while (true) {
-            skip_whitespace();
-            if (peek() != '"') {
-                throw ParseError("Expected string key in object");
-            }
-            Value key = parse_string();
-            std::string key_text = key.as_string();
-            skip_whitespace();
-            if (!consume(':')) {
-                throw ParseError("Expected ':' after object key");
-            }
-            skip_whitespace();
-            Value value = parse_value();
-            members.emplace(std::move(key_text), std::move(value));
-            skip_whitespace();
-            if (consume('}')) {
-                break;
-            }
-            if (!consume(',')) {
-                throw ParseError("Expected comma in object");
-            }
-        }
-        return Value(std::move(members));
+        return number_from_text(std::string_view(data_ + start, pos_ - start));
     }
 };
 
@@ -379,8 +438,8 @@ std::string number_to_string(double value) {
     oss.setf(std::ios::fmtflags(0), std::ios::floatfield);
     oss << std::setprecision(15) << value;
     std::string result = oss.str();
-    // Remove trailing zeros for integers.
-    if (result.find('.') != std::string::npos) {
+    // Remove trailing zeros for integers (never from an exponent such as "1e+30").
+    if (result.find('.') != std::string::npos && result.find_first_of("eE") == std::string::npos) {
         while (!result.empty() && result.back() == '0') {
             result.pop_back();
         }
@@ -405,14 +464,16 @@ Value::Value(int value) : type_(Type::Number), number_value_(static_cast<double>
 Value::Value(double value) : type_(Type::Number), number_value_(value) {}
 Value::Value(const char* value) : type_(Type::String), string_value_(value ? value : "") {}
 Value::Value(const std::string& value) : type_(Type::String), string_value_(value) {}
+Value::Value(std::string&& value) : type_(Type::String), string_value_(std::move(value)) {}
+Value::Value(std::string_view value) : type_(Type::String), string_value_(value) {}
 Value::Value(const Object& value)
-    : type_(Type::Object), object_value_(std::make_unique<Object>(value)) {}
+    : type_(Type::Object), object_value_(std::make_shared<Object>(value)) {}
 Value::Value(Object&& value)
-    : type_(Type::Object), object_value_(std::make_unique<Object>(std::move(value))) {}
+    : type_(Type::Object), object_value_(std::make_shared<Object>(std::move(value))) {}
 Value::Value(const Array& value)
-    : type_(Type::Array), array_value_(std::make_unique<Array>(value)) {}
+    : type_(Type::Array), array_value_(std::make_shared<Array>(value)) {}
 Value::Value(Array&& value)
-    : type_(Type::Array), array_value_(std::make_unique<Array>(std::move(value))) {}
+    : type_(Type::Array), array_value_(std::make_shared<Array>(std::move(value))) {}
 
 Value::Value(const Value& other) { copy_from(other); }
 Value::Value(Value&& other) noexcept { move_from(std::move(other)); }
@@ -440,12 +501,22 @@ void Value::copy_from(const Value& other) {
     bool_value_ = other.bool_value_;
     number_value_ = other.number_value_;
     string_value_ = other.string_value_;
-    if (other.object_value_) {
-        object_value_ = std::make_unique<Object>(*other.object_value_);
+    exclusive_ = false;
+    if (other.exclusive_) {
+        // 源对象交出过可变引用，之后经由该引用的修改不能出现在副本中：复制一层，子树仍按规则共享
+        object_value_ = other.object_value_ ? std::make_shared<Object>(*other.object_value_) : nullptr;
+        array_value_ = other.array_value_ ? std::make_shared<Array>(*other.array_value_) : nullptr;
+        shared_.store(false, std::memory_order_relaxed);
+        return;
     }
-    if (other.array_value_) {
-        array_value_ = std::make_unique<Array>(*other.array_value_);
+    // 共享子树，O(1)；两边都不再原地修改
+    object_value_ = other.object_value_;
+    array_value_ = other.array_value_;
+    const bool node = object_value_ != nullptr || array_value_ != nullptr;
+    if (node) {
+        other.shared_.store(true, std::memory_order_relaxed);
     }
+    shared_.store(node, std::memory_order_relaxed);
 }
 
 void Value::move_from(Value&& other) noexcept {
@@ -455,6 +526,10 @@ void Value::move_from(Value&& other) noexcept {
     string_value_ = std::move(other.string_value_);
     object_value_ = std::move(other.object_value_);
     array_value_ = std::move(other.array_value_);
+    shared_.store(other.shared_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    exclusive_ = other.exclusive_;
+    other.shared_.store(false, std::memory_order_relaxed);
+    other.exclusive_ = false;
     other.type_ = Type::Null;
     other.bool_value_ = false;
     other.number_value_ = 0.0;
@@ -468,6 +543,8 @@ void Value::reset() {
     string_value_.clear();
     object_value_.reset();
     array_value_.reset();
+    shared_.store(false, std::memory_order_relaxed);
+    exclusive_ = false;
 }
 
 bool Value::as_bool() const {
@@ -502,6 +579,11 @@ Value::Object& Value::as_object() {
     if (!is_object() || !object_value_) {
         throw ParseError("JSON value is not an object");
     }
+    if (shared_.load(std::memory_order_relaxed)) {
+        object_value_ = std::make_shared<Object>(*object_value_);
+        shared_.store(false, std::memory_order_relaxed);
+    }
+    exclusive_ = true;
     return *object_value_;
 }
 
@@ -516,9 +598,43 @@ Value::Array& Value::as_array() {
     if (!is_array() || !array_value_) {
         throw ParseError("JSON value is not an array");
     }
+    if (shared_.load(std::memory_order_relaxed)) {
+        array_value_ = std::make_shared<Array>(*array_value_);
+        shared_.store(false, std::memory_order_relaxed);
+    }
+    exclusive_ = true;
     return *array_value_;
 }
 
+const Value* Value::find(std::string_view key) const {
+    if (!is_object() || !object_value_) {
+        return nullptr;
+    }
+    auto iter = object_value_->find(key);
+    return iter == object_value_->end() ? nullptr : &iter->second;
+}
+
+std::string Value::take_string() {
+    if (!is_string()) {
+        throw ParseError("JSON value is not a string");
+    }
+    std::string result = std::move(string_value_);
+    reset();
+    return result;
+}
+
+Value::Object Value::take_object() {
+    Object result = std::move(as_object());
+    reset();
+    return result;
+}
+
+Value::Array Value::take_array() {
+    Array result = std::move(as_array());
+    reset();
+    return result;
+}
+
 std::string Value::dump() const {
     std::string result;
     dump_to(result);
@@ -579,25 +695,520 @@ Value Value::parse(const std::string& text) {
 }
 
 Value Value::parse(const char* data, std::size_t size) {
-    Parser parser(data, size);
+    return parse(data, size, ParseLimits{});
+}
+
+Value Value::parse(const char* data, std::size_t size, const ParseLimits& limits) {
+    const AllocationScope scope(AllocationTag::JsonParser);
+    Parser parser(data, size, limits);
     return parser.parse();
 }
 
-Value make_object(std::initializer_list<std::pair<const std::string, Value>> items) {
+Value make_object(std::initializer_list<Member> members) {
     Value::Object object;
-    for (auto& item : items) {
-        object.emplace(item.first, item.second);
+    for (const auto& member : members) {
+        object.emplace_hint(object.end(), std::string(member.key), std::move(member.value));
     }
     return Value(std::move(object));
 }
 
 Value make_array(std::initializer_list<Value> items) {
-    Value::Array array;
-    array.reserve(items.size());
-    for (const auto& item : items) {
-        array.push_back(item);
+    return Value(Value::Array(items));
+}
+
+
+struct PushParser::State {
+    enum class Mode : std::uint8_t {
+        Value,
+        ArrayFirst,
+        ObjectFirstKey,
+        ObjectKey,
+        Colon,
+        AfterValue,
+        String,
+        Number,
+        Literal,
+        Done,
+        Error
+    };
+    enum class Escape : std::uint8_t { None, Backslash, Hex, SurrogateBackslash, SurrogateU, LowHex };
+    enum class NumberPart : std::uint8_t {
+        Start,
+        Minus,
+        Zero,
+        Integer,
+        FractionStart,
+        Fraction,
+        ExponentStart,
+        ExponentSign,
+        Exponent
+    };
+
+    struct Frame {
+        bool is_object;
+        Value::Object object;
+        Value::Array array;
+        std::string key;
+    };
+
+    explicit State(const ParseLimits& parse_limits) : limits(parse_limits) {}
+
+    ParseLimits limits;
+    Mode mode = Mode::Value;
+    std::vector<Frame> stack;
+    Value result;
+    std::string text;  // 当前字符串或数字的内容
+    bool string_is_key = false;
+    Escape escape = Escape::None;
+    std::uint32_t hex = 0;
+    int hex_digits = 0;
+    std::uint32_t high_surrogate = 0;
+    NumberPart number = NumberPart::Start;
+    std::string_view literal;
+    std::size_t literal_pos = 0;
+    Value literal_value;
+    std::size_t total = 0;
+    std::size_t consumed = 0;
+    std::string error;
+
+    void fail(std::string message) {
+        mode = Mode::Error;
+        error = std::move(message);
+    }
+
+    void complete(Value value) {
+        if (stack.empty()) {
+            result = std::move(value);
+            mode = Mode::Done;
+            return;
+        }
+        Frame& top = stack.back();
+        if (top.is_object) {
+            top.object.try_emplace(std::move(top.key), std::move(value));
+        } else {
+            top.array.push_back(std::move(value));
+        }
+        mode = Mode::AfterValue;
+    }
+
+    void open(bool is_object) {
+        if (stack.size() >= limits.max_depth) {
+            fail("JSON nesting exceeds the maximum depth of " + std::to_string(limits.max_depth));
+            return;
+        }
+        stack.push_back(Frame{is_object, {}, {}, {}});
+        mode = is_object ? Mode::ObjectFirstKey : Mode::ArrayFirst;
+    }
+
+    void close() {
+        Frame& top = stack.back();
+        Value value = top.is_object ? Value(std::move(top.object)) : Value(std::move(top.array));
+        stack.pop_back();
+        complete(std::move(value));
+    }
+
+    void begin_string(bool is_key) {
+        text.clear();
+        string_is_key = is_key;
+        escape = Escape::None;
+        mode = Mode::String;
     }
-    return Value(std::move(array));
+
+    bool check_length(std::size_t length) {
+        if (length > limits.max_string_length) {
+            fail("JSON string exceeds the maximum length of " + std::to_string(limits.max_string_length) + " bytes");
+            return false;
+        }
+        return true;
+    }
+
+    void end_string() {
+        if (string_is_key) {
+            stack.back().key = std::move(text);
+            mode = Mode::Colon;
+        } else {
+            complete(Value(std::move(text)));
+        }
+    }
+
+    void escape_char(char ch) {
+        switch (escape) {
+            case Escape::Backslash: {
+                char decoded = 0;
+                switch (ch) {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        decoded = ch;
+                        break;
+                    case 'b':
+                        decoded = '\b';
+                        break;
+                    case 'f':
+                        decoded = '\f';
+                        break;
+                    case 'n':
+                        decoded = '\n';
+                        break;
+                    case 'r':
+                        decoded = '\r';
+                        break;
+                    case 't':
+                        decoded = '\t';
+                        break;
+                    case 'u':
+                        escape = Escape::Hex;
+                        hex = 0;
+                        hex_digits = 0;
+                        return;
+                    default:
+                        fail("Invalid escape sequence");
+                        return;
+                }
+                text.push_back(decoded);
+                escape = Escape::None;
+                check_length(text.size());
+                return;
+            }
+            case Escape::Hex:
+            case Escape::LowHex: {
+                const int digit = hex_digit(ch);
+                if (digit < 0) {
+                    fail("Invalid character in Unicode escape");
+                    return;
+                }
+                hex = (hex << 4) | static_cast<std::uint32_t>(digit);
+                if (++hex_digits < 4) {
+                    return;
+                }
+                std::uint32_t codepoint = hex;
+                if (escape == Escape::Hex && codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                    high_surrogate = codepoint;
+                    escape = Escape::SurrogateBackslash;
+                    return;
+                }
+                if (escape == Escape::LowHex) {
+                    if (codepoint < 0xDC00 || codepoint > 0xDFFF) {
+                        fail("Invalid Unicode surrogate pair");
+                        return;
+                    }
+                    codepoint = 0x10000 + ((high_surrogate - 0xD800) << 10) + (codepoint - 0xDC00);
+                }
+                append_utf8(codepoint, text);
+                escape = Escape::None;
+                check_length(text.size());
+                return;
+            }
+            case Escape::SurrogateBackslash:
+            case Escape::SurrogateU:
+                if (ch != (escape == Escape::SurrogateBackslash ? '\\' : 'u')) {
+                    fail("Invalid Unicode surrogate pair");
+                    return;
+                }
+                if (escape == Escape::SurrogateU) {
+                    escape = Escape::LowHex;
+                    hex = 0;
+                    hex_digits = 0;
+                } else {
+                    escape = Escape::SurrogateU;
+                }
+                return;
+            case Escape::None:
+                return;
+        }
+    }
+
+    // 字符属于当前数字时返回 true；数字在此结束时返回 false；语法错误时置 Error
+    bool number_char(char ch) {
+        const bool digit = ch >= '0' && ch <= '9';
+        switch (number) {
+            case NumberPart::Start:
+                number = ch == '-' ? NumberPart::Minus : ch == '0' ? NumberPart::Zero : NumberPart::Integer;
+                return true;
+            case NumberPart::Minus:
+                if (!digit) {
+                    fail("Invalid number format");
+                    return false;
+                }
+                number = ch == '0' ? NumberPart::Zero : NumberPart::Integer;
+                return true;
+            case NumberPart::Zero:
+            case NumberPart::Integer:
+                if (digit && number == NumberPart::Integer) {
+                    return true;
+                }
+                if (ch == '.') {
+                    number = NumberPart::FractionStart;
+                    return true;
+                }
+                if (ch == 'e' || ch == 'E') {
+                    number = NumberPart::ExponentStart;
+                    return true;
+                }
+                return false;
+            case NumberPart::FractionStart:
+            case NumberPart::ExponentSign:
+                if (!digit) {
+                    fail("Invalid number format");
+                    return false;
+                }
+                number = number == NumberPart::FractionStart ? NumberPart::Fraction : NumberPart::Exponent;
+                return true;
+            case NumberPart::Fraction:
+                if (digit) {
+                    return true;
+                }
+                if (ch == 'e' || ch == 'E') {
+                    number = NumberPart::ExponentStart;
+                    return true;
+                }
+                return false;
+            case NumberPart::ExponentStart:
+                if (ch == '+' || ch == '-') {
+                    number = NumberPart::ExponentSign;
+                    return true;
+                }
+                if (!digit) {
+                    fail("Invalid number format");
+                    return false;
+                }
+                number = NumberPart::Exponent;
+                return true;
+            case NumberPart::Exponent:
+                return digit;
+        }
+        return false;
+    }
+
+    void end_number() {
+        if (number != NumberPart::Zero && number != NumberPart::Integer && number != NumberPart::Fraction &&
+            number != NumberPart::Exponent) {
+            fail("Invalid number format");
+            return;
+        }
+        try {
+            complete(number_from_text(text));
+        } catch (const ParseError& error) {
+            fail(error.what());
+        }
+    }
+
+    void begin_literal(std::string_view word, Value value) {
+        literal = word;
+        literal_pos = 0;
+        literal_value = std::move(value);
+        mode = Mode::Literal;
+    }
+};
+
+PushParser::PushParser(const ParseLimits& limits) : state_(std::make_unique<State>(limits)) {}
+PushParser::PushParser(PushParser&& other) noexcept = default;
+PushParser& PushParser::operator=(PushParser&& other) noexcept = default;
+PushParser::~PushParser() = default;
+
+PushParser::Status PushParser::feed(const char* data, std::size_t size) {
+    const AllocationScope scope(AllocationTag::JsonParser);
+    using Mode = State::Mode;
+    State& st = *state_;
+    st.consumed = 0;
+    if (st.mode == Mode::Error) {
+        return Status::Error;
+    }
+    // 累计字节数超过 max_payload 之前停下，不为超限部分分配
+    const std::size_t allowance = st.limits.max_payload > st.total ? st.limits.max_payload - st.total : 0;
+    const std::size_t limit = std::min(size, allowance);
+    std::size_t i = 0;
+    while (i < limit && st.mode != Mode::Error) {
+        const char ch = data[i];
+        switch (st.mode) {
+            case Mode::Done:
+                if (!is_whitespace(ch)) {
+                    st.consumed = i;
+                    st.total += i;
+                    return Status::Done;
+                }
+                ++i;
+                break;
+            case Mode::Value:
+                if (is_whitespace(ch)) {
+                    ++i;
+                } else if (ch == '{' || ch == '[') {
+                    st.open(ch == '{');
+                    ++i;
+                } else if (ch == '"') {
+                    st.begin_string(false);
+                    ++i;
+                } else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+                    st.text.clear();
+                    st.number = State::NumberPart::Start;
+                    st.mode = Mode::Number;
+                } else if (ch == 't') {
+                    st.begin_literal("true", Value(true));
+                } else if (ch == 'f') {
+                    st.begin_literal("false", Value(false));
+                } else if (ch == 'n') {
+                    st.begin_literal("null", Value(nullptr));
+                } else {
+                    st.fail("Invalid JSON value");
+                }
+                break;
+            case Mode::ArrayFirst:
+                if (is_whitespace(ch)) {
+                    ++i;
+                } else if (ch == ']') {
+                    ++i;
+                    st.close();
+                } else {
+                    st.mode = Mode::Value;
+                }
+                break;
+            case Mode::ObjectFirstKey:
+            case Mode::ObjectKey:
+                if (is_whitespace(ch)) {
+                    ++i;
+                } else if (ch == '"') {
+                    st.begin_string(true);
+                    ++i;
+                } else if (ch == '}' && st.mode == Mode::ObjectFirstKey) {
+                    ++i;
+                    st.close();
+                } else {
+                    st.fail("Expected string key in object");
+                }
+                break;
+            case Mode::Colon:
+                if (is_whitespace(ch)) {
+                    ++i;
+                } else if (ch == ':') {
+                    ++i;
+                    st.mode = Mode::Value;
+                } else {
+                    st.fail("Expected ':' after object key");
+                }
+                break;
+            case Mode::AfterValue: {
+                if (is_whitespace(ch)) {
+                    ++i;
+                    break;
+                }
+                const bool is_object = st.stack.back().is_object;
+                if (ch == ',') {
+                    ++i;
+                    st.mode = is_object ? Mode::ObjectKey : Mode::Value;
+                } else if (ch == (is_object ? '}' : ']')) {
+                    ++i;
+                    st.close();
+                } else {
+                    st.fail(is_object ? "Expected comma in object" : "Expected comma in array");
+                }
+                break;
+            }
+            case Mode::String:
+                if (st.escape == State::Escape::None) {
+                    // 不含转义的片段整段追加
+                    const std::size_t start = i;
+                    while (i < limit && data[i] != '"' && data[i] != '\\') {
+                        ++i;
+                    }
+                    if (!st.check_length(st.text.size() + (i - start))) {
+                        break;
+                    }
+                    st.text.append(data + start, i - start);
+                    if (i < limit) {
+                        if (data[i++] == '"') {
+                            st.end_string();
+                        } else {
+                            st.escape = State::Escape::Backslash;
+                        }
+                    }
+                } else {
+                    st.escape_char(ch);
+                    ++i;
+                }
+                break;
+            case Mode::Number:
+                if (st.number_char(ch)) {
+                    st.text.push_back(ch);
+                    ++i;
+                } else if (st.mode != Mode::Error) {
+                    st.end_number();
+                }
+                break;
+            case Mode::Literal:
+                if (ch != st.literal[st.literal_pos]) {
+                    st.fail("Unexpected literal in JSON payload");
+                    break;
+                }
+                ++i;
+                if (++st.literal_pos == st.literal.size()) {
+                    st.complete(std::move(st.literal_value));
+                }
+                break;
+            case Mode::Error:
+                break;
+        }
+    }
+    st.consumed = i;
+    st.total += i;
+    if (st.mode == Mode::Error) {
+        return Status::Error;
+    }
+    if (i < size) {
+        st.fail("JSON payload exceeds the maximum size of " + std::to_string(st.limits.max_payload) + " bytes");
+        return Status::Error;
+    }
+    return st.mode == Mode::Done ? Status::Done : Status::NeedMore;
+}
+
+PushParser::Status PushParser::finish() {
+    const AllocationScope scope(AllocationTag::JsonParser);
+    using Mode = State::Mode;
+    State& st = *state_;
+    st.consumed = 0;
+    if (st.mode == Mode::Number && st.stack.empty()) {
+        st.end_number();
+    }
+    if (st.mode != Mode::Done && st.mode != Mode::Error) {
+        st.fail("Unexpected end of input");
+    }
+    return status();
+}
+
+PushParser::Status PushParser::status() const noexcept {
+    switch (state_->mode) {
+        case State::Mode::Done:
+            return Status::Done;
+        case State::Mode::Error:
+            return Status::Error;
+        default:
+            return Status::NeedMore;
+    }
+}
+
+std::size_t PushParser::consumed() const noexcept {
+    return state_->consumed;
+}
+
+const std::string& PushParser::error() const noexcept {
+    return state_->error;
+}
+
+Value PushParser::take_value() {
+    Value value = std::move(state_->result);
+    state_->result = Value();
+    return value;
+}
+
+void PushParser::reset() {
+    State& st = *state_;
+    st.mode = State::Mode::Value;
+    st.stack.clear();
+    st.result = Value();
+    st.text.clear();
+    st.escape = State::Escape::None;
+    st.total = 0;
+    st.consumed = 0;
+    st.error.clear();
 }
 
 }  // namespace mcp_sandtimer::json
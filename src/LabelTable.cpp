@@ -0,0 +1,171 @@
+#include "mcp_sandtimer/LabelTable.h"
+
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+namespace mcp_sandtimer {
+
+namespace {
+constexpr std::size_t kInitialSlots = 1024;
+
+std::uint64_t SlotValue(std::size_t hash, LabelTable::Id id) noexcept {
+    return (static_cast<std::uint64_t>(hash) & 0xFFFFFFFF00000000ull) | id;
+}
+}  // namespace
+
+LabelTable::Index::Index(std::size_t size) : mask(size - 1), slots(new std::atomic<std::uint64_t>[size]) {
+    for (std::size_t i = 0; i < size; ++i) {
+        slots[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+LabelTable& LabelTable::global() {
+    static LabelTable table;
+    return table;
+}
+
+LabelTable::LabelTable() : segments_(new std::atomic<Entry*>[kMaxLabels / kSegmentSize]) {
+    for (std::size_t i = 0; i < kMaxLabels / kSegmentSize; ++i) {
+        segments_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    // ID 0 是空 label，不进索引
+    owned_segments_.emplace_back(new Entry[kSegmentSize]);
+    segments_[0].store(owned_segments_.back().get(), std::memory_order_release);
+    indexes_.push_back(std::make_unique<Index>(kInitialSlots));
+    index_.store(indexes_.back().get(), std::memory_order_release);
+}
+
+LabelTable::~LabelTable() = default;
+
+LabelTable::Id LabelTable::intern(std::string_view label) {
+    if (label.empty()) {
+        return 0;
+    }
+    const std::size_t hash = std::hash<std::string_view>{}(label);
+    Id id = 0;
+    if (find(label, hash, id)) {
+        return id;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 加锁前可能有别的线程插入了同一个 label
+    if (find(label, hash, id)) {
+        return id;
+    }
+    if (count_ + 1 >= kMaxLabels || label.size() > kMaxBytes - bytes_) {
+        throw std::length_error("Label table is full");
+    }
+    id = static_cast<Id>(count_ + 1);
+    const std::size_t segment = id >> kSegmentBits;
+    Entry* entries = segments_[segment].load(std::memory_order_relaxed);
+    if (entries == nullptr) {
+        owned_segments_.emplace_back(new Entry[kSegmentSize]);
+        entries = owned_segments_.back().get();
+        segments_[segment].store(entries, std::memory_order_release);
+    }
+    entries[id & (kSegmentSize - 1)] = Entry{std::string_view(store_locked(label), label.size()), hash};
+
+    // 装载因子超过 1/2 时扩容：新索引填好后再发布，旧索引继续供读者使用
+    Index* index = index_.load(std::memory_order_relaxed);
+    if ((count_ + 1) * 2 > index->mask + 1) {
+        auto grown = std::make_unique<Index>((index->mask + 1) * 2);
+        for (Id existing = 1; existing <= count_; ++existing) {
+            const Entry& entry = segments_[existing >> kSegmentBits].load(std::memory_order_relaxed)
+                                     [existing & (kSegmentSize - 1)];
+            insert_locked(*grown, existing, entry.hash);
+        }
+        index = grown.get();
+        indexes_.push_back(std::move(grown));
+    }
+    insert_locked(*index, id, hash);
+    index_.store(index, std::memory_order_release);
+    ++count_;
+    bytes_ += label.size();
+    return id;
+}
+
+bool LabelTable::find(std::string_view label, Id& id) const noexcept {
+    if (label.empty()) {
+        id = 0;
+        return true;
+    }
+    return find(label, std::hash<std::string_view>{}(label), id);
+}
+
+bool LabelTable::find(std::string_view label, std::size_t hash, Id& id) const noexcept {
+    const Index* index = index_.load(std::memory_order_acquire);
+    const std::uint64_t tag = SlotValue(hash, 0);
+    for (std::size_t slot = hash & index->mask;; slot = (slot + 1) & index->mask) {
+        const std::uint64_t value = index->slots[slot].load(std::memory_order_acquire);
+        if (value == 0) {
+            return false;
+        }
+        if ((value & 0xFFFFFFFF00000000ull) != tag) {
+            continue;
+        }
+        const Id candidate = static_cast<Id>(value);
+        if (view(candidate) == label) {
+            id = candidate;
+            return true;
+        }
+    }
+}
+
+std::string_view LabelTable::view(Id id) const noexcept {
+    if (id >= kMaxLabels) {
+        return {};
+    }
+    const Entry* entries = segments_[id >> kSegmentBits].load(std::memory_order_acquire);
+    return entries == nullptr ? std::string_view{} : entries[id & (kSegmentSize - 1)].text;
+}
+
+LabelTable::Stats LabelTable::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.labels = count_;
+    stats.bytes = bytes_;
+    stats.slots = index_.load(std::memory_order_relaxed)->mask + 1;
+    return stats;
+}
+
+const char* LabelTable::store_locked(std::string_view label) {
+    // 较长的 label 单独分配，避免浪费 arena 块的剩余空间
+    if (label.size() > kArenaChunk / 4) {
+        arena_.emplace_back(new char[label.size()]);
+        std::memcpy(arena_.back().get(), label.data(), label.size());
+        return arena_.back().get();
+    }
+    if (chunk_ == nullptr || chunk_used_ + label.size() > kArenaChunk) {
+        arena_.emplace_back(new char[kArenaChunk]);
+        chunk_ = arena_.back().get();
+        chunk_used_ = 0;
+    }
+    char* text = chunk_ + chunk_used_;
+    std::memcpy(text, label.data(), label.size());
+    chunk_used_ += label.size();
+    return text;
+}
+
+void LabelTable::insert_locked(Index& index, Id id, std::size_t hash) noexcept {
+    std::size_t slot = hash & index.mask;
+    while (index.slots[slot].load(std::memory_order_relaxed) != 0) {
+        slot = (slot + 1) & index.mask;
+    }
+    // 条目先于槽位写好，读者 acquire 到槽位后必然看到完整的条目
+    index.slots[slot].store(SlotValue(hash, id), std::memory_order_release);
+}
+
+json::Value LabelTable::Stats::ToJson() const {
+    return json::make_object({
+        {"labels", json::Value(static_cast<double>(labels))},
+        {"bytes", json::Value(static_cast<double>(bytes))},
+        {"slots", json::Value(static_cast<double>(slots))}
+    });
+}
+
+std::ostream& operator<<(std::ostream& out, Label label) {
+    return out << label.view();
+}
+
+}  // namespace mcp_sandtimer
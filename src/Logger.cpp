@@ -0,0 +1,350 @@
+#include "mcp_sandtimer/Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+namespace mcp_sandtimer {
+namespace {
+
+constexpr std::int64_t kRateWindowUs = 1000000;
+constexpr auto kDrainInterval = std::chrono::milliseconds(50);
+
+std::int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::size_t hash_event(const char* event) noexcept {
+    std::uint64_t hash = 1469598103934665603ull;
+    for (const char* ch = event; *ch != '\0'; ++ch) {
+        hash ^= static_cast<unsigned char>(*ch);
+        hash *= 1099511628211ull;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+// ISO 8601 UTC，毫秒精度
+void append_timestamp(std::string& out, std::int64_t timestamp_us) {
+    const std::time_t seconds = static_cast<std::time_t>(timestamp_us / 1000000);
+    std::tm parts{};
+#ifdef _WIN32
+    gmtime_s(&parts, &seconds);
+#else
+    gmtime_r(&seconds, &parts);
+#endif
+    char buffer[32];
+    const std::size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &parts);
+    out.append(buffer, length);
+    const int millis = static_cast<int>((timestamp_us / 1000) % 1000);
+    std::snprintf(buffer, sizeof(buffer), ".%03dZ", millis);
+    out += buffer;
+}
+
+void append_json_string(std::string& out, std::string_view text) {
+    out += json::Value(text).dump();
+}
+
+}  // namespace
+
+const char* to_string(LogLevel level) noexcept {
+    switch (level) {
+        case LogLevel::Debug:
+            return "debug";
+        case LogLevel::Info:
+            return "info";
+        case LogLevel::Warn:
+            return "warn";
+        case LogLevel::Error:
+            return "error";
+        case LogLevel::Off:
+            return "off";
+    }
+    return "unknown";
+}
+
+LogLevel ParseLogLevel(const std::string& text) {
+    for (LogLevel level : {LogLevel::Debug, LogLevel::Info, LogLevel::Warn, LogLevel::Error, LogLevel::Off}) {
+        if (text == to_string(level)) {
+            return level;
+        }
+    }
+    throw std::invalid_argument("Unknown log level: " + text);
+}
+
+json::Value Logger::Stats::ToJson() const {
+    return json::make_object({
+        {"written", json::Value(static_cast<double>(written))},
+        {"dropped", json::Value(static_cast<double>(dropped))},
+        {"suppressed", json::Value(static_cast<double>(suppressed))}
+    });
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : slots_(new Slot[kCapacity]) {
+    for (std::size_t i = 0; i < kCapacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    drain_thread_ = std::thread([this] { run(); });
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (drain_thread_.joinable()) {
+        drain_thread_.join();
+    }
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+void Logger::configure(const Options& options) {
+    std::FILE* file = nullptr;
+    if (!options.file_path.empty()) {
+        file = std::fopen(options.file_path.c_str(), "a");
+        if (file == nullptr) {
+            throw std::runtime_error("Unable to open log file: " + options.file_path);
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+    file_ = file;
+    write_stderr_ = options.write_stderr;
+    level_.store(options.level, std::memory_order_relaxed);
+    rate_limit_.store(options.rate_limit_per_second, std::memory_order_relaxed);
+}
+
+void Logger::log(LogLevel level, const char* event, std::string_view message, std::string_view detail) {
+    if (!enabled(level) || level == LogLevel::Off) {
+        return;
+    }
+    const std::int64_t now = now_us();
+    if (!admit(event, now)) {
+        return;
+    }
+    std::size_t position = 0;
+    if (!push(level, event, now, message, detail, &position)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // 平时由后台线程按固定间隔取走；错误或突发写满四分之一缓冲区时立即唤醒
+    if (level == LogLevel::Error || (position & (kCapacity / 4 - 1)) == kCapacity / 4 - 1) {
+        wake_.notify_one();
+    }
+}
+
+// 每个事件在 1 秒窗口内最多放行 rate_limit 条，其余只计数，由后台线程汇总输出
+bool Logger::admit(const char* event, std::int64_t now) {
+    const std::uint32_t limit = rate_limit_.load(std::memory_order_relaxed);
+    if (limit == 0) {
+        return true;
+    }
+    RateBucket* slot = bucket_for(event);
+    if (slot == nullptr) {
+        return true;
+    }
+    RateBucket& bucket = *slot;
+    std::int64_t start = bucket.window_start_us.load(std::memory_order_relaxed);
+    if (now - start >= kRateWindowUs &&
+        bucket.window_start_us.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        bucket.count.store(0, std::memory_order_relaxed);
+    }
+    if (bucket.count.fetch_add(1, std::memory_order_relaxed) < limit) {
+        return true;
+    }
+    bucket.suppressed.fetch_add(1, std::memory_order_relaxed);
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+// 哈希冲突的事件各用各的桶，汇总记录里的事件名也不会被别的事件覆盖。
+// event 是静态字符串，桶一经占用不再释放；桶用尽时新事件不限流
+Logger::RateBucket* Logger::bucket_for(const char* event) noexcept {
+    const std::size_t home = hash_event(event) % kRateBuckets;
+    for (std::size_t i = 0; i < kRateBuckets; ++i) {
+        RateBucket& bucket = buckets_[(home + i) % kRateBuckets];
+        const char* owner = bucket.event.load(std::memory_order_acquire);
+        // CAS 失败时 owner 变为抢先占用者，接着比较
+        if (owner == nullptr && bucket.event.compare_exchange_strong(owner, event, std::memory_order_acq_rel)) {
+            return &bucket;
+        }
+        // 不同编译单元里相同内容的字面量地址可能不同
+        if (owner == event || std::strcmp(owner, event) == 0) {
+            return &bucket;
+        }
+    }
+    return nullptr;
+}
+
+// 有界 MPMC 队列（每个槽位带序号）：生产者只做一次 CAS 和一次拷贝
+bool Logger::push(LogLevel level, const char* event, std::int64_t now, std::string_view message, std::string_view detail,
+                  std::size_t* position_out) {
+    std::size_t position = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &slots_[position & (kCapacity - 1)];
+        const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            position = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    const std::size_t message_length = std::min(message.size(), kMaxTextLength);
+    const std::size_t detail_length = std::min(detail.size(), kMaxTextLength - message_length);
+    slot->level = level;
+    slot->timestamp_us = now;
+    slot->event = event;
+    slot->message_length = static_cast<std::uint16_t>(message_length);
+    slot->detail_length = static_cast<std::uint16_t>(detail_length);
+    std::memcpy(slot->text, message.data(), message_length);
+    std::memcpy(slot->text + message_length, detail.data(), detail_length);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    if (position_out != nullptr) {
+        *position_out = position;
+    }
+    return true;
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const std::uint64_t target = ++flush_requests_;
+    wake_.notify_one();
+    drained_.wait(lock, [&] { return flushes_done_ >= target || stopping_; });
+}
+
+Logger::Stats Logger::stats() const {
+    Stats stats;
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.suppressed = suppressed_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Logger::run() {
+    std::string text;
+    std::string jsonl;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait_for(lock, kDrainInterval, [this] { return stopping_ || flush_requests_ != flushes_done_; });
+        const bool stopping = stopping_;
+        const std::uint64_t requests = flush_requests_;
+        const bool force = stopping || requests != flushes_done_;
+
+        collect_suppressed(now_us(), force);
+        while (drain_into(text, jsonl) > 0) {
+            write_out(text, jsonl);
+            text.clear();
+            jsonl.clear();
+        }
+        if (flushes_done_ != requests) {
+            flushes_done_ = requests;
+            drained_.notify_all();
+        }
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+// 取出所有已发布的记录并格式化；每次最多一个缓冲区容量，避免单批过大
+std::size_t Logger::drain_into(std::string& text, std::string& jsonl) {
+    std::size_t count = 0;
+    while (count < kCapacity) {
+        Slot& slot = slots_[dequeue_pos_ & (kCapacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+            break;
+        }
+        const std::string_view message(slot.text, slot.message_length);
+        const std::string_view detail(slot.text + slot.message_length, slot.detail_length);
+
+        if (write_stderr_) {
+            text += '[';
+            text += to_string(slot.level);
+            text += "] ";
+            text += slot.event;
+            text += ": ";
+            text.append(message.data(), message.size());
+            if (!detail.empty()) {
+                text += " (";
+                text.append(detail.data(), detail.size());
+                text += ')';
+            }
+            text += '\n';
+        }
+        if (file_ != nullptr) {
+            jsonl += "{\"time\":\"";
+            append_timestamp(jsonl, slot.timestamp_us);
+            jsonl += "\",\"level\":\"";
+            jsonl += to_string(slot.level);
+            jsonl += "\",\"event\":";
+            append_json_string(jsonl, slot.event);
+            jsonl += ",\"message\":";
+            append_json_string(jsonl, message);
+            if (!detail.empty()) {
+                jsonl += ",\"detail\":";
+                append_json_string(jsonl, detail);
+            }
+            jsonl += "}\n";
+        }
+
+        slot.sequence.store(dequeue_pos_ + kCapacity, std::memory_order_release);
+        ++dequeue_pos_;
+        ++count;
+    }
+    written_.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+// 窗口结束（或强制刷新）时为被限流的事件补一条汇总记录
+void Logger::collect_suppressed(std::int64_t now, bool force) {
+    for (RateBucket& bucket : buckets_) {
+        if (bucket.suppressed.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        if (!force && now - bucket.window_start_us.load(std::memory_order_relaxed) < kRateWindowUs) {
+            continue;
+        }
+        const std::uint32_t count = bucket.suppressed.exchange(0, std::memory_order_relaxed);
+        const char* event = bucket.event.load(std::memory_order_relaxed);
+        if (count == 0 || event == nullptr) {
+            continue;
+        }
+        const std::string message = "Suppressed " + std::to_string(count) + " repeated messages";
+        if (!push(LogLevel::Warn, event, now, message, {})) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::write_out(const std::string& text, const std::string& jsonl) {
+    if (!text.empty()) {
+        std::fwrite(text.data(), 1, text.size(), stderr);
+        std::fflush(stderr);
+    }
+    if (!jsonl.empty() && file_ != nullptr) {
+        std::fwrite(jsonl.data(), 1, jsonl.size(), file_);
+        std::fflush(file_);
+    }
+}
+
+}  // namespace mcp_sandtimer
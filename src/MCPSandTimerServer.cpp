@@ -2,11 +2,16 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <limits>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 
+#include "mcp_sandtimer/AllocationTracker.h"
+#include "mcp_sandtimer/Logger.h"
 #include "mcp_sandtimer/ToolDefinition.h"
 #include "mcp_sandtimer/Version.h"
 // MCP 协议服务端核心实现，从MCP客户端（Cursor）读取 JSON-RPC消息，并进行处理
@@ -14,9 +19,10 @@
 namespace mcp_sandtimer {
 namespace {
 constexpr const char* kProtocolVersion = "0.1";
+constexpr std::size_t kMaxHeaderLine = 8192;
 
-// 去除字符串前后空白字符
-std::string Trim(const std::string& value) {
+// 去除字符串前后空白字符，返回原字符串上的视图
+std::string_view Trim(std::string_view value) {
     std::size_t start = 0;
     while (start < value.size() && std::isspace(static_cast<unsigned char>(value[start]))) {
         ++start;
@@ -36,57 +42,457 @@ std::string ToLower(std::string text) {
     return text;
 }
 
+// 与 std::getline 语义相同，但一行超过 kMaxHeaderLine 时丢弃该行剩余部分并报错，
+// 不会为畸形头部无限增长缓冲区
+bool ReadHeaderLine(std::istream& input, std::string& line) {
+    line.clear();
+    std::streambuf* buffer = input.rdbuf();
+    for (;;) {
+        const auto ch = buffer->sbumpc();
+        if (ch == std::char_traits<char>::eof()) {
+            input.setstate(line.empty() ? std::ios::eofbit | std::ios::failbit : std::ios::eofbit);
+            return !line.empty();
+        }
+        if (ch == '\n') {
+            return true;
+        }
+        if (line.size() >= kMaxHeaderLine) {
+            input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            throw JSONRPCError(-32600, "Header line too long");
+        }
+        line.push_back(static_cast<char>(ch));
+    }
+}
+
+// 取出流中当前可用的字节：阻塞等待第一个字节，其余只拿已缓冲的部分，
+// 不会为了凑满 capacity 而等待后续消息。返回 0 表示流结束
+std::size_t ReadAvailable(std::istream& input, char* data, std::size_t capacity) {
+    std::streambuf* buffer = input.rdbuf();
+    const auto first = buffer->sbumpc();
+    if (first == std::char_traits<char>::eof()) {
+        input.setstate(std::ios::eofbit);
+        return 0;
+    }
+    data[0] = static_cast<char>(first);
+    std::size_t count = 1;
+    const std::streamsize available = buffer->in_avail();
+    if (available > 0) {
+        count += static_cast<std::size_t>(
+            buffer->sgetn(data + 1, std::min<std::streamsize>(available, static_cast<std::streamsize>(capacity - 1))));
+    }
+    return count;
+}
+
+// 缺省的 params / arguments，借用而不是每次构造
+const json::Value& EmptyObject() {
+    static const json::Value empty(json::Value::Object{});
+    return empty;
+}
+
+constexpr std::string_view kTimerUriPrefix = "timer://";
+
+// 计时器资源的 URI：timer://<百分号编码的 label>
+std::string TimerUri(std::string_view label) {
+    static const char kHex[] = "0123456789ABCDEF";
+    std::string uri(kTimerUriPrefix);
+    for (unsigned char ch : label) {
+        if (std::isalnum(ch) || ch == '-' || ch == '_' || ch == '.' || ch == '~') {
+            uri.push_back(static_cast<char>(ch));
+        } else {
+            uri.push_back('%');
+            uri.push_back(kHex[ch >> 4]);
+            uri.push_back(kHex[ch & 0x0F]);
+        }
+    }
+    return uri;
+}
+
+std::optional<std::string> LabelFromUri(std::string_view uri) {
+    if (uri.substr(0, kTimerUriPrefix.size()) != kTimerUriPrefix) {
+        return std::nullopt;
+    }
+    auto hex = [](char ch) {
+        return ch >= '0' && ch <= '9' ? ch - '0' : ch >= 'A' && ch <= 'F' ? ch - 'A' + 10 : ch >= 'a' && ch <= 'f' ? ch - 'a' + 10 : -1;
+    };
+    std::string label;
+    for (std::size_t i = kTimerUriPrefix.size(); i < uri.size(); ++i) {
+        if (uri[i] != '%') {
+            label.push_back(uri[i]);
+            continue;
+        }
+        if (i + 2 >= uri.size() || hex(uri[i + 1]) < 0 || hex(uri[i + 2]) < 0) {
+            return std::nullopt;
+        }
+        label.push_back(static_cast<char>(hex(uri[i + 1]) * 16 + hex(uri[i + 2])));
+        i += 2;
+    }
+    return label;
+}
+
+constexpr std::string_view kSupersededSuffix = "' was superseded by a later command before it was sent.";
+
+// 幂等缓存的 key：只认客户端显式给出的 _meta.idempotencyKey。
+// 不按参数匹配：start X → cancel X → start X 中的第二次 start 是新命令，不能拿第一次的结果应付
+std::optional<std::string> IdempotencyKey(const json::Value& params, std::string_view tool) {
+    const json::Value* meta = params.find("_meta");
+    const json::Value* key = meta != nullptr && meta->is_object() ? meta->find("idempotencyKey") : nullptr;
+    if (key == nullptr || !key->is_string()) {
+        return std::nullopt;
+    }
+    std::string result(tool);
+    result.push_back('\n');
+    result.append(key->as_string_view());
+    return result;
+}
+
+// prefix + label + suffix，一次分配
+std::string TimerMessage(std::string_view prefix, Label label, std::string_view suffix) {
+    const std::string_view text = label.view();
+    std::string message;
+    message.reserve(prefix.size() + text.size() + suffix.size());
+    message.append(prefix).append(text).append(suffix);
+    return message;
+}
+
+// 当前线程正在执行的请求的截止时间与取消信号，由 Forward 传给 TimerClient
+thread_local CallOptions current_call;
+
+class CallScope {
+public:
+    explicit CallScope(const CallOptions& options) : previous_(current_call) { current_call = options; }
+    ~CallScope() { current_call = previous_; }
+    CallScope(const CallScope&) = delete;
+    CallScope& operator=(const CallScope&) = delete;
+
+private:
+    CallOptions previous_;
+};
+
 }  // namespace
 
+struct MCPSandTimerServer::InFlightRequest {
+    std::string key;  // id 的 JSON 文本
+    CancellationToken token;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+};
+
+const char* to_string(MessageFraming framing) noexcept {
+    switch (framing) {
+        case MessageFraming::Auto:
+            return "auto";
+        case MessageFraming::ContentLength:
+            return "content-length";
+        case MessageFraming::Ndjson:
+            return "ndjson";
+    }
+    return "unknown";
+}
+
+MessageFraming ParseMessageFraming(const std::string& text) {
+    for (MessageFraming framing : {MessageFraming::Auto, MessageFraming::ContentLength, MessageFraming::Ndjson}) {
+        if (text == to_string(framing)) {
+            return framing;
+        }
+    }
+    throw std::invalid_argument("Unknown message framing: " + text);
+}
+
 JSONRPCError::JSONRPCError(int code, std::string message, std::optional<json::Value> data)
     : std::runtime_error(message), code_(code), message_(std::move(message)), data_(std::move(data)) {}
 
 MCPSandTimerServer::MCPSandTimerServer(TimerClient client, std::istream& input, std::ostream& output)
-    : timer_client_(std::move(client)), input_(input), output_(output) {}
+    : timer_client_(std::move(client)),
+      input_(input),
+      output_(output),
+      timer_engine_([this](const TimerEngine::Timer& timer) { OnTimerExpired(timer); }) {
+    RegisterBuiltins();
+}
+
+MCPSandTimerServer::~MCPSandTimerServer() {
+    StopWorkers();
+    timer_engine_.stop();
+}
+
+// 注册内置的 JSON-RPC 方法与 sandtimer 工具
+void MCPSandTimerServer::RegisterBuiltins() {
+    registry_.register_method("initialize", [this](const json::Value& params) { return HandleInitialize(params); });
+    // 在读取线程上执行（见 Submit），Serve() 随即停止读取
+    registry_.register_method("shutdown", [this](const json::Value&) {
+        shutdown_requested_ = true;
+        return json::Value(nullptr);
+    });
+    registry_.register_method("tools/list", [this](const json::Value&) { return registry_.tool_list(); });
+    registry_.register_method("tools/call", [this](const json::Value& params) { return HandleToolCall(params); });
+    registry_.register_method("ping", [](const json::Value&) {
+        return json::make_object({{"message", json::Value("pong")}});
+    });
+    registry_.register_method("sandtimer/metrics", [this](const json::Value&) { return HandleMetrics(); });
+    registry_.register_method("resources/list", [this](const json::Value&) { return HandleResourceList(); });
+    registry_.register_method("resources/read", [this](const json::Value& params) { return HandleResourceRead(params); });
+    registry_.register_method("resources/subscribe", [this](const json::Value& params) {
+        return HandleSubscribe(params, true);
+    });
+    registry_.register_method("resources/unsubscribe", [this](const json::Value& params) {
+        return HandleSubscribe(params, false);
+    });
+
+    using ToolMethod = std::string (MCPSandTimerServer::*)(const json::Value&);
+    const std::pair<const char*, ToolMethod> builtin_tools[] = {
+        {"start_timer", &MCPSandTimerServer::HandleStart},
+        {"reset_timer", &MCPSandTimerServer::HandleReset},
+        {"cancel_timer", &MCPSandTimerServer::HandleCancel},
+    };
+    for (const auto& [name, method] : builtin_tools) {
+        const ToolDefinition* definition = FindToolDefinition(name);
+        registry_.register_tool(*definition, [this, method = method](const json::Value& arguments) {
+            return (this->*method)(arguments);
+        });
+    }
+}
+
+void MCPSandTimerServer::EnableSpool(std::shared_ptr<CommandSpool> spool) {
+    spool_ = std::move(spool);
+}
+
+void MCPSandTimerServer::EnableCoalescing(std::shared_ptr<CommandCoalescer> coalescer) {
+    coalescer_ = std::move(coalescer);
+}
+
+void MCPSandTimerServer::EnableIdempotency(std::shared_ptr<IdempotencyCache> cache) {
+    idempotency_ = std::move(cache);
+}
 
 // 不断从 stdin 读取 JSON-RPC 消息，调度执行并返回响应
 void MCPSandTimerServer::Serve() {
     while (!shutdown_requested_) {
         std::optional<json::Value> message;
+        const std::uint64_t allocations_before = AllocationTracker::thread_allocations();
         try {
             message = ReadMessage();
         } catch (const JSONRPCError& error) {
-            std::cerr << "Failed to read JSON-RPC message: " << error.what() << std::endl;
+            Logger::instance().warn("rpc.read_failed", "Failed to read JSON-RPC message", error.what());
             continue;
         }
 
         if (!message.has_value()) {
             break;
         }
+        Submit(std::move(*message), AllocationTracker::thread_allocations() - allocations_before);
+    }
+    StopWorkers();
+}
+
+// 请求交给工作线程执行，读取线程继续接收取消通知；通知（没有 id）直接在读取线程上处理。
+// tools/call 登记截止时间与取消信号，等待执行的时间也计入截止时间
+void MCPSandTimerServer::Submit(json::Value message, std::uint64_t read_allocations) {
+    const bool notification = !message.is_object() || message.find("id") == nullptr;
+    if (notification) {
+        ProcessCounted(message, read_allocations);
+        return;
+    }
+    // shutdown 等之前的请求全部执行完，再在读取线程上回复
+    const json::Value* method = message.find("method");
+    if (method != nullptr && method->is_string() && method->as_string_view() == "shutdown") {
+        StopWorkers();
+        ProcessCounted(message, read_allocations);
+        return;
+    }
+    std::shared_ptr<InFlightRequest> request = BeginRequest(message);
+    if (worker_count_ == 0) {
+        if (request) {
+            const CallScope scope(CallOptions{request->deadline, &request->token});
+            ProcessCounted(message, read_allocations);
+            EndRequest(request);
+        } else {
+            ProcessCounted(message, read_allocations);
+        }
+        return;
+    }
+    if (!request) {
+        RunOnWorker(message, [this, message, read_allocations] { ProcessCounted(message, read_allocations); });
+        return;
+    }
+    RunOnWorker(message, [this, request, message, read_allocations] {
+        const CallScope scope(CallOptions{request->deadline, &request->token});
+        ProcessCounted(message, read_allocations);
+        EndRequest(request);
+    });
+}
 
+// 执行一条消息；失败时按 id 回复错误
+void MCPSandTimerServer::Process(const json::Value& message) {
+    try {
+        Dispatch(message);
+    } catch (const JSONRPCError& error) {
         try {
-            Dispatch(*message);
-        } catch (const JSONRPCError& error) {
-            try {
-                const auto& object = message->as_object();
-                auto id_iter = object.find("id");
-                if (id_iter != object.end()) {
-                    SendError(id_iter->second, error);
-                }
-            } catch (const json::ParseError&) {
-                std::cerr << "Unable to send error response: invalid JSON message." << std::endl;
+            const auto& object = message.as_object();
+            auto id_iter = object.find("id");
+            if (id_iter != object.end()) {
+                SendError(id_iter->second, error);
             }
-        } catch (const std::exception& ex) {
-            try {
-                const auto& object = message->as_object();
-                auto id_iter = object.find("id");
-                if (id_iter != object.end()) {
-                    JSONRPCError internal_error(
-                        -32603,
-                        "Internal error",
-                        json::make_object({{"message", json::Value("An unexpected error occurred.")}}));
-                    SendError(id_iter->second, internal_error);
-                }
-            } catch (const std::exception&) {
-                std::cerr << "Failed to send internal error response: " << ex.what() << std::endl;
+        } catch (const json::ParseError&) {
+            Logger::instance().error("rpc.error_response_failed", "Unable to send error response: invalid JSON message");
+        }
+    } catch (const std::exception& ex) {
+        try {
+            const auto& object = message.as_object();
+            auto id_iter = object.find("id");
+            if (id_iter != object.end()) {
+                JSONRPCError internal_error(
+                    -32603,
+                    "Internal error",
+                    json::make_object({{"message", json::Value("An unexpected error occurred.")}}));
+                SendError(id_iter->second, internal_error);
             }
+        } catch (const std::exception&) {
+            Logger::instance().error("rpc.error_response_failed", "Failed to send internal error response", ex.what());
+        }
+    }
+}
+
+// 线程计数只覆盖当前线程：TimerClient 的 I/O 线程等后台线程上的分配不计入单条消息
+void MCPSandTimerServer::ProcessCounted(const json::Value& message, std::uint64_t read_allocations) {
+    const std::uint64_t before = AllocationTracker::thread_allocations();
+    Process(message);
+    const std::uint64_t allocations = read_allocations + AllocationTracker::thread_allocations() - before;
+    counted_messages_.fetch_add(1, std::memory_order_relaxed);
+    message_allocations_.fetch_add(allocations, std::memory_order_relaxed);
+    std::uint64_t max = max_message_allocations_.load(std::memory_order_relaxed);
+    while (allocations > max &&
+           !max_message_allocations_.compare_exchange_weak(max, allocations, std::memory_order_relaxed)) {
+    }
+}
+
+// 只有带 id 的 tools/call 需要登记；截止时间取服务端默认值与客户端 _meta.timeoutMs 中较早者
+std::shared_ptr<MCPSandTimerServer::InFlightRequest> MCPSandTimerServer::BeginRequest(const json::Value& message) {
+    const json::Value* method = message.is_object() ? message.find("method") : nullptr;
+    const json::Value* id = message.is_object() ? message.find("id") : nullptr;
+    if (id == nullptr || method == nullptr || !method->is_string() || method->as_string_view() != "tools/call") {
+        return nullptr;
+    }
+    std::chrono::milliseconds timeout = request_timeout_;
+    const json::Value* params = message.find("params");
+    const json::Value* meta = params != nullptr && params->is_object() ? params->find("_meta") : nullptr;
+    const json::Value* client_timeout = meta != nullptr && meta->is_object() ? meta->find("timeoutMs") : nullptr;
+    if (client_timeout != nullptr && client_timeout->is_number() && client_timeout->as_number() > 0) {
+        const auto requested = std::chrono::milliseconds(static_cast<std::int64_t>(client_timeout->as_number()));
+        timeout = timeout.count() > 0 ? std::min(timeout, requested) : requested;
+    }
+
+    auto request = std::make_shared<InFlightRequest>();
+    request->key = id->dump();
+    if (timeout.count() > 0) {
+        request->deadline = std::chrono::steady_clock::now() + timeout;
+    }
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    in_flight_[request->key] = request;
+    return request;
+}
+
+void MCPSandTimerServer::EndRequest(const std::shared_ptr<InFlightRequest>& request) {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    auto iter = in_flight_.find(request->key);
+    if (iter != in_flight_.end() && iter->second == request) {
+        in_flight_.erase(iter);
+    }
+}
+
+namespace {
+
+// 屏障任务：所有队列都执行到它时，由最后到达的线程执行请求，其余线程等它完成
+struct LaneBarrier {
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    std::size_t remaining = 0;
+    bool done = false;
+};
+
+// 带 label 的 tools/call 所属的 label（与 ExtractLabel 一样去掉首尾空白）；其余请求返回空
+std::optional<std::string_view> RoutingLabel(const json::Value& message) {
+    const json::Value* method = message.find("method");
+    if (method == nullptr || !method->is_string() || method->as_string_view() != "tools/call") {
+        return std::nullopt;
+    }
+    const json::Value* params = message.find("params");
+    const json::Value* arguments = params != nullptr && params->is_object() ? params->find("arguments") : nullptr;
+    const json::Value* label = arguments != nullptr && arguments->is_object() ? arguments->find("label") : nullptr;
+    if (label == nullptr || !label->is_string()) {
+        return std::nullopt;
+    }
+    return Trim(label->as_string_view());
+}
+
+}  // namespace
+
+// 同一 label 的 tools/call 总是进入同一队列，保证发往 sandtimer 的顺序与到达顺序一致；
+// 其余请求作为屏障进入所有队列，不会越过之前的请求，也不会被之后的请求越过
+void MCPSandTimerServer::RunOnWorker(const json::Value& message, std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    if (lanes_.empty()) {
+        for (std::size_t i = 0; i < worker_count_; ++i) {
+            lanes_.push_back(std::make_unique<WorkerLane>());
+        }
+        for (auto& lane : lanes_) {
+            lane->thread = std::thread([this, &lane = *lane] { WorkerLoop(lane); });
         }
     }
+    const std::optional<std::string_view> label = RoutingLabel(message);
+    if (label.has_value() || lanes_.size() == 1) {
+        const std::size_t index = label.has_value() ? std::hash<std::string_view>{}(*label) % lanes_.size() : 0;
+        lanes_[index]->tasks.push_back(std::move(task));
+        lanes_[index]->ready.notify_one();
+        return;
+    }
+    auto barrier = std::make_shared<LaneBarrier>();
+    barrier->remaining = lanes_.size();
+    auto shared_task = std::make_shared<std::function<void()>>(std::move(task));
+    for (auto& lane : lanes_) {
+        lane->tasks.push_back([barrier, shared_task] {
+            std::unique_lock<std::mutex> barrier_lock(barrier->mutex);
+            if (--barrier->remaining != 0) {
+                barrier->done_cv.wait(barrier_lock, [&] { return barrier->done; });
+                return;
+            }
+            barrier_lock.unlock();
+            (*shared_task)();
+            barrier_lock.lock();
+            barrier->done = true;
+            barrier->done_cv.notify_all();
+        });
+        lane->ready.notify_one();
+    }
+}
+
+void MCPSandTimerServer::WorkerLoop(WorkerLane& lane) {
+    std::unique_lock<std::mutex> lock(tasks_mutex_);
+    for (;;) {
+        lane.ready.wait(lock, [&] { return workers_stopping_ || !lane.tasks.empty(); });
+        if (lane.tasks.empty()) {
+            return;
+        }
+        std::function<void()> task = std::move(lane.tasks.front());
+        lane.tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+// 等队列中的任务全部执行完再退出
+void MCPSandTimerServer::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        workers_stopping_ = true;
+        for (auto& lane : lanes_) {
+            lane->ready.notify_all();
+        }
+    }
+    for (auto& lane : lanes_) {
+        lane->thread.join();
+    }
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    lanes_.clear();
+    workers_stopping_ = false;
 }
 
 const std::vector<ToolDefinition>& MCPSandTimerServer::ToolDefinitions() {
@@ -95,13 +501,110 @@ const std::vector<ToolDefinition>& MCPSandTimerServer::ToolDefinitions() {
 
 // 读取 MCP/JSON-RPC 消息
 std::optional<json::Value> MCPSandTimerServer::ReadMessage() {
+    const AllocationScope scope(AllocationTag::Framing);
+    if (framing_.load() == MessageFraming::Auto && !DetectFraming()) {
+        return std::nullopt;
+    }
+    return framing_.load() == MessageFraming::Ndjson ? ReadLineMessage() : ReadContentLengthMessage();
+}
+
+// 跳过前导空白后窥视首字节：'{' 或 '[' 说明对端直接发送 JSON（NDJSON），否则是头部
+bool MCPSandTimerServer::DetectFraming() {
+    std::streambuf* buffer = input_.rdbuf();
+    for (;;) {
+        const auto ch = buffer->sgetc();
+        if (ch == std::char_traits<char>::eof()) {
+            input_.setstate(std::ios::eofbit);
+            return false;
+        }
+        if (!std::isspace(ch)) {
+            const MessageFraming framing =
+                (ch == '{' || ch == '[') ? MessageFraming::Ndjson : MessageFraming::ContentLength;
+            framing_.store(framing);
+            Logger::instance().debug("rpc.framing", "Detected message framing", to_string(framing));
+            return true;
+        }
+        buffer->sbumpc();
+    }
+}
+
+// NDJSON：用 memchr 在缓冲区中查找换行，每行直接在缓冲区上解析，不做额外拷贝
+std::optional<json::Value> MCPSandTimerServer::ReadLineMessage() {
+    constexpr std::size_t kReadChunk = 64 * 1024;
+    bool skipping = false;  // 当前行超过上限：丢弃到下一个换行为止
+    auto parse_line = [this](std::string_view line) {
+        try {
+            return json::Value::parse(line.data(), line.size(), parse_limits_);
+        } catch (const json::ParseError& error) {
+            throw JSONRPCError(-32700, "Parse error", json::make_object({{"message", json::Value(error.what())}}));
+        }
+    };
+    auto too_large = [this] {
+        return JSONRPCError(-32600, "Request too large", json::make_object({
+            {"limit", json::Value(static_cast<double>(parse_limits_.max_payload))}
+        }));
+    };
+
+    for (;;) {
+        const char* data = line_buffer_.data();
+        const void* newline = line_scanned_ < line_end_
+                                  ? std::memchr(data + line_scanned_, '\n', line_end_ - line_scanned_)
+                                  : nullptr;
+        if (newline != nullptr) {
+            const std::size_t begin = line_begin_;
+            const std::size_t end = static_cast<std::size_t>(static_cast<const char*>(newline) - data);
+            line_begin_ = line_scanned_ = end + 1;
+            if (skipping) {
+                throw too_large();
+            }
+            const std::string_view line = Trim(std::string_view(data + begin, end - begin));
+            if (!line.empty()) {
+                return parse_line(line);
+            }
+            continue;
+        }
+        line_scanned_ = line_end_;
+        if (line_end_ - line_begin_ > parse_limits_.max_payload) {
+            skipping = true;
+            line_begin_ = line_scanned_ = line_end_ = 0;
+        }
+
+        // 把未处理的数据移到缓冲区开头，再从流中读取
+        if (line_begin_ > 0) {
+            std::memmove(line_buffer_.data(), line_buffer_.data() + line_begin_, line_end_ - line_begin_);
+            line_end_ -= line_begin_;
+            line_scanned_ -= line_begin_;
+            line_begin_ = 0;
+        }
+        if (line_buffer_.size() < line_end_ + kReadChunk) {
+            line_buffer_.resize(line_end_ + kReadChunk);
+        }
+        const std::size_t read = ReadAvailable(input_, line_buffer_.data() + line_end_, kReadChunk);
+        if (read == 0) {
+            // 流结束：最后一行可以没有换行符
+            const std::string_view rest = Trim(std::string_view(line_buffer_.data(), line_end_));
+            line_begin_ = line_scanned_ = line_end_ = 0;
+            if (skipping) {
+                throw too_large();
+            }
+            if (rest.empty()) {
+                return std::nullopt;
+            }
+            return parse_line(rest);
+        }
+        line_end_ += read;
+    }
+}
+
+// LSP 风格：Content-Length 头部 + 空行 + 负载
+std::optional<json::Value> MCPSandTimerServer::ReadContentLengthMessage() {
     std::string line;
     std::size_t content_length = 0;
     bool saw_header = false;
 
     // 循环逐行读取头部
     while (true) {
-        if (!std::getline(input_, line)) {
+        if (!ReadHeaderLine(input_, line)) {
             if (!saw_header && input_.eof()) {
                 return std::nullopt;
             }
@@ -116,13 +619,13 @@ std::optional<json::Value> MCPSandTimerServer::ReadMessage() {
         saw_header = true;
         auto colon = line.find(':');
         if (colon == std::string::npos) {
-            throw JSONRPCError(-32700, "Invalid header line", json::make_object({{"header", json::Value(line.c_str())}}));
+            throw JSONRPCError(-32700, "Invalid header line", json::make_object({{"header", json::Value(std::move(line))}}));
         }
         std::string key = ToLower(line.substr(0, colon));
-        std::string value = Trim(line.substr(colon + 1));
+        std::string_view value = Trim(std::string_view(line).substr(colon + 1));
         if (key == "content-length") {
             try {
-                content_length = static_cast<std::size_t>(std::stoul(value));
+                content_length = static_cast<std::size_t>(std::stoul(std::string(value)));
             } catch (const std::exception&) {
                 throw JSONRPCError(-32600, "Invalid Content-Length header");
             }
@@ -137,18 +640,54 @@ std::optional<json::Value> MCPSandTimerServer::ReadMessage() {
         throw JSONRPCError(-32600, "Missing Content-Length header");
     }
 
-    // 按 content_length 读取 JSON 负载
-    std::string payload(content_length, '\0');
-    input_.read(payload.data(), static_cast<std::streamsize>(content_length));
-    if (static_cast<std::size_t>(input_.gcount()) != content_length) {
-        throw JSONRPCError(-32700, "Unexpected end of stream while reading payload");
+    // 超过上限的负载直接跳过，不为其分配内存
+    if (content_length > parse_limits_.max_payload) {
+        std::size_t remaining = content_length;
+        while (remaining > 0 && input_) {
+            const auto chunk = static_cast<std::streamsize>(
+                std::min<std::size_t>(remaining, static_cast<std::size_t>(std::numeric_limits<std::streamsize>::max())));
+            input_.ignore(chunk);
+            remaining -= static_cast<std::size_t>(input_.gcount());
+            if (input_.gcount() == 0) {
+                break;
+            }
+        }
+        throw JSONRPCError(-32600, "Request too large", json::make_object({
+            {"contentLength", json::Value(static_cast<double>(content_length))},
+            {"limit", json::Value(static_cast<double>(parse_limits_.max_payload))}
+        }));
     }
 
-    try {
-        return json::Value::parse(payload);
-    } catch (const json::ParseError& error) {
-        throw JSONRPCError(-32700, "Parse error", json::make_object({{"message", json::Value(error.what())}}));
+    // 按块读取负载并增量解析，不再整段缓冲；出错后仍读完本帧以保持流同步
+    char buffer[16 * 1024];
+    std::size_t remaining = content_length;
+    std::string parse_error;
+    parser_.reset();
+    while (remaining > 0) {
+        const std::size_t chunk = std::min(remaining, sizeof(buffer));
+        input_.read(buffer, static_cast<std::streamsize>(chunk));
+        const auto read = static_cast<std::size_t>(input_.gcount());
+        if (read != chunk) {
+            throw JSONRPCError(-32700, "Unexpected end of stream while reading payload");
+        }
+        remaining -= read;
+        if (!parse_error.empty()) {
+            continue;
+        }
+        const json::PushParser::Status status = parser_.feed(buffer, read);
+        if (status == json::PushParser::Status::Error) {
+            parse_error = parser_.error();
+        } else if (status == json::PushParser::Status::Done && parser_.consumed() < read) {
+            parse_error = "Unexpected trailing data in JSON payload";
+        }
+    }
+    if (parse_error.empty() && parser_.finish() == json::PushParser::Status::Error) {
+        parse_error = parser_.error();
+    }
+    if (!parse_error.empty()) {
+        throw JSONRPCError(-32700, "Parse error", json::make_object({{"message", json::Value(std::move(parse_error))}}));
     }
+    return parser_.take_value();
 }
 
 // JSON-RPC 消息分流处理（请求/通知）
@@ -160,8 +699,9 @@ void MCPSandTimerServer::Dispatch(const json::Value& message) {
     }
     const std::string& method = method_iter->second.as_string();
 
-    auto params_iter = object.find("params");
-    json::Value params = params_iter != object.end() ? params_iter->second : json::Value(json::Value::Object{});
+    // params 直接借用消息树中的节点，不做拷贝
+    const json::Value* params_value = message.find("params");
+    const json::Value& params = params_value != nullptr ? *params_value : EmptyObject();
 
     auto id_iter = object.find("id");
     if (id_iter == object.end()) {
@@ -169,51 +709,56 @@ void MCPSandTimerServer::Dispatch(const json::Value& message) {
         return;
     }
 
-    json::Value result = HandleRequest(method, params);
-    SendResponse(id_iter->second, result);
+    SendResponse(id_iter->second, HandleRequest(method, params));
 }
 
 void MCPSandTimerServer::HandleNotification(const std::string& method, const json::Value& params) {
-    (void)params;
     if (method == "notifications/initialized") {
         return;
     }
     if (method == "notifications/cancelled") {
-        std::cerr << "Received cancellation notification" << std::endl;
+        HandleCancelled(params);
         return;
     }
-    std::cerr << "Ignoring notification: " << method << std::endl;
+    Logger::instance().debug("notification.ignored", "Ignoring notification", method);
 }
 
-// 方法调度器
-json::Value MCPSandTimerServer::HandleRequest(const std::string& method, const json::Value& params) {
-    if (method == "initialize") {
-        return HandleInitialize(params);
-    }
-    if (method == "shutdown") {
-        shutdown_requested_ = true;
-        return json::Value(nullptr);
+// 置位对应请求的取消信号；在途的连接或发送随即放弃，由执行该请求的线程回复取消错误
+void MCPSandTimerServer::HandleCancelled(const json::Value& params) {
+    const json::Value* request_id = params.is_object() ? params.find("requestId") : nullptr;
+    if (request_id == nullptr) {
+        Logger::instance().warn("notification.cancelled", "Cancellation without a requestId");
+        return;
     }
-    if (method == "tools/list") {
-        json::Value::Array tools_array;
-        for (const auto& tool : GetToolDefinitions()) {
-            tools_array.push_back(tool.ToJson());
+    const std::string key = request_id->dump();
+    std::shared_ptr<InFlightRequest> request;
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        auto iter = in_flight_.find(key);
+        if (iter != in_flight_.end()) {
+            request = iter->second;
         }
-        return json::make_object({{"tools", json::Value(std::move(tools_array))}});
     }
-    if (method == "tools/call") {
-        return HandleToolCall(params);
+    if (!request) {
+        Logger::instance().debug("notification.cancelled", "Cancellation for a request that is not in flight", key);
+        return;
     }
-    if (method == "ping") {
-        return json::make_object({{"message", json::Value("pong")}});
+    request->token.cancel();
+    Logger::instance().info("notification.cancelled", "Cancelling request", key);
+}
+
+// 方法调度器：按名称在注册表中查找处理函数
+json::Value MCPSandTimerServer::HandleRequest(const std::string& method, const json::Value& params) {
+    const auto* entry = registry_.find_method(method);
+    if (entry == nullptr) {
+        throw JSONRPCError(-32601, "Method not found", json::make_object({{"method", json::Value(method)}}));
     }
-    throw JSONRPCError(-32601, "Method not found", json::make_object({{"method", json::Value(method.c_str())}}));
+    return entry->handler(params);
 }
 
 // MCP 协议中的 initialize 请求。客户端启动时的握手步骤
 json::Value MCPSandTimerServer::HandleInitialize(const json::Value& params) {
     (void)params;
-    initialized_ = true;
     // 构造服务端信息
     json::Value server_info = json::make_object({
         {"name", json::Value("mcp-sandtimer")},
@@ -221,125 +766,313 @@ json::Value MCPSandTimerServer::HandleInitialize(const json::Value& params) {
     });
     // 声明能力
     json::Value capabilities = json::make_object({
-        {"tools", json::make_object({{"listChanged", json::Value(false)}})}
+        {"tools", json::make_object({{"listChanged", json::Value(false)}})},
+        {"resources", json::make_object({{"subscribe", json::Value(true)}, {"listChanged", json::Value(false)}})}
     });
     // 返回握手结果
     return json::make_object({
         {"protocolVersion", json::Value(kProtocolVersion)},
-        {"serverInfo", server_info},
-        {"capabilities", capabilities}
+        {"serverInfo", std::move(server_info)},
+        {"capabilities", std::move(capabilities)}
     });
 }
 
+// 运行指标：sandtimer 端点与熔断器状态、内存占用，以及启用时的 spool 统计
+json::Value MCPSandTimerServer::HandleMetrics() {
+    json::Value metrics = json::make_object({
+        {"timerClient", timer_client_.metrics()},
+        {"logger", Logger::instance().stats().ToJson()},
+        {"timers", timer_engine_.stats().ToJson()},
+        {"labels", LabelTable::global().stats().ToJson()},
+        {"requests", json::make_object({
+            {"cancelled", json::Value(static_cast<double>(cancelled_requests_.load(std::memory_order_relaxed)))},
+            {"deadlineExceeded", json::Value(static_cast<double>(expired_requests_.load(std::memory_order_relaxed)))}
+        })}
+    });
+    if (spool_) {
+        metrics.as_object()["spool"] = spool_->stats().ToJson();
+    }
+    if (coalescer_) {
+        metrics.as_object()["coalescer"] = coalescer_->stats().ToJson();
+    }
+    if (idempotency_) {
+        metrics.as_object()["idempotency"] = idempotency_->stats().ToJson();
+    }
+    json::Value memory = AllocationTracker::stats().ToJson();
+    if (AllocationTracker::installed()) {
+        const auto messages = counted_messages_.load(std::memory_order_relaxed);
+        const auto allocations = message_allocations_.load(std::memory_order_relaxed);
+        memory.as_object()["perMessage"] = json::make_object({
+            {"messages", json::Value(static_cast<double>(messages))},
+            {"meanAllocations", json::Value(messages == 0 ? 0.0 : static_cast<double>(allocations) / messages)},
+            {"maxAllocations", json::Value(static_cast<double>(max_message_allocations_.load(std::memory_order_relaxed)))}
+        });
+    }
+    metrics.as_object()["memory"] = std::move(memory);
+    return metrics;
+}
+
+// 每个被跟踪的计时器是一个资源
+json::Value MCPSandTimerServer::HandleResourceList() {
+    json::Value::Array resources;
+    for (const auto& timer : timer_engine_.timers()) {
+        resources.push_back(json::make_object({
+            {"uri", json::Value(TimerUri(timer.label))},
+            {"name", json::Value(timer.label.view())},
+            {"description", json::Value(TimerMessage("Countdown state of sandtimer '", timer.label, "'."))},
+            {"mimeType", json::Value("application/json")}
+        }));
+    }
+    return json::make_object({{"resources", json::Value(std::move(resources))}});
+}
+
+json::Value MCPSandTimerServer::HandleResourceRead(const json::Value& params) {
+    const json::Value* uri = params.find("uri");
+    if (uri == nullptr || !uri->is_string()) {
+        throw JSONRPCError(-32602, "Invalid params", json::make_object({{"message", json::Value("A string uri is required.")}}));
+    }
+    const auto label = LabelFromUri(uri->as_string_view());
+    const auto timer = label ? timer_engine_.find(*label) : std::nullopt;
+    if (!timer) {
+        throw JSONRPCError(-32602, "Unknown resource", json::make_object({{"uri", *uri}}));
+    }
+    return json::make_object({
+        {"contents", json::make_array(json::make_object({
+            {"uri", *uri},
+            {"mimeType", json::Value("application/json")},
+            {"text", json::Value(timer->ToJson().dump())}
+        }))}
+    });
+}
+
+// 订阅 timer://<label>，或用 timer:// 订阅全部计时器；尚未启动的 label 也可以预先订阅
+json::Value MCPSandTimerServer::HandleSubscribe(const json::Value& params, bool subscribe) {
+    const json::Value* uri = params.find("uri");
+    if (uri == nullptr || !uri->is_string() || !LabelFromUri(uri->as_string_view())) {
+        throw JSONRPCError(-32602, "Invalid params", json::make_object({{"message", json::Value("A timer:// uri is required.")}}));
+    }
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+    if (subscribe) {
+        subscriptions_.insert(uri->as_string());
+    } else {
+        subscriptions_.erase(uri->as_string());
+    }
+    return json::Value(json::Value::Object{});
+}
+
+// 在计时引擎线程上调用
+void MCPSandTimerServer::OnTimerExpired(const TimerEngine::Timer& timer) {
+    json::Value params = timer.ToJson();
+    params.as_object()["uri"] = json::Value(TimerUri(timer.label));
+    params.as_object()["firedAt"] = json::Value(FormatTimestamp(TimerEngine::wall_clock::now()));
+    SendNotification("notifications/timer/expired", std::move(params));
+    NotifyResourceUpdated(timer.label);
+}
+
+void MCPSandTimerServer::NotifyResourceUpdated(std::string_view label) {
+    std::string uri = TimerUri(label);
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        if (subscriptions_.count(uri) == 0 && subscriptions_.count(kTimerUriPrefix) == 0) {
+            return;
+        }
+    }
+    SendNotification("notifications/resources/updated", json::make_object({{"uri", json::Value(std::move(uri))}}));
+}
+
 json::Value MCPSandTimerServer::HandleToolCall(const json::Value& params) {
     const auto& object = params.as_object();
     auto name_iter = object.find("name");
     if (name_iter == object.end() || !name_iter->second.is_string()) {
         throw JSONRPCError(-32602, "Invalid params", json::make_object({{"message", json::Value("Tool name must be provided as a string.")}}));
     }
-    std::string name = name_iter->second.as_string();
+    std::string_view name = name_iter->second.as_string_view();
 
-    json::Value arguments;
-    auto args_iter = object.find("arguments");
-    if (args_iter != object.end()) {
-        if (!args_iter->second.is_object()) {
-            throw JSONRPCError(-32602, "Invalid params", json::make_object({{"message", json::Value("Tool arguments must be provided as an object.")}}));
-        }
-        arguments = args_iter->second;
-    } else {
-        arguments = json::Value(json::Value::Object{});
+    const json::Value* arguments_value = params.find("arguments");
+    if (arguments_value != nullptr && !arguments_value->is_object()) {
+        throw JSONRPCError(-32602, "Invalid params", json::make_object({{"message", json::Value("Tool arguments must be provided as an object.")}}));
+    }
+    const json::Value& arguments = arguments_value != nullptr ? *arguments_value : EmptyObject();
+
+    const auto* tool = registry_.find_tool(name);
+    if (tool == nullptr) {
+        throw JSONRPCError(-32601, "Tool not found", json::make_object({{"name", json::Value(name)}}));
+    }
+    // 按 inputSchema 统一校验参数，各 Handle* 只需处理业务逻辑
+    ValidationError validation;
+    if (!tool->validator.validate(arguments, &validation)) {
+        throw JSONRPCError(-32602, "Invalid params", json::make_object({
+            {"message", json::Value("Argument " + (validation.path.empty() ? std::string("object") : validation.path) + " " + validation.message + ".")},
+            {"path", json::Value(validation.path)}
+        }));
     }
 
     std::string text;
-    if (name == "start_timer") {
-        text = HandleStart(arguments);
-    } else if (name == "reset_timer") {
-        text = HandleReset(arguments);
-    } else if (name == "cancel_timer") {
-        text = HandleCancel(arguments);
+    IdempotencyCache::Source source = IdempotencyCache::Source::Computed;
+    std::optional<std::string> key = idempotency_ ? IdempotencyKey(params, name) : std::nullopt;
+    if (key) {
+        try {
+            auto result = idempotency_->run(std::move(*key), current_call,
+                                            [&] { return tool->handler(arguments); });
+            text = std::move(result.value);
+            source = result.source;
+        } catch (const RequestCancelledError&) {
+            cancelled_requests_.fetch_add(1, std::memory_order_relaxed);
+            throw JSONRPCError(-32800, "Request cancelled");
+        } catch (const DeadlineExceededError& error) {
+            expired_requests_.fetch_add(1, std::memory_order_relaxed);
+            throw JSONRPCError(-32003, "Request deadline exceeded", json::make_object({{"message", json::Value(error.what())}}));
+        }
     } else {
-        throw JSONRPCError(-32601, "Tool not found", json::make_object({{"name", json::Value(name.c_str())}}));
+        text = tool->handler(arguments);
     }
 
     json::Value::Array content;
-    content.push_back(json::make_object({{"type", json::Value("text")}, {"text", json::Value(text.c_str())}}));
-    return json::make_object({{"content", json::Value(std::move(content))}});
+    content.push_back(json::make_object({{"type", json::Value("text")}, {"text", json::Value(std::move(text))}}));
+    json::Value result = json::make_object({{"content", json::Value(std::move(content))}});
+    // 没有重新执行的调用在 _meta 中注明结果的来源
+    if (source != IdempotencyCache::Source::Computed) {
+        result.as_object()["_meta"] = json::make_object({{"idempotency", json::Value(to_string(source))}});
+    }
+    return result;
 }
 
 std::string MCPSandTimerServer::HandleStart(const json::Value& arguments) {
-    std::string label = ExtractLabel(arguments);
-    const auto& object = arguments.as_object();
-    auto time_iter = object.find("time");
-    if (time_iter == object.end() || !time_iter->second.is_number()) {
-        throw JSONRPCError(-32602, "Invalid params", json::make_object({{"message", json::Value("The 'time' property must be a positive number.")}}));
-    }
-    double seconds_value = time_iter->second.as_number();
-    if (seconds_value <= 0) {
-        throw JSONRPCError(-32602, "Invalid params", json::make_object({{"message", json::Value("Timer length must be greater than zero.")}}));
-    }
-    int seconds = static_cast<int>(seconds_value);
-    try {
-        timer_client_.start_timer(label, seconds);
-    } catch (const TimerClientError& error) {
-        throw JSONRPCError(-32001, "Failed to reach sandtimer", json::make_object({{"message", json::Value(error.what())}}));
-    }
+    const Label label = ExtractLabel(arguments);
+    // time 的类型与下限已由 schema 校验
+    int seconds = static_cast<int>(arguments.find("time")->as_number());
     std::ostringstream oss;
-    oss << "Started timer '" << label << "' for " << seconds << " seconds.";
+    switch (Forward(TimerCommand{TimerOp::Start, label, seconds})) {
+        case Delivery::Queued:
+            oss << "Queued start of timer '" << label << "' for " << seconds << " seconds.";
+            break;
+        case Delivery::Superseded:
+            oss << "Start of timer '" << label << kSupersededSuffix;
+            break;
+        case Delivery::Sent:
+        case Delivery::Merged:
+            oss << "Started timer '" << label << "' for " << seconds << " seconds.";
+            break;
+    }
     return oss.str();
 }
 
 std::string MCPSandTimerServer::HandleReset(const json::Value& arguments) {
-    std::string label = ExtractLabel(arguments);
-    try {
-        timer_client_.reset_timer(label);
-    } catch (const TimerClientError& error) {
-        throw JSONRPCError(-32001, "Failed to reach sandtimer", json::make_object({{"message", json::Value(error.what())}}));
+    const TimerCommand command{TimerOp::Reset, ExtractLabel(arguments), 0};
+    switch (Forward(command)) {
+        case Delivery::Queued:
+            return TimerMessage("Queued reset of timer '", command.label, "'.");
+        case Delivery::Merged:
+            return TimerMessage("Reset timer '", command.label, "' together with a pending command for the same timer.");
+        case Delivery::Superseded:
+            return TimerMessage("Reset of timer '", command.label, kSupersededSuffix);
+        case Delivery::Sent:
+            break;
     }
-    return "Reset timer '" + label + "'.";
+    return TimerMessage("Reset timer '", command.label, "'.");
 }
 
 std::string MCPSandTimerServer::HandleCancel(const json::Value& arguments) {
-    std::string label = ExtractLabel(arguments);
+    const TimerCommand command{TimerOp::Cancel, ExtractLabel(arguments), 0};
+    switch (Forward(command)) {
+        case Delivery::Queued:
+            return TimerMessage("Queued cancellation of timer '", command.label, "'.");
+        case Delivery::Superseded:
+            return TimerMessage("Cancellation of timer '", command.label, kSupersededSuffix);
+        case Delivery::Sent:
+        case Delivery::Merged:
+            break;
+    }
+    return TimerMessage("Cancelled timer '", command.label, "'.");
+}
+
+// 把命令交给 sandtimer：启用 spool 时写入落盘队列并立即返回 Queued；
+// 启用合并窗口时等窗口内的命令合并后发送，否则同步发送
+MCPSandTimerServer::Delivery MCPSandTimerServer::Forward(const TimerCommand& command) {
+    if (spool_) {
+        try {
+            spool_->append(command);
+        } catch (const SpoolError& error) {
+            throw JSONRPCError(-32002, "Command spool unavailable", json::make_object({{"message", json::Value(error.what())}}));
+        }
+        timer_engine_.apply(command);
+        NotifyResourceUpdated(command.label);
+        return Delivery::Queued;
+    }
+    Delivery delivery = Delivery::Sent;
     try {
-        timer_client_.cancel_timer(label);
+        if (coalescer_) {
+            switch (coalescer_->submit(command, current_call)) {
+                case CommandCoalescer::Outcome::Sent:
+                    break;
+                case CommandCoalescer::Outcome::Merged:
+                    delivery = Delivery::Merged;
+                    break;
+                case CommandCoalescer::Outcome::Superseded:
+                    delivery = Delivery::Superseded;
+                    break;
+            }
+        } else {
+            timer_client_.send(command, current_call);
+        }
+    } catch (const RequestCancelledError&) {
+        cancelled_requests_.fetch_add(1, std::memory_order_relaxed);
+        throw JSONRPCError(-32800, "Request cancelled");
+    } catch (const DeadlineExceededError& error) {
+        expired_requests_.fetch_add(1, std::memory_order_relaxed);
+        throw JSONRPCError(-32003, "Request deadline exceeded", json::make_object({{"message", json::Value(error.what())}}));
     } catch (const TimerClientError& error) {
         throw JSONRPCError(-32001, "Failed to reach sandtimer", json::make_object({{"message", json::Value(error.what())}}));
     }
-    return "Cancelled timer '" + label + "'.";
+    // 被取代的命令也照常镜像：取代它的命令随后应用，引擎的状态与 sandtimer 一致
+    timer_engine_.apply(command);
+    NotifyResourceUpdated(command.label);
+    return delivery;
 }
 
-std::string MCPSandTimerServer::ExtractLabel(const json::Value& arguments) {
-    const auto& object = arguments.as_object();
-    auto iter = object.find("label");
-    if (iter == object.end() || !iter->second.is_string()) {
-        throw JSONRPCError(-32602, "Invalid params", json::make_object({{"message", json::Value("A non-empty string label is required.")}}));
-    }
-    std::string label = Trim(iter->second.as_string());
+// 去掉首尾空白后驻留；同一 label 的重复调用不再复制字符串
+Label MCPSandTimerServer::ExtractLabel(const json::Value& arguments) {
+    // 类型与 minLength 已由 schema 校验，这里只拒绝全是空白的 label
+    std::string_view label = Trim(arguments.find("label")->as_string_view());
     if (label.empty()) {
         throw JSONRPCError(-32602, "Invalid params", json::make_object({{"message", json::Value("A non-empty string label is required.")}}));
     }
-    return label;
+    return Label(label);
 }
 
 void MCPSandTimerServer::Send(const json::Value& payload) {
+    const AllocationScope scope(AllocationTag::Framing);
     const std::string encoded = payload.dump();
-    output_ << "Content-Length: " << encoded.size() << "\r\n\r\n" << encoded;
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    if (framing_.load() == MessageFraming::Ndjson) {
+        output_ << encoded << '\n';
+    } else {
+        output_ << "Content-Length: " << encoded.size() << "\r\n\r\n" << encoded;
+    }
     output_.flush();
 }
 
-void MCPSandTimerServer::SendResponse(const json::Value& id, const json::Value& result) {
+void MCPSandTimerServer::SendResponse(const json::Value& id, json::Value result) {
     json::Value response = json::make_object({
         {"jsonrpc", json::Value("2.0")},
         {"id", id},
-        {"result", result}
+        {"result", std::move(result)}
     });
     Send(response);
 }
 
+void MCPSandTimerServer::SendNotification(const char* method, json::Value params) {
+    Send(json::make_object({
+        {"jsonrpc", json::Value("2.0")},
+        {"method", json::Value(method)},
+        {"params", std::move(params)}
+    }));
+}
+
 void MCPSandTimerServer::SendError(const json::Value& id, const JSONRPCError& error) {
     json::Value error_object = json::make_object({
         {"code", json::Value(error.code())},
-        {"message", json::Value(error.message().c_str())}
+        {"message", json::Value(error.message())}
     });
     if (error.has_data()) {
         error_object.as_object()["data"] = error.data();
@@ -347,7 +1080,7 @@ void MCPSandTimerServer::SendError(const json::Value& id, const JSONRPCError& er
     json::Value response = json::make_object({
         {"jsonrpc", json::Value("2.0")},
         {"id", id},
-        {"error", error_object}
+        {"error", std::move(error_object)}
     });
     Send(response);
 }
@@ -0,0 +1,119 @@
+#include "MappedFile.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mcp_sandtimer {
+
+MappedFile::~MappedFile() { close(); }
+
+#ifdef _WIN32
+void MappedFile::open(const std::string& path, std::size_t size) {
+    close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Unable to open " + path + " (code " + std::to_string(GetLastError()) + ")");
+    }
+    LARGE_INTEGER current{};
+    GetFileSizeEx(file, &current);
+    existed_ = static_cast<std::size_t>(current.QuadPart) >= size;
+    const DWORD high = static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32);
+    const DWORD low = static_cast<DWORD>(size & 0xFFFFFFFFu);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, high, low, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        throw std::runtime_error("Unable to map " + path + " (code " + std::to_string(GetLastError()) + ")");
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Unable to map " + path + " (code " + std::to_string(GetLastError()) + ")");
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = view;
+    size_ = size;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        FlushViewOfFile(data_, size_);
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mapping_));
+        mapping_ = nullptr;
+    }
+    if (file_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(file_));
+        file_ = nullptr;
+    }
+    size_ = 0;
+}
+
+void MappedFile::flush() {
+    if (data_ != nullptr) {
+        FlushViewOfFile(data_, size_);
+    }
+}
+#else
+void MappedFile::open(const std::string& path, std::size_t size) {
+    close();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open " + path + ": " + std::strerror(errno));
+    }
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Unable to stat " + path + ": " + std::strerror(errno));
+    }
+    existed_ = static_cast<std::size_t>(info.st_size) >= size;
+    if (!existed_ && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Unable to size " + path + ": " + std::strerror(errno));
+    }
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Unable to map " + path + ": " + std::strerror(errno));
+    }
+    fd_ = fd;
+    data_ = view;
+    size_ = size;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        msync(data_, size_, MS_SYNC);
+        munmap(data_, size_);
+        data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+}
+
+void MappedFile::flush() {
+    if (data_ != nullptr) {
+        msync(data_, size_, MS_ASYNC);
+    }
+}
+#endif
+
+}  // namespace mcp_sandtimer
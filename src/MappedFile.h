@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// 跨平台的读写内存映射文件（文件不存在时按给定大小创建）
+namespace mcp_sandtimer {
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    // 打开并映射整个文件；文件比 size 小时扩展到 size。失败抛出 std::runtime_error
+    void open(const std::string& path, std::size_t size);
+    void close();
+    // 把脏页写回磁盘
+    void flush();
+
+    bool is_open() const noexcept { return data_ != nullptr; }
+    char* data() noexcept { return static_cast<char*>(data_); }
+    std::size_t size() const noexcept { return size_; }
+    // 本次打开前文件是否已存在且大小足够
+    bool existed() const noexcept { return existed_; }
+
+private:
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool existed_ = false;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+}  // namespace mcp_sandtimer
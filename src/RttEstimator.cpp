@@ -0,0 +1,77 @@
+#include "mcp_sandtimer/RttEstimator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace mcp_sandtimer {
+
+namespace {
+// 时钟粒度 G：RTTVAR 接近 0 时超时也至少比 SRTT 多出这么多
+constexpr std::int64_t kGranularityUs = 1000;
+}  // namespace
+
+void RttEstimator::record_sample(clock::duration rtt) {
+    const std::int64_t sample =
+        std::max<std::int64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(rtt).count());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stats_.samples == 0) {
+        srtt_us_ = sample;
+        rttvar_us_ = sample / 2;
+    } else {
+        // RTTVAR = 3/4·RTTVAR + 1/4·|SRTT - R|，SRTT = 7/8·SRTT + 1/8·R，先更新 RTTVAR
+        rttvar_us_ = (3 * rttvar_us_ + std::abs(srtt_us_ - sample)) / 4;
+        srtt_us_ = (7 * srtt_us_ + sample) / 8;
+    }
+    ++stats_.samples;
+    stats_.backoff = 0;
+    publish_locked();
+}
+
+void RttEstimator::record_timeout() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.timeouts;
+    // 尚无样本时超时已经取上限，无需退避
+    if (stats_.samples != 0) {
+        stats_.backoff = std::min(stats_.backoff + 1, kMaxBackoff);
+        publish_locked();
+    }
+}
+
+std::chrono::milliseconds RttEstimator::timeout(std::chrono::milliseconds floor,
+                                                std::chrono::milliseconds ceiling) const {
+    const std::int64_t estimate = timeout_us_.load(std::memory_order_acquire);
+    if (estimate == 0) {
+        return ceiling;
+    }
+    // 向上取整到毫秒，避免亚毫秒的本机往返得到 0
+    const std::chrono::milliseconds rounded{(estimate + 999) / 1000};
+    return std::max(std::min(rounded, ceiling), std::min(floor, ceiling));
+}
+
+RttEstimator::Stats RttEstimator::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.srtt_ms = static_cast<double>(srtt_us_) / 1000.0;
+    stats.rttvar_ms = static_cast<double>(rttvar_us_) / 1000.0;
+    stats.timeout_ms = static_cast<double>(timeout_us_.load(std::memory_order_relaxed)) / 1000.0;
+    return stats;
+}
+
+void RttEstimator::publish_locked() {
+    const std::int64_t base = srtt_us_ + std::max(kGranularityUs, 4 * rttvar_us_);
+    // 退避到 2^16 倍之后任何合理的上限都已封顶，左移不会溢出
+    timeout_us_.store(base << stats_.backoff, std::memory_order_release);
+}
+
+json::Value RttEstimator::Stats::ToJson() const {
+    return json::make_object({
+        {"samples", json::Value(static_cast<double>(samples))},
+        {"timeouts", json::Value(static_cast<double>(timeouts))},
+        {"srttMs", json::Value(srtt_ms)},
+        {"rttvarMs", json::Value(rttvar_ms)},
+        {"timeoutMs", json::Value(timeout_ms)},
+        {"backoff", json::Value(backoff)}
+    });
+}
+
+}  // namespace mcp_sandtimer
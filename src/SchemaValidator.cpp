@@ -0,0 +1,333 @@
+#include "mcp_sandtimer/SchemaValidator.h"
+
+#include <cmath>
+#include <string>
+#include <utility>
+
+namespace mcp_sandtimer {
+namespace {
+
+// JSON Pointer 片段转义：'~' -> "~0"，'/' -> "~1"
+void prepend_segment(ValidationError* error, const std::string& segment) {
+    if (error == nullptr) {
+        return;
+    }
+    std::string escaped = "/";
+    for (char ch : segment) {
+        if (ch == '~') {
+            escaped += "~0";
+        } else if (ch == '/') {
+            escaped += "~1";
+        } else {
+            escaped.push_back(ch);
+        }
+    }
+    error->path.insert(0, escaped);
+}
+
+// 只有调用方需要错误详情时才构造消息，快速路径上不分配
+template <typename MessageFn>
+bool fail(ValidationError* error, MessageFn&& message) {
+    if (error != nullptr) {
+        error->path.clear();
+        error->message = message();
+    }
+    return false;
+}
+
+// minLength/maxLength 按 Unicode 码点计数
+std::size_t utf8_length(const std::string& text) {
+    std::size_t count = 0;
+    for (unsigned char ch : text) {
+        if ((ch & 0xC0) != 0x80) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::string format_number(double value) {
+    return json::Value(value).dump();
+}
+
+}  // namespace
+
+SchemaError::SchemaError(const std::string& message) : std::runtime_error(message) {}
+
+SchemaValidator SchemaValidator::compile(const json::Value& schema) {
+    SchemaValidator validator;
+    validator.compile_node(schema);
+    return validator;
+}
+
+std::uint32_t SchemaValidator::compile_node(const json::Value& schema) {
+    if (schema.is_boolean()) {
+        // true 接受任意值；false 不在支持范围内
+        if (!schema.as_bool()) {
+            throw SchemaError("Boolean 'false' schemas are not supported");
+        }
+        nodes_.emplace_back();
+        return static_cast<std::uint32_t>(nodes_.size() - 1);
+    }
+    if (!schema.is_object()) {
+        throw SchemaError("Schema must be an object");
+    }
+    const auto& object = schema.as_object();
+    const auto index = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+    Node node;
+
+    auto type_iter = object.find("type");
+    if (type_iter != object.end()) {
+        auto add_type = [&node](const json::Value& name) {
+            const std::string& text = name.as_string();
+            if (text == "null") {
+                node.types |= kNull;
+            } else if (text == "boolean") {
+                node.types |= kBoolean;
+            } else if (text == "number") {
+                node.types |= kNumber;
+            } else if (text == "integer") {
+                node.types |= kInteger;
+            } else if (text == "string") {
+                node.types |= kString;
+            } else if (text == "object") {
+                node.types |= kObject;
+            } else if (text == "array") {
+                node.types |= kArray;
+            } else {
+                throw SchemaError("Unknown schema type: " + text);
+            }
+        };
+        if (type_iter->second.is_array()) {
+            for (const auto& entry : type_iter->second.as_array()) {
+                add_type(entry);
+            }
+        } else {
+            add_type(type_iter->second);
+        }
+    }
+
+    auto number = [&object](const char* key, double& out) {
+        auto iter = object.find(key);
+        if (iter == object.end()) {
+            return false;
+        }
+        out = iter->second.as_number();
+        return true;
+    };
+    double length = 0.0;
+    if (number("minLength", length)) {
+        node.min_length = static_cast<std::size_t>(length);
+    }
+    if (number("maxLength", length)) {
+        node.max_length = static_cast<std::size_t>(length);
+    }
+    node.has_minimum = number("minimum", node.minimum);
+    node.has_maximum = number("maximum", node.maximum);
+    double bound = 0.0;
+    if (number("exclusiveMinimum", bound) && (!node.has_minimum || bound >= node.minimum)) {
+        node.has_minimum = true;
+        node.exclusive_minimum = true;
+        node.minimum = bound;
+    }
+    if (number("exclusiveMaximum", bound) && (!node.has_maximum || bound <= node.maximum)) {
+        node.has_maximum = true;
+        node.exclusive_maximum = true;
+        node.maximum = bound;
+    }
+
+    auto additional_iter = object.find("additionalProperties");
+    if (additional_iter != object.end()) {
+        if (!additional_iter->second.is_boolean()) {
+            throw SchemaError("Only boolean additionalProperties is supported");
+        }
+        node.closed = !additional_iter->second.as_bool();
+    }
+
+    auto properties_iter = object.find("properties");
+    if (properties_iter != object.end()) {
+        const auto& properties = properties_iter->second.as_object();
+        if (properties.size() > kMaxProperties) {
+            throw SchemaError("Schemas with more than 64 properties are not supported");
+        }
+        // 先占住连续区间（std::map 已按名称排序），再编译子 schema
+        node.first_property = static_cast<std::uint32_t>(properties_.size());
+        node.property_count = static_cast<std::uint32_t>(properties.size());
+        for (const auto& [name, child] : properties) {
+            (void)child;
+            properties_.push_back(Property{name, kNone});
+        }
+        std::uint32_t offset = node.first_property;
+        for (const auto& [name, child] : properties) {
+            (void)name;
+            const std::uint32_t child_index = compile_node(child);
+            properties_[offset++].node = child_index;
+        }
+    }
+
+    auto required_iter = object.find("required");
+    if (required_iter != object.end()) {
+        for (const auto& entry : required_iter->second.as_array()) {
+            const std::string& name = entry.as_string();
+            bool found = false;
+            for (std::uint32_t i = 0; i < node.property_count; ++i) {
+                if (properties_[node.first_property + i].name == name) {
+                    node.required_mask |= std::uint64_t{1} << i;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                throw SchemaError("Required property '" + name + "' is not declared in properties");
+            }
+        }
+    }
+
+    auto items_iter = object.find("items");
+    if (items_iter != object.end()) {
+        node.items = compile_node(items_iter->second);
+    }
+
+    nodes_[index] = node;
+    return index;
+}
+
+bool SchemaValidator::validate(const json::Value& instance, ValidationError* error) const {
+    if (nodes_.empty()) {
+        return true;
+    }
+    if (error != nullptr) {
+        error->path.clear();
+        error->message.clear();
+    }
+    return validate_node(0, instance, error);
+}
+
+bool SchemaValidator::validate_node(std::uint32_t index, const json::Value& instance, ValidationError* error) const {
+    const Node& node = nodes_[index];
+
+    if (node.types != 0) {
+        std::uint8_t actual = 0;
+        switch (instance.type()) {
+            case json::Value::Type::Null:
+                actual = kNull;
+                break;
+            case json::Value::Type::Boolean:
+                actual = kBoolean;
+                break;
+            case json::Value::Type::Number: {
+                const double value = instance.as_number();
+                actual = kNumber | (std::floor(value) == value ? kInteger : 0);
+                break;
+            }
+            case json::Value::Type::String:
+                actual = kString;
+                break;
+            case json::Value::Type::Object:
+                actual = kObject;
+                break;
+            case json::Value::Type::Array:
+                actual = kArray;
+                break;
+        }
+        if ((node.types & actual) == 0) {
+            return fail(error, [&] {
+                std::string expected;
+                const std::pair<std::uint8_t, const char*> names[] = {
+                    {kNull, "null"}, {kBoolean, "boolean"}, {kNumber, "number"}, {kInteger, "integer"},
+                    {kString, "string"}, {kObject, "object"}, {kArray, "array"}};
+                for (const auto& [bit, name] : names) {
+                    if ((node.types & bit) != 0) {
+                        expected += expected.empty() ? "" : " or ";
+                        expected += name;
+                    }
+                }
+                return "must be of type " + expected;
+            });
+        }
+    }
+
+    switch (instance.type()) {
+        case json::Value::Type::Number: {
+            const double value = instance.as_number();
+            if (node.has_minimum && (node.exclusive_minimum ? value <= node.minimum : value < node.minimum)) {
+                return fail(error, [&] {
+                    return std::string("must be ") + (node.exclusive_minimum ? "greater than " : "greater than or equal to ") +
+                           format_number(node.minimum);
+                });
+            }
+            if (node.has_maximum && (node.exclusive_maximum ? value >= node.maximum : value > node.maximum)) {
+                return fail(error, [&] {
+                    return std::string("must be ") + (node.exclusive_maximum ? "less than " : "less than or equal to ") +
+                           format_number(node.maximum);
+                });
+            }
+            return true;
+        }
+        case json::Value::Type::String: {
+            if (node.min_length == 0 && node.max_length == static_cast<std::size_t>(-1)) {
+                return true;
+            }
+            const std::size_t length = utf8_length(instance.as_string());
+            if (length < node.min_length) {
+                return fail(error, [&] { return "must be at least " + std::to_string(node.min_length) + " characters long"; });
+            }
+            if (length > node.max_length) {
+                return fail(error, [&] { return "must be at most " + std::to_string(node.max_length) + " characters long"; });
+            }
+            return true;
+        }
+        case json::Value::Type::Object: {
+            // 参数成员与声明的属性都按名称有序，归并遍历一次即可
+            const Property* property = properties_.data() + node.first_property;
+            const Property* const begin = property;
+            const Property* const end = property + node.property_count;
+            std::uint64_t seen = 0;
+            for (const auto& [key, value] : instance.as_object()) {
+                while (property != end && property->name < key) {
+                    ++property;
+                }
+                if (property != end && property->name == key) {
+                    seen |= std::uint64_t{1} << (property - begin);
+                    if (!validate_node(property->node, value, error)) {
+                        prepend_segment(error, key);
+                        return false;
+                    }
+                } else if (node.closed) {
+                    fail(error, [&] { return std::string("is not an allowed property"); });
+                    prepend_segment(error, key);
+                    return false;
+                }
+            }
+            const std::uint64_t missing = node.required_mask & ~seen;
+            if (missing != 0) {
+                std::uint32_t offset = 0;
+                while ((missing & (std::uint64_t{1} << offset)) == 0) {
+                    ++offset;
+                }
+                fail(error, [&] { return std::string("is required"); });
+                prepend_segment(error, begin[offset].name);
+                return false;
+            }
+            return true;
+        }
+        case json::Value::Type::Array: {
+            if (node.items == kNone) {
+                return true;
+            }
+            const auto& elements = instance.as_array();
+            for (std::size_t i = 0; i < elements.size(); ++i) {
+                if (!validate_node(node.items, elements[i], error)) {
+                    prepend_segment(error, std::to_string(i));
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+}  // namespace mcp_sandtimer
@@ -0,0 +1,694 @@
+#include "Socket.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#include "mcp_sandtimer/TimerClient.h"
+
+namespace mcp_sandtimer::net {
+namespace {
+
+// 带取消信号时 poll 的最长等待，决定取消生效的延迟
+constexpr std::chrono::milliseconds kCancelCheckInterval{10};
+
+#ifdef _WIN32
+using pollfd_type = WSAPOLLFD;
+inline int poll_sockets(pollfd_type* fds, std::size_t count, int timeout_ms) {
+    return WSAPoll(fds, static_cast<ULONG>(count), timeout_ms);
+}
+inline bool set_blocking(socket_handle socket, bool blocking) {
+    u_long mode = blocking ? 0 : 1;
+    return ioctlsocket(socket, FIONBIO, &mode) == 0;
+}
+inline bool connect_in_progress() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+inline bool would_block() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+#else
+using pollfd_type = pollfd;
+inline int poll_sockets(pollfd_type* fds, std::size_t count, int timeout_ms) {
+    return ::poll(fds, static_cast<nfds_t>(count), timeout_ms);
+}
+inline bool set_blocking(socket_handle socket, bool blocking) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    if (flags < 0) {
+        return false;
+    }
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    return fcntl(socket, F_SETFL, flags) == 0;
+}
+inline bool connect_in_progress() {
+    return errno == EINPROGRESS;
+}
+inline bool would_block() {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+#endif
+
+bool cancelled(const CancellationToken* cancellation) {
+    return cancellation != nullptr && cancellation->cancelled();
+}
+
+// 距离 wake 的等待时长（毫秒，向上取整）；有取消信号时切成短片以便及时响应
+int poll_timeout(clock::time_point wake, clock::time_point now, const CancellationToken* cancellation) {
+    auto wait = std::min(std::chrono::duration_cast<std::chrono::milliseconds>(wake - now),
+                         std::chrono::milliseconds{1000}) + std::chrono::milliseconds{1};
+    if (cancellation != nullptr) {
+        wait = std::min(wait, kCancelCheckInterval);
+    }
+    return static_cast<int>(wait.count());
+}
+
+std::string socket_error_message(const std::string& prefix, int code) {
+    std::ostringstream oss;
+#ifdef _WIN32
+    oss << prefix << " (code " << code << ")";
+#else
+    oss << prefix << ": " << std::strerror(code);
+#endif
+    return oss.str();
+}
+
+// RFC 8305 第 4 节：首个地址取偏好地址族，之后两个地址族交替
+std::vector<const SocketAddress*> interleave(const std::vector<SocketAddress>& candidates, int preferred_family) {
+    int first_family = preferred_family;
+    if (std::none_of(candidates.begin(), candidates.end(),
+                     [&](const SocketAddress& address) { return address.family == first_family; })) {
+        first_family = candidates.empty() ? AF_UNSPEC : candidates.front().family;
+    }
+    std::vector<const SocketAddress*> primary;
+    std::vector<const SocketAddress*> secondary;
+    for (const auto& address : candidates) {
+        (address.family == first_family ? primary : secondary).push_back(&address);
+    }
+    std::vector<const SocketAddress*> ordered;
+    ordered.reserve(candidates.size());
+    for (std::size_t i = 0; i < std::max(primary.size(), secondary.size()); ++i) {
+        if (i < primary.size()) {
+            ordered.push_back(primary[i]);
+        }
+        if (i < secondary.size()) {
+            ordered.push_back(secondary[i]);
+        }
+    }
+    return ordered;
+}
+
+struct Attempt {
+    socket_handle socket;
+    int family;
+};
+
+}  // namespace
+
+#ifdef _WIN32
+WinsockSession::WinsockSession() {
+    WSADATA data{};
+    const int result = WSAStartup(MAKEWORD(2, 2), &data);
+    if (result != 0) {
+        std::ostringstream oss;
+        oss << "WSAStartup failed with error " << result;
+        throw TimerClientError(oss.str());
+    }
+}
+
+WinsockSession::~WinsockSession() { WSACleanup(); }
+
+void close_socket(socket_handle socket) {
+    if (socket != kInvalidSocket) {
+        closesocket(socket);
+    }
+}
+
+std::string last_error_message(const std::string& prefix) {
+    return socket_error_message(prefix, WSAGetLastError());
+}
+#else
+void close_socket(socket_handle socket) {
+    if (socket != kInvalidSocket) {
+        close(socket);
+    }
+}
+
+std::string last_error_message(const std::string& prefix) {
+    return socket_error_message(prefix, errno);
+}
+#endif
+
+std::vector<SocketAddress> resolve(const std::string& host, std::uint16_t port) {
+    struct AddrInfoDeleter {
+        void operator()(addrinfo* ptr) const { if (ptr) { freeaddrinfo(ptr); } }
+    };
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    std::string port_string = std::to_string(port);
+    addrinfo* raw_info = nullptr;
+    int status = getaddrinfo(host.c_str(), port_string.c_str(), &hints, &raw_info);
+    if (status != 0) {
+#ifdef _WIN32
+        std::ostringstream oss;
+        oss << "getaddrinfo failed with error " << status;
+        throw TimerClientError(oss.str());
+#else
+        throw TimerClientError(std::string("getaddrinfo failed: ") + gai_strerror(status));
+#endif
+    }
+    std::unique_ptr<addrinfo, AddrInfoDeleter> info(raw_info);
+
+    std::vector<SocketAddress> addresses;
+    for (addrinfo* entry = info.get(); entry != nullptr; entry = entry->ai_next) {
+        if (entry->ai_addrlen > sizeof(sockaddr_storage)) {
+            continue;
+        }
+        SocketAddress address;
+        address.family = entry->ai_family;
+        std::memcpy(&address.storage, entry->ai_addr, entry->ai_addrlen);
+        address.length = static_cast<socklen_t>(entry->ai_addrlen);
+        addresses.push_back(address);
+    }
+    return addresses;
+}
+
+ConnectResult connect_happy_eyeballs(const std::vector<SocketAddress>& candidates, const ConnectOptions& options) {
+    ConnectResult result;
+    const std::vector<const SocketAddress*> ordered = interleave(candidates, options.preferred_family);
+    // 超时为 0 表示不限时；调用方的截止时间更早时以它为准
+    const auto deadline = std::min(
+        options.timeout.count() > 0 ? clock::now() + options.timeout : clock::time_point::max(), options.deadline);
+
+    std::vector<Attempt> pending;
+    std::vector<pollfd_type> fds;
+    std::size_t next = 0;
+    auto next_start = clock::now();
+
+    auto finish = [&](socket_handle winner, int family) {
+        for (const auto& attempt : pending) {
+            if (attempt.socket != winner) {
+                close_socket(attempt.socket);
+            }
+        }
+        pending.clear();
+        result.socket = winner;
+        result.family = family;
+    };
+
+    while (true) {
+        auto now = clock::now();
+        // 没有在途连接或到了错峰时间，就发起下一个候选地址的连接
+        if (next < ordered.size() && (pending.empty() || now >= next_start)) {
+            const SocketAddress& address = *ordered[next++];
+            next_start = now + options.attempt_delay;
+            socket_handle socket = ::socket(address.family, SOCK_STREAM, IPPROTO_TCP);
+            if (socket == kInvalidSocket) {
+                result.error = last_error_message("Failed to create socket");
+                next_start = now;
+                continue;
+            }
+            if (!set_blocking(socket, false)) {
+                result.error = last_error_message("Failed to configure socket");
+                close_socket(socket);
+                next_start = now;
+                continue;
+            }
+            if (::connect(socket, reinterpret_cast<const sockaddr*>(&address.storage), address.length) == 0) {
+                finish(socket, address.family);
+                return result;
+            }
+            if (!connect_in_progress()) {
+                result.error = last_error_message("Failed to connect to sandtimer");
+                close_socket(socket);
+                next_start = now;
+                continue;
+            }
+            pending.push_back(Attempt{socket, address.family});
+            continue;
+        }
+
+        if (pending.empty()) {
+            break;
+        }
+        if (cancelled(options.cancellation)) {
+            result.error = "Connection to sandtimer was cancelled";
+            break;
+        }
+        if (now >= deadline) {
+            result.error = "Timed out connecting to sandtimer";
+            break;
+        }
+
+        auto wake = deadline;
+        if (next < ordered.size()) {
+            wake = std::min(wake, next_start);
+        }
+
+        fds.clear();
+        for (const auto& attempt : pending) {
+            pollfd_type entry{};
+            entry.fd = attempt.socket;
+            entry.events = POLLOUT;
+            fds.push_back(entry);
+        }
+        if (poll_sockets(fds.data(), fds.size(), poll_timeout(wake, now, options.cancellation)) < 0) {
+            result.error = last_error_message("Failed to wait for connection");
+            break;
+        }
+
+        for (std::size_t i = fds.size(); i-- > 0;) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            int code = 0;
+            socklen_t length = sizeof(code);
+            getsockopt(pending[i].socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&code), &length);
+            if (code == 0 && (fds[i].revents & POLLOUT) != 0) {
+                finish(pending[i].socket, pending[i].family);
+                return result;
+            }
+            result.error = socket_error_message("Failed to connect to sandtimer", code);
+            close_socket(pending[i].socket);
+            pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+            // 某个连接失败时立即尝试下一个地址，不必等待错峰间隔
+            next_start = clock::now();
+        }
+    }
+
+    finish(kInvalidSocket, AF_UNSPEC);
+    if (result.error.empty()) {
+        result.error = "Unable to deliver payload to sandtimer";
+    }
+    return result;
+}
+
+bool send_all(socket_handle socket, std::string_view message, clock::time_point deadline,
+              const CancellationToken* cancellation, std::string& error) {
+    const char* data = message.data();
+    std::size_t remaining = message.size();
+    while (remaining > 0) {
+        const int chunk = static_cast<int>(::send(socket, data, static_cast<int>(remaining), 0));
+        if (chunk >= 0) {
+            data += chunk;
+            remaining -= static_cast<std::size_t>(chunk);
+            continue;
+        }
+        if (!would_block()) {
+            error = last_error_message("Failed to send payload");
+            return false;
+        }
+        // 发送缓冲区已满：等待可写、截止时间或取消
+        for (;;) {
+            if (cancelled(cancellation)) {
+                error = "Sending to sandtimer was cancelled";
+                return false;
+            }
+            const auto now = clock::now();
+            if (now >= deadline) {
+                error = "Timed out sending payload to sandtimer";
+                return false;
+            }
+            pollfd_type entry{};
+            entry.fd = socket;
+            entry.events = POLLOUT;
+            const int ready = poll_sockets(&entry, 1, poll_timeout(deadline, now, cancellation));
+            if (ready < 0) {
+                error = last_error_message("Failed to wait for socket");
+                return false;
+            }
+            if (ready > 0) {
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+Fanout::Fanout(std::string message, std::vector<std::vector<SocketAddress>> addresses, Completion on_complete)
+    : message_(std::move(message)), on_complete_(std::move(on_complete)), started_(clock::now()) {
+    targets_.resize(addresses.size());
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        targets_[i].addresses = std::move(addresses[i]);
+    }
+}
+
+Fanout::~Fanout() {
+    for (auto& target : targets_) {
+        release(target);
+    }
+}
+
+void Fanout::attach(Poller& poller, std::uint64_t token_base) {
+    poller_ = &poller;
+    token_base_ = token_base;
+}
+
+void Fanout::fail(std::size_t index, const std::string& error) {
+    if (targets_[index].status == Status::Pending) {
+        complete(index, Status::Failed, error);
+    }
+}
+
+void Fanout::start() {
+    // 延迟计时从第一次发起连接算起，不含排队等待的时间
+    if (!launched_) {
+        launched_ = true;
+        started_ = clock::now();
+    }
+    for (std::size_t i = 0; i < targets_.size(); ++i) {
+        if (targets_[i].status == Status::Pending && targets_[i].socket == kInvalidSocket) {
+            start_connect(i);
+        }
+    }
+}
+
+void Fanout::handle(std::size_t index, short revents) {
+    if (index < targets_.size() && targets_[index].status == Status::Pending &&
+        targets_[index].socket != kInvalidSocket) {
+        advance(index, revents);
+    }
+}
+
+void Fanout::run(clock::time_point until, const CancellationToken* cancellation, const std::function<bool()>& satisfied) {
+    start();
+    std::vector<pollfd_type> fds;
+    std::vector<std::size_t> owners;
+    for (;;) {
+        if (finished() || (satisfied && satisfied()) || cancelled(cancellation)) {
+            return;
+        }
+        const auto now = clock::now();
+        if (now >= until) {
+            return;
+        }
+        fds.clear();
+        owners.clear();
+        for (std::size_t i = 0; i < targets_.size(); ++i) {
+            if (targets_[i].status == Status::Pending && targets_[i].socket != kInvalidSocket) {
+                pollfd_type entry{};
+                entry.fd = targets_[i].socket;
+                entry.events = POLLOUT;
+                fds.push_back(entry);
+                owners.push_back(i);
+            }
+        }
+        if (poll_sockets(fds.data(), fds.size(), poll_timeout(until, now, cancellation)) < 0) {
+            abort(Status::Failed, last_error_message("Failed to wait for sockets"));
+            return;
+        }
+        for (std::size_t k = 0; k < fds.size(); ++k) {
+            if (fds[k].revents != 0) {
+                advance(owners[k], fds[k].revents);
+            }
+        }
+    }
+}
+
+void Fanout::abort(Status status, const std::string& error) {
+    for (std::size_t i = 0; i < targets_.size(); ++i) {
+        if (targets_[i].status == Status::Pending) {
+            complete(i, status, error);
+        }
+    }
+}
+
+std::size_t Fanout::retry_stalled() {
+    std::size_t retried = 0;
+    for (std::size_t i = 0; i < targets_.size(); ++i) {
+        Target& target = targets_[i];
+        if (target.status != Status::Pending || target.socket == kInvalidSocket || target.connected) {
+            continue;
+        }
+        release(target);
+        target.next_address = 0;
+        ++target.retries;
+        ++retried;
+        start_connect(i);
+    }
+    return retried;
+}
+
+// 按顺序尝试目标的下一个地址；全部失败时目标记为失败
+void Fanout::start_connect(std::size_t index) {
+    Target& target = targets_[index];
+    while (target.next_address < target.addresses.size()) {
+        const SocketAddress& address = target.addresses[target.next_address++];
+        socket_handle socket = ::socket(address.family, SOCK_STREAM, IPPROTO_TCP);
+        if (socket == kInvalidSocket) {
+            target.error = last_error_message("Failed to create socket");
+            continue;
+        }
+        if (!set_blocking(socket, false)) {
+            target.error = last_error_message("Failed to configure socket");
+            close_socket(socket);
+            continue;
+        }
+        if (::connect(socket, reinterpret_cast<const sockaddr*>(&address.storage), address.length) == 0) {
+            target.socket = socket;
+            target.connected = true;
+            if (poller_) {
+                poller_->add(socket, token_base_ | index);
+            }
+            advance(index, POLLOUT);
+            return;
+        }
+        if (connect_in_progress()) {
+            target.socket = socket;
+            if (poller_) {
+                poller_->add(socket, token_base_ | index);
+            }
+            return;
+        }
+        target.error = last_error_message("Failed to connect to sandtimer");
+        close_socket(socket);
+    }
+    complete(index, Status::Failed, target.error.empty() ? "No address to connect to" : target.error);
+}
+
+// socket 可写（或出错）时推进：先确认连接结果，再尽量写出剩余字节
+void Fanout::advance(std::size_t index, short revents) {
+    Target& target = targets_[index];
+    if (!target.connected) {
+        int code = 0;
+        socklen_t length = sizeof(code);
+        getsockopt(target.socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&code), &length);
+        if (code != 0 || (revents & POLLOUT) == 0) {
+            target.error = socket_error_message("Failed to connect to sandtimer", code);
+            release(target);
+            start_connect(index);
+            return;
+        }
+        target.connected = true;
+    }
+    while (target.sent < message_.size()) {
+        const int chunk = static_cast<int>(
+            ::send(target.socket, message_.data() + target.sent, static_cast<int>(message_.size() - target.sent), 0));
+        if (chunk >= 0) {
+            target.sent += static_cast<std::size_t>(chunk);
+            continue;
+        }
+        if (!would_block()) {
+            complete(index, Status::Failed, last_error_message("Failed to send payload"));
+        }
+        return;
+    }
+    complete(index, Status::Delivered, {});
+}
+
+void Fanout::complete(std::size_t index, Status status, std::string error) {
+    Target& target = targets_[index];
+    release(target);
+    target.status = status;
+    target.latency = clock::now() - started_;
+    target.error = std::move(error);
+    ++completed_;
+    if (status == Status::Delivered) {
+        ++delivered_;
+    } else {
+        ++failed_;
+    }
+    if (on_complete_) {
+        on_complete_(index, target);
+    }
+}
+
+void Fanout::release(Target& target) {
+    if (target.socket == kInvalidSocket) {
+        return;
+    }
+    if (poller_) {
+        poller_->remove(target.socket);
+    }
+    close_socket(target.socket);
+    target.socket = kInvalidSocket;
+}
+
+#ifdef __linux__
+struct Poller::State {
+    int epoll = -1;
+    int wake_fd = -1;  // eventfd，写入即唤醒 epoll_wait
+    std::vector<epoll_event> ready;
+};
+
+Poller::Poller() : state_(std::make_unique<State>()) {
+    state_->epoll = epoll_create1(EPOLL_CLOEXEC);
+    state_->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = 0;
+    if (state_->epoll < 0 || state_->wake_fd < 0 ||
+        epoll_ctl(state_->epoll, EPOLL_CTL_ADD, state_->wake_fd, &event) != 0) {
+        const std::string error = last_error_message("Failed to create event loop");
+        close_socket(state_->wake_fd);
+        close_socket(state_->epoll);
+        throw TimerClientError(error);
+    }
+    state_->ready.resize(256);
+}
+
+Poller::~Poller() {
+    close_socket(state_->wake_fd);
+    close_socket(state_->epoll);
+}
+
+void Poller::add(socket_handle socket, std::uint64_t token) {
+    epoll_event event{};
+    event.events = EPOLLOUT;
+    event.data.u64 = token + 1;  // 0 留给唤醒用的 eventfd
+    epoll_ctl(state_->epoll, EPOLL_CTL_ADD, socket, &event);
+}
+
+void Poller::remove(socket_handle socket) {
+    // 文件描述还被别处引用（如 fork 出的子进程）时 close 不会自动注销，所以要在关闭前显式删除
+    epoll_ctl(state_->epoll, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+void Poller::wait(std::vector<Event>& events, std::chrono::milliseconds timeout) {
+    events.clear();
+    const int count = epoll_wait(state_->epoll, state_->ready.data(), static_cast<int>(state_->ready.size()),
+                                 static_cast<int>(std::max<std::int64_t>(0, timeout.count())));
+    for (int i = 0; i < count; ++i) {
+        const epoll_event& event = state_->ready[static_cast<std::size_t>(i)];
+        if (event.data.u64 == 0) {
+            std::uint64_t value = 0;
+            [[maybe_unused]] const auto drained = ::read(state_->wake_fd, &value, sizeof(value));
+            continue;
+        }
+        short revents = 0;
+        revents |= (event.events & EPOLLOUT) != 0 ? POLLOUT : 0;
+        revents |= (event.events & EPOLLERR) != 0 ? POLLERR : 0;
+        revents |= (event.events & EPOLLHUP) != 0 ? POLLHUP : 0;
+        events.push_back(Event{event.data.u64 - 1, revents});
+    }
+}
+
+void Poller::wake() {
+    const std::uint64_t value = 1;
+    [[maybe_unused]] const auto written = ::write(state_->wake_fd, &value, sizeof(value));
+}
+#else
+// poll/WSAPoll 版本：唤醒用一个连向自己的本地 UDP socket，Windows 上也能放进 WSAPoll
+struct Poller::State {
+    socket_handle wake_socket = kInvalidSocket;
+    std::vector<pollfd_type> fds;       // fds[0] 是 wake_socket
+    std::vector<std::uint64_t> tokens;  // 与 fds 对齐
+    std::unordered_map<socket_handle, std::size_t> positions;
+};
+
+Poller::Poller() : state_(std::make_unique<State>()) {
+    socket_handle socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (socket == kInvalidSocket || ::bind(socket, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+        getsockname(socket, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+        ::connect(socket, reinterpret_cast<sockaddr*>(&address), length) != 0 || !set_blocking(socket, false)) {
+        const std::string error = last_error_message("Failed to create event loop");
+        close_socket(socket);
+        throw TimerClientError(error);
+    }
+    state_->wake_socket = socket;
+    pollfd_type entry{};
+    entry.fd = socket;
+    entry.events = POLLIN;
+    state_->fds.push_back(entry);
+    state_->tokens.push_back(0);
+}
+
+Poller::~Poller() { close_socket(state_->wake_socket); }
+
+void Poller::add(socket_handle socket, std::uint64_t token) {
+    pollfd_type entry{};
+    entry.fd = socket;
+    entry.events = POLLOUT;
+    state_->positions[socket] = state_->fds.size();
+    state_->fds.push_back(entry);
+    state_->tokens.push_back(token);
+}
+
+void Poller::remove(socket_handle socket) {
+    const auto it = state_->positions.find(socket);
+    if (it == state_->positions.end()) {
+        return;
+    }
+    // 与末尾交换后删除，保持 O(1)
+    const std::size_t position = it->second;
+    state_->positions.erase(it);
+    if (position + 1 != state_->fds.size()) {
+        state_->fds[position] = state_->fds.back();
+        state_->tokens[position] = state_->tokens.back();
+        state_->positions[state_->fds[position].fd] = position;
+    }
+    state_->fds.pop_back();
+    state_->tokens.pop_back();
+}
+
+void Poller::wait(std::vector<Event>& events, std::chrono::milliseconds timeout) {
+    events.clear();
+    if (poll_sockets(state_->fds.data(), state_->fds.size(),
+                     static_cast<int>(std::max<std::int64_t>(0, timeout.count()))) <= 0) {
+        return;
+    }
+    if (state_->fds[0].revents != 0) {
+        char buffer[64];
+        while (::recv(state_->wake_socket, buffer, sizeof(buffer), 0) > 0) {
+        }
+    }
+    for (std::size_t i = 1; i < state_->fds.size(); ++i) {
+        if (state_->fds[i].revents != 0) {
+            events.push_back(Event{state_->tokens[i], state_->fds[i].revents});
+        }
+    }
+}
+
+void Poller::wake() {
+    const char byte = 0;
+    ::send(state_->wake_socket, &byte, 1, 0);
+}
+#endif
+
+}  // namespace mcp_sandtimer::net
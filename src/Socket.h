@@ -0,0 +1,182 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#endif
+
+namespace mcp_sandtimer {
+class CancellationToken;
+}  // namespace mcp_sandtimer
+
+// TimerClient 内部使用的跨平台 socket 工具（不对外安装）
+namespace mcp_sandtimer::net {
+
+using clock = std::chrono::steady_clock;
+
+#ifdef _WIN32
+using socket_handle = SOCKET;
+constexpr socket_handle kInvalidSocket = INVALID_SOCKET;
+
+// 每次网络操作前初始化 Winsock
+struct WinsockSession {
+    WinsockSession();
+    ~WinsockSession();
+};
+#else
+using socket_handle = int;
+constexpr socket_handle kInvalidSocket = -1;
+
+// 其他平台无需初始化；用户声明的析构函数让 `WinsockSession session;` 不触发 -Wunused-variable
+struct WinsockSession {
+    WinsockSession() noexcept {}
+    ~WinsockSession() {}
+};
+#endif
+
+void close_socket(socket_handle socket);
+std::string last_error_message(const std::string& prefix);
+
+// 解析出的单个候选地址
+struct SocketAddress {
+    int family = AF_UNSPEC;
+    sockaddr_storage storage{};
+    socklen_t length = 0;
+};
+
+// DNS/地址解析，失败抛出 TimerClientError
+std::vector<SocketAddress> resolve(const std::string& host, std::uint16_t port);
+
+struct ConnectOptions {
+    int preferred_family = AF_UNSPEC;                  // 上次成功的地址族，优先尝试
+    std::chrono::milliseconds attempt_delay{250};      // RFC 8305 的 Connection Attempt Delay
+    std::chrono::milliseconds timeout{5000};           // 整个连接过程的上限
+    clock::time_point deadline = clock::time_point::max();  // 调用方的截止时间，与 timeout 取较早者
+    const CancellationToken* cancellation = nullptr;        // 被取消时放弃所有在途连接
+};
+
+struct ConnectResult {
+    socket_handle socket = kInvalidSocket;
+    int family = AF_UNSPEC;
+    std::string error;  // 全部失败时的最后一个错误
+
+    bool ok() const noexcept { return socket != kInvalidSocket; }
+};
+
+// Happy Eyeballs：按地址族交错排列候选地址，错峰发起非阻塞连接，
+// 第一个成功的连接胜出，其余全部关闭。返回的 socket 保持非阻塞模式，交给 send_all 使用。
+ConnectResult connect_happy_eyeballs(const std::vector<SocketAddress>& candidates, const ConnectOptions& options);
+
+// 在非阻塞 socket 上发送全部数据，最多等到 deadline；被取消或超时返回 false 并写入 error
+bool send_all(socket_handle socket, std::string_view message, clock::time_point deadline,
+              const CancellationToken* cancellation, std::string& error);
+
+class Poller;
+
+// 把同一条消息并发投递给多个目标：每个目标一个非阻塞 socket，在同一个 poll 循环里推进连接与发送，
+// 总耗时取决于最慢的那个被等待的目标，而不是各目标之和。目标的解析地址按顺序尝试，不做错峰竞速
+class Fanout {
+public:
+    enum class Status { Pending, Delivered, Failed, Abandoned };
+
+    struct Target {
+        std::vector<SocketAddress> addresses;
+        Status status = Status::Pending;
+        clock::duration latency{};  // 从发起连接到完成（或失败）的耗时
+        std::string error;
+        socket_handle socket = kInvalidSocket;
+        std::size_t next_address = 0;
+        std::size_t retries = 0;   // retry_stalled() 放弃并重连的次数
+        std::size_t sent = 0;
+        bool connected = false;
+    };
+
+    // 每个目标完成时调用一次（可能在另一个线程上）
+    using Completion = std::function<void(std::size_t index, const Target& target)>;
+
+    Fanout(std::string message, std::vector<std::vector<SocketAddress>> addresses, Completion on_complete);
+    Fanout(const Fanout&) = delete;
+    Fanout& operator=(const Fanout&) = delete;
+    ~Fanout();
+
+    // 在开始之前把某个目标记为失败（例如熔断打开或解析失败）
+    void fail(std::size_t index, const std::string& error);
+    // 由外部事件循环驱动时在 start() 之前调用：目标的 socket 创建后注册到 poller（token 为 token_base | 目标下标），
+    // 关闭之前注销，fd 号被复用时不会误删别人的注册
+    void attach(Poller& poller, std::uint64_t token_base);
+    // 为尚未开始的目标发起连接；与 handle() 一起供外部事件循环驱动，run() 是它们的自带循环版本
+    void start();
+    // 目标当前的 socket 就绪（revents 取 POLLOUT/POLLERR/POLLHUP）时推进它；已完成的目标忽略
+    void handle(std::size_t index, short revents);
+    // 推进在途目标，直到 satisfied() 为真、全部完成、到达 until 或被取消
+    void run(clock::time_point until, const CancellationToken* cancellation, const std::function<bool()>& satisfied);
+    // 关闭全部在途目标，记为 status
+    void abort(Status status, const std::string& error);
+    // 仍在等待连接结果的目标换新 socket 从第一个地址重连（相当于重发丢失的 SYN）；
+    // 已经开始发送的目标不受影响。返回重连的目标数
+    std::size_t retry_stalled();
+
+    std::size_t size() const noexcept { return targets_.size(); }
+    std::size_t delivered() const noexcept { return delivered_; }
+    std::size_t failed() const noexcept { return failed_; }
+    bool finished() const noexcept { return completed_ == targets_.size(); }
+    const Target& target(std::size_t index) const { return targets_[index]; }
+
+private:
+    std::string message_;
+    std::vector<Target> targets_;
+    Completion on_complete_;
+    Poller* poller_ = nullptr;
+    std::uint64_t token_base_ = 0;
+    clock::time_point started_;
+    bool launched_ = false;
+    std::size_t delivered_ = 0;
+    std::size_t failed_ = 0;
+    std::size_t completed_ = 0;
+
+    void start_connect(std::size_t index);
+    void release(Target& target);
+    void advance(std::size_t index, short revents);
+    void complete(std::size_t index, Status status, std::string error);
+};
+
+// 等待大量 socket 可写的多路复用器：Linux 上用 epoll，等待代价与注册的 socket 数量无关；
+// 其他平台退回 poll/WSAPoll。wake() 可以从任意线程打断正在进行的 wait()
+class Poller {
+public:
+    struct Event {
+        std::uint64_t token;
+        short revents;  // POLLOUT / POLLERR / POLLHUP
+    };
+
+    Poller();
+    Poller(const Poller&) = delete;
+    Poller& operator=(const Poller&) = delete;
+    ~Poller();
+
+    // 关注 socket 可写，就绪时以 token 报告
+    void add(socket_handle socket, std::uint64_t token);
+    // 注销 socket；要在关闭它之前调用
+    void remove(socket_handle socket);
+    // 最多等待 timeout，就绪事件写入 events；被 wake() 打断时 events 可能为空
+    void wait(std::vector<Event>& events, std::chrono::milliseconds timeout);
+    void wake();
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+}  // namespace mcp_sandtimer::net
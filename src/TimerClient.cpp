@@ -1,198 +1,1326 @@
 #include "mcp_sandtimer/TimerClient.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#else
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <sys/socket.h>
-#include <sys/time.h>
-#include <sys/types.h>
-#include <unistd.h>
-#include <errno.h>
-#endif
-
+#include "mcp_sandtimer/AllocationTracker.h"
+#include "mcp_sandtimer/CommandRing.h"
+#include "mcp_sandtimer/HashRing.h"
 #include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/RttEstimator.h"
+#include "Socket.h"
 
 namespace mcp_sandtimer {
-// TimerClient 负责和 sandtimer 程序的 TCP端口通信
-// 下面处理跨平台 sokect 适配
+// TimerClient 负责和 sandtimer 程序的 TCP端口通信，跨平台 socket 适配见 Socket.h
 namespace {
-#ifdef _WIN32
-struct WinsockSession {
-    WinsockSession() {
-        WSADATA data{};
-        const int result = WSAStartup(MAKEWORD(2, 2), &data);
-        if (result != 0) {
-            std::ostringstream oss;
-            oss << "WSAStartup failed with error " << result;
-            throw TimerClientError(oss.str());
+// 不设超时时，后台补发与异步投递最多持续的时间
+constexpr std::chrono::milliseconds kUnboundedSendLimit{30000};
+// 一次投递最多发起几轮连接：按往返时间估计的超时到了还没连上，多半是 SYN 丢了，
+// 换新 socket 重连一次，不必等内核 1 秒的 SYN 重传；尚未发出任何字节，重连不会重复投递
+constexpr int kConnectAttempts = 2;
+
+const char* family_name(int family) {
+    switch (family) {
+        case AF_INET:
+            return "ipv4";
+        case AF_INET6:
+            return "ipv6";
+        default:
+            return "unspecified";
+    }
+}
+}  // namespace
+
+// 端点健康状态：熔断器 + 往返时间估计 + 熔断打开期间的后台探测线程
+struct TimerClient::EndpointHealth {
+    explicit EndpointHealth(CircuitBreaker::Options options) : breaker(options) {}
+
+    ~EndpointHealth() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (prober.joinable()) {
+            prober.join();
+        }
+    }
+
+    // 连接目标端点，胜出的地址族记下来供后续调用优先使用
+    net::ConnectResult connect(const std::string& host, std::uint16_t port, milliseconds timeout,
+                               milliseconds attempt_delay, const CallOptions& call = {}) {
+        net::ConnectOptions options;
+        options.preferred_family = preferred_family.load(std::memory_order_relaxed);
+        options.attempt_delay = attempt_delay;
+        options.timeout = timeout;
+        options.deadline = call.deadline;
+        options.cancellation = call.cancellation;
+        net::ConnectResult result = net::connect_happy_eyeballs(net::resolve(host, port), options);
+        if (result.ok()) {
+            preferred_family.store(result.family, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    // 本次投递的超时：按往返时间估计并裁剪到 [floor, ceiling]；ceiling 为 0 表示不设超时
+    milliseconds attempt_timeout(milliseconds floor, milliseconds ceiling) const {
+        return ceiling.count() > 0 ? rtt.timeout(floor, ceiling) : ceiling;
+    }
+
+    // 一次投递结束时更新往返时间估计。每次超时重连都使估计退避；按 Karn 算法，
+    // 只有没重连过的投递才计样本，用满了 budget 仍失败的再退避一次
+    void record_rtt(net::Fanout::Status status, net::clock::duration latency, milliseconds budget,
+                    std::size_t retries = 0) {
+        for (std::size_t i = 0; i < retries; ++i) {
+            rtt.record_timeout();
+        }
+        if (status == net::Fanout::Status::Delivered) {
+            if (retries == 0) {
+                rtt.record_sample(latency);
+            }
+        } else if (status == net::Fanout::Status::Failed && budget.count() > 0 && latency >= budget) {
+            rtt.record_timeout();
+        }
+    }
+
+    json::Value rtt_metrics(milliseconds floor, milliseconds ceiling) const {
+        json::Value result = rtt.stats().ToJson();
+        result.as_object()["effectiveTimeoutMs"] =
+            json::Value(static_cast<double>(attempt_timeout(floor, ceiling).count()));
+        return result;
+    }
+
+    void on_failure(const std::string& host, std::uint16_t port, milliseconds timeout) {
+        if (!breaker.record_failure()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (probing || stopping) {
+            return;
+        }
+        // 上一个探测线程已置 probing=false 并释放锁，这里 join 不会阻塞太久
+        if (prober.joinable()) {
+            prober.join();
+        }
+        probing = true;
+        prober = std::thread([this, host, port, timeout] { probe_loop(host, port, timeout); });
+    }
+
+    void probe_loop(const std::string& host, std::uint16_t port, milliseconds timeout) {
+        const AllocationScope scope(AllocationTag::TimerClient);
+        const milliseconds interval = breaker.options().probe_interval;
+        const milliseconds probe_timeout = std::min(timeout, std::max(interval, milliseconds{1}));
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, interval, [this] { return stopping; });
+            if (stopping || breaker.state() != CircuitBreaker::State::Open) {
+                break;
+            }
+            lock.unlock();
+            const bool reachable = probe(host, port, probe_timeout);
+            lock.lock();
+            if (reachable) {
+                breaker.record_probe_success();
+                break;
+            }
+        }
+        probing = false;
+    }
+
+    // 仅建立连接即关闭，用于熔断期间的后台探测
+    bool probe(const std::string& host, std::uint16_t port, milliseconds timeout) {
+        try {
+            net::WinsockSession session;
+            net::ConnectResult result = connect(host, port, timeout, timeout);
+            net::close_socket(result.socket);
+            return result.ok();
+        } catch (const TimerClientError&) {
+            return false;
         }
     }
-    ~WinsockSession() { WSACleanup(); }
+
+    CircuitBreaker breaker;
+    RttEstimator rtt;
+    std::atomic<int> preferred_family{AF_UNSPEC};
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread prober;
+    bool probing = false;
+    bool stopping = false;
 };
-using socket_handle = SOCKET;
-constexpr socket_handle kInvalidSocket = INVALID_SOCKET;
-inline void close_socket(socket_handle socket) {
-    if (socket != kInvalidSocket) {
-        closesocket(socket);
+
+// 共享内存通道的生产者端：多个调用线程经 mutex 串行化，满足环的单生产者约束。
+// 无竞争时 mutex 只是一次用户态原子操作，稳态下投递不产生系统调用
+struct TimerClient::SharedMemoryChannel {
+    explicit SharedMemoryChannel(std::string path) : path(std::move(path)) {}
+
+    bool try_send(const TimerCommand& command) {
+        if (command.label.size() > CommandRing::kMaxLabelLength) {
+            fallbacks.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!ring && !open_locked()) {
+            fallbacks.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // 消费者退出后不再写入，免得命令滞留在无人读取的环里
+        if (!ring->consumer_online() || !ring->try_push(command)) {
+            fallbacks.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
     }
-}
-inline std::string last_error_message(const std::string& prefix) {
-    const int code = WSAGetLastError();
-    std::ostringstream oss;
-    oss << prefix << " (code " << code << ")";
-    return oss.str();
-}
-#else
-using socket_handle = int;
-constexpr socket_handle kInvalidSocket = -1;
-inline void close_socket(socket_handle socket) {
-    if (socket != kInvalidSocket) {
-        close(socket);
+
+    // 消费者尚未建好区域时按间隔重试，避免每次调用都去打开文件
+    bool open_locked() {
+        const auto now = std::chrono::steady_clock::now();
+        if (now < retry_at) {
+            return false;
+        }
+        try {
+            ring = std::make_unique<CommandRing>(path, CommandRing::Role::Producer);
+            return true;
+        } catch (const CommandRingError&) {
+            retry_at = now + kReopenInterval;
+            return false;
+        }
+    }
+
+    json::Value metrics() {
+        std::lock_guard<std::mutex> lock(mutex);
+        json::Value result = json::make_object({
+            {"path", json::Value(path)},
+            {"fallbacks", json::Value(static_cast<double>(fallbacks.load(std::memory_order_relaxed)))}
+        });
+        if (ring) {
+            result.as_object()["ring"] = ring->stats().ToJson();
+        }
+        return result;
+    }
+
+    static constexpr std::chrono::seconds kReopenInterval{1};
+
+    std::string path;
+    std::mutex mutex;
+    std::unique_ptr<CommandRing> ring;
+    std::chrono::steady_clock::time_point retry_at{};
+    std::atomic<std::uint64_t> fallbacks{0};
+};
+
+// 多端点模式下的一个分片：独立的熔断器与负载计数
+struct TimerClient::Shard {
+    Shard(TimerEndpoint endpoint, std::shared_ptr<EndpointHealth> health)
+        : endpoint(std::move(endpoint)), health(std::move(health)) {}
+
+    TimerEndpoint endpoint;
+    std::shared_ptr<EndpointHealth> health;
+    std::atomic<std::uint64_t> commands{0};
+    std::atomic<std::uint64_t> failures{0};
+    std::atomic<std::int64_t> in_flight{0};
+};
+
+struct TimerClient::Sharding {
+    HashRing ring;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    // 熔断打开的端点被跳过，label 顺延到环上下一个可用端点
+    Shard& route(std::string_view label) const {
+        const std::size_t index = ring.locate(label, [this](std::size_t node) {
+            return shards[node]->health->breaker.state() != CircuitBreaker::State::Open;
+        });
+        return *shards[index];
+    }
+};
+
+// 副本模式下的一个端点：独立的熔断器与投递耗时统计
+struct TimerClient::Replica {
+    Replica(TimerEndpoint endpoint, CircuitBreaker::Options options)
+        : endpoint(std::move(endpoint)), health(std::make_shared<EndpointHealth>(options)) {}
+
+    // 投递结束时由 Fanout 回调；没有真正发起连接的副本（熔断打开或无法解析）只计入 skipped
+    void record(const net::Fanout::Target& target, milliseconds timeout, milliseconds budget) {
+        if (target.next_address == 0 && target.status == net::Fanout::Status::Failed) {
+            skipped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        health->record_rtt(target.status, target.latency, budget, target.retries);
+        switch (target.status) {
+            case net::Fanout::Status::Delivered: {
+                const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(target.latency).count();
+                delivered.fetch_add(1, std::memory_order_relaxed);
+                total_latency_us.fetch_add(micros, std::memory_order_relaxed);
+                last_latency_us.store(micros, std::memory_order_relaxed);
+                std::int64_t max = max_latency_us.load(std::memory_order_relaxed);
+                while (micros > max && !max_latency_us.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+                }
+                health->breaker.record_success();
+                break;
+            }
+            case net::Fanout::Status::Abandoned:
+                abandoned.fetch_add(1, std::memory_order_relaxed);
+                health->breaker.record_abandoned();
+                break;
+            default:
+                failed.fetch_add(1, std::memory_order_relaxed);
+                health->on_failure(endpoint.host, endpoint.port, timeout);
+                break;
+        }
+    }
+
+    json::Value ToJson(milliseconds floor, milliseconds ceiling) const {
+        const auto count = delivered.load(std::memory_order_relaxed);
+        const double mean = count == 0 ? 0.0
+                                       : static_cast<double>(total_latency_us.load(std::memory_order_relaxed)) /
+                                             static_cast<double>(count) / 1000.0;
+        return json::make_object({
+            {"endpoint", json::Value(endpoint.host + ':' + std::to_string(endpoint.port))},
+            {"delivered", json::Value(static_cast<double>(count))},
+            {"failed", json::Value(static_cast<double>(failed.load(std::memory_order_relaxed)))},
+            {"abandoned", json::Value(static_cast<double>(abandoned.load(std::memory_order_relaxed)))},
+            {"skipped", json::Value(static_cast<double>(skipped.load(std::memory_order_relaxed)))},
+            {"lastLatencyMs", json::Value(static_cast<double>(last_latency_us.load(std::memory_order_relaxed)) / 1000.0)},
+            {"meanLatencyMs", json::Value(mean)},
+            {"maxLatencyMs", json::Value(static_cast<double>(max_latency_us.load(std::memory_order_relaxed)) / 1000.0)},
+            {"rtt", health->rtt_metrics(floor, ceiling)},
+            {"breaker", health->breaker.stats().ToJson()}
+        });
+    }
+
+    TimerEndpoint endpoint;
+    std::shared_ptr<EndpointHealth> health;
+    std::atomic<std::uint64_t> delivered{0};
+    std::atomic<std::uint64_t> failed{0};
+    std::atomic<std::uint64_t> abandoned{0};
+    std::atomic<std::uint64_t> skipped{0};
+    std::atomic<std::int64_t> total_latency_us{0};
+    std::atomic<std::int64_t> last_latency_us{0};
+    std::atomic<std::int64_t> max_latency_us{0};
+};
+
+// 副本集合与后台补发线程：调用按策略返回后，未完成的投递在这里继续推进
+struct TimerClient::Replication {
+    explicit Replication(ReplicationPolicy policy) : policy(policy) {}
+
+    ~Replication() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (finisher.joinable()) {
+            finisher.join();
+        }
+    }
+
+    std::size_t required() const {
+        switch (policy) {
+            case ReplicationPolicy::FirstAck:
+                return 1;
+            case ReplicationPolicy::Quorum:
+                return replicas.size() / 2 + 1;
+            case ReplicationPolicy::All:
+                break;
+        }
+        return replicas.size();
+    }
+
+    // 所有副本共用一个截止时间，取各副本估计超时中最长的，免得慢而健康的副本被提前放弃
+    milliseconds attempt_timeout(milliseconds floor, milliseconds ceiling) const {
+        milliseconds budget{0};
+        for (const auto& replica : replicas) {
+            budget = std::max(budget, replica->health->attempt_timeout(floor, ceiling));
+        }
+        return budget;
+    }
+
+    // 为一次投递建好 Fanout：熔断打开或无法解析的副本直接记为失败。
+    // owner 非空时由回调持有，供生命周期长于本次调用的异步投递使用
+    std::unique_ptr<net::Fanout> prepare(std::string message, milliseconds timeout, milliseconds budget,
+                                         std::shared_ptr<Replication> owner = nullptr) {
+        const std::size_t count = replicas.size();
+        std::vector<std::vector<net::SocketAddress>> addresses(count);
+        std::vector<std::string> unavailable(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            Replica& replica = *replicas[i];
+            if (!replica.health->breaker.allow_request()) {
+                unavailable[i] = "sandtimer at " + replica.endpoint.host + ':' + std::to_string(replica.endpoint.port) +
+                                 " is unavailable (circuit open)";
+                continue;
+            }
+            try {
+                addresses[i] = net::resolve(replica.endpoint.host, replica.endpoint.port);
+            } catch (const TimerClientError& error) {
+                unavailable[i] = error.what();
+                replica.health->on_failure(replica.endpoint.host, replica.endpoint.port, timeout);
+            }
+        }
+        auto fanout = std::make_unique<net::Fanout>(
+            std::move(message), std::move(addresses),
+            [this, owner = std::move(owner), timeout, budget](std::size_t index, const net::Fanout::Target& target) {
+                replicas[index]->record(target, timeout, budget);
+            });
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!unavailable[i].empty()) {
+                fanout->fail(i, unavailable[i]);
+            }
+        }
+        return fanout;
+    }
+
+    // 未满足策略时的错误描述，附上第一个失败副本的原因
+    std::string failure(const net::Fanout& fanout) const {
+        std::string first_error;
+        for (std::size_t i = 0; i < fanout.size() && first_error.empty(); ++i) {
+            const auto& target = fanout.target(i);
+            if (target.status != net::Fanout::Status::Pending && target.status != net::Fanout::Status::Delivered) {
+                first_error = target.error;
+            }
+        }
+        std::ostringstream oss;
+        oss << "Delivered to " << fanout.delivered() << " of " << fanout.size() << " sandtimer replicas, policy '"
+            << to_string(policy) << "' requires " << required();
+        if (!first_error.empty()) {
+            oss << " (" << first_error << ')';
+        }
+        return oss.str();
+    }
+
+    void adopt(std::shared_ptr<net::Fanout> fanout, net::clock::time_point deadline) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stragglers.emplace_back(std::move(fanout), deadline);
+            if (!finisher.joinable()) {
+                finisher = std::thread([this] { run(); });
+            }
+        }
+        wake.notify_one();
+    }
+
+    // 轮流给每个未完成的投递一小段 poll 时间，直到完成或各自超时
+    void run() {
+        const AllocationScope scope(AllocationTag::TimerClient);
+        net::WinsockSession session;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (stragglers.empty()) {
+                wake.wait(lock, [this] { return stopping || !stragglers.empty(); });
+                continue;
+            }
+            const auto batch = stragglers;
+            lock.unlock();
+            for (const auto& [fanout, deadline] : batch) {
+                const auto now = net::clock::now();
+                if (now >= deadline) {
+                    fanout->abort(net::Fanout::Status::Failed, "Timed out sending payload to sandtimer");
+                } else {
+                    fanout->run(std::min(deadline, now + kStragglerSlice), nullptr, {});
+                }
+            }
+            lock.lock();
+            stragglers.erase(std::remove_if(stragglers.begin(), stragglers.end(),
+                                            [](const auto& entry) { return entry.first->finished(); }),
+                             stragglers.end());
+        }
+    }
+
+    static constexpr std::chrono::milliseconds kStragglerSlice{20};
+
+    ReplicationPolicy policy;
+    std::vector<std::unique_ptr<Replica>> replicas;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::pair<std::shared_ptr<net::Fanout>, net::clock::time_point>> stragglers;
+    std::thread finisher;
+    bool stopping = false;
+};
+
+// 一条异步命令：Fanout 的目标是单个端点或全部副本
+struct TimerClient::AsyncJob {
+    Label label;
+    std::unique_ptr<net::Fanout> fanout;
+    std::size_t required = 1;
+    // 未满足 required 时交给调用方的错误
+    std::function<std::exception_ptr(const net::Fanout&)> failure;
+    TimerCompletion completion;
+    net::clock::time_point deadline;  // 当前一轮连接的截止时间，不晚于 limit
+    net::clock::time_point limit;     // 静态 timeout 给出的上限，从提交时算起
+    milliseconds budget{0};           // 本轮连接的自适应超时，0 表示只受 limit 约束
+    int attempts = 1;
+    bool notified = false;
+    bool failed = false;
+};
+
+// 异步命令的 I/O 线程：一个 Poller 同时推进所有在途命令的连接与发送。
+// 同一 label 同时只有一条命令在途，后到的在该 label 的 lane 里排队，保证 start/reset/cancel 不乱序；
+// 同时打开的连接数不超过常见接收端的 listen backlog，避免一次发起成千上万个连接被丢弃 SYN 后重传
+struct TimerClient::AsyncChannel {
+    explicit AsyncChannel(std::size_t capacity) : capacity(std::max<std::size_t>(1, capacity)) {}
+
+    // 停止接收新命令，等已提交的命令各自完成或超时后再退出
+    ~AsyncChannel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            if (poller) {
+                poller->wake();
+            }
+        }
+        if (worker.joinable()) {
+            worker.join();
+        }
     }
+
+    // 未完成的命令达到容量时阻塞调用方，直到 I/O 线程完成一些命令
+    void submit(std::unique_ptr<AsyncJob> job) {
+        std::unique_lock<std::mutex> lock(mutex);
+        space.wait(lock, [this] { return outstanding < capacity; });
+        if (!poller) {
+            poller = std::make_unique<net::Poller>();
+            worker = std::thread([this] { run(); });
+        }
+        ++outstanding;
+        ++submitted;
+        const bool idle = incoming.empty();
+        incoming.push_back(std::move(job));
+        // I/O 线程每轮取走全部新命令，队列非空说明唤醒已经在路上
+        if (idle) {
+            poller->wake();
+        }
+    }
+
+    // 解析结果按 host:port 缓存，投递失败时丢弃，下次重新解析
+    std::vector<net::SocketAddress> resolve(const std::string& host, std::uint16_t port) {
+        const std::string key = host + ':' + std::to_string(port);
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            const auto it = resolved.find(key);
+            if (it != resolved.end()) {
+                return it->second;
+            }
+        }
+        std::vector<net::SocketAddress> addresses = net::resolve(host, port);
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        resolved[key] = addresses;
+        return addresses;
+    }
+
+    void forget(const std::string& host, std::uint16_t port) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        resolved.erase(host + ':' + std::to_string(port));
+    }
+
+    json::Value metrics() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return json::make_object({
+            {"capacity", json::Value(static_cast<double>(capacity))},
+            {"outstanding", json::Value(static_cast<double>(outstanding))},
+            {"submitted", json::Value(static_cast<double>(submitted))},
+            {"completed", json::Value(static_cast<double>(completed))},
+            {"failed", json::Value(static_cast<double>(failed))}
+        });
+    }
+
+    using Active = std::unordered_map<std::uint64_t, std::unique_ptr<AsyncJob>>;
+
+    // 完成回调也在这个线程上执行，其中的分配同样计入 TimerClient
+    void run() {
+        const AllocationScope scope(AllocationTag::TimerClient);
+        std::vector<net::Poller::Event> events;
+        std::vector<std::unique_ptr<AsyncJob>> arrived;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping && outstanding == 0) {
+                    return;
+                }
+                arrived.swap(incoming);
+            }
+            for (auto& job : arrived) {
+                admit(std::move(job));
+            }
+            arrived.clear();
+            launch();
+            poller->wait(events, wait_timeout());
+            for (const auto& event : events) {
+                const auto it = active.find(event.token >> kIndexBits);
+                if (it != active.end()) {
+                    it->second->fanout->handle(static_cast<std::size_t>(event.token & kIndexMask), event.revents);
+                    settle(it);
+                }
+            }
+            expire();
+        }
+    }
+
+    void admit(std::unique_ptr<AsyncJob> job) {
+        const auto lane = lanes.find(job->label);
+        if (lane != lanes.end()) {
+            lane->second.push_back(std::move(job));
+            return;
+        }
+        lanes.emplace(job->label, std::deque<std::unique_ptr<AsyncJob>>{});
+        ready.push_back(std::move(job));
+    }
+
+    void launch() {
+        while (!ready.empty() && active.size() < kMaxConcurrentSends) {
+            std::unique_ptr<AsyncJob> job = std::move(ready.front());
+            ready.pop_front();
+            const std::uint64_t id = next_id++;
+            // 排队期间已经超时的命令不再发起连接，也不计入端点的熔断
+            if (net::clock::now() >= job->limit) {
+                job->fanout->abort(net::Fanout::Status::Abandoned, "Timed out waiting to send payload to sandtimer");
+            } else {
+                job->fanout->attach(*poller, id << kIndexBits);
+                job->fanout->start();
+                if (job->budget.count() > 0) {
+                    job->deadline = std::min(job->limit, net::clock::now() + job->budget);
+                }
+            }
+            deadlines.emplace(job->deadline, id);
+            settle(active.emplace(id, std::move(job)).first);
+        }
+    }
+
+    // 满足策略时通知调用方，全部目标结束后释放 lane 与队列容量
+    void settle(Active::iterator it) {
+        AsyncJob& job = *it->second;
+        const net::Fanout& fanout = *job.fanout;
+        TimerCompletion completion;
+        std::exception_ptr error;
+        if (!job.notified && (fanout.delivered() >= job.required || fanout.failed() > fanout.size() - job.required)) {
+            job.notified = true;
+            job.failed = fanout.delivered() < job.required;
+            error = job.failed ? job.failure(fanout) : nullptr;
+            completion = std::move(job.completion);
+        }
+        // 先完成记账再回调，回调里看到的 metrics 已经包含这条命令
+        if (fanout.finished()) {
+            deadlines.erase({job.deadline, it->first});
+            const auto lane = lanes.find(job.label);
+            if (lane->second.empty()) {
+                lanes.erase(lane);
+            } else {
+                ready.push_back(std::move(lane->second.front()));
+                lane->second.pop_front();
+            }
+            const bool failed_job = job.failed;
+            active.erase(it);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --outstanding;
+                ++completed;
+                failed += failed_job ? 1 : 0;
+            }
+            space.notify_all();
+        }
+        if (completion) {
+            try {
+                completion(error);
+            } catch (...) {
+                // 回调抛出的异常不能打断 I/O 线程
+            }
+        }
+    }
+
+    void expire() {
+        const auto now = net::clock::now();
+        while (!deadlines.empty() && deadlines.begin()->first <= now) {
+            const auto [deadline, id] = *deadlines.begin();
+            const auto it = active.find(id);
+            AsyncJob& job = *it->second;
+            // 自适应超时先到：还没连上的目标重连，这一轮的超时按 TCP 的方式翻倍
+            if (deadline < job.limit && job.attempts < kConnectAttempts && job.fanout->retry_stalled() > 0) {
+                ++job.attempts;
+                job.budget *= 2;
+                deadlines.erase(deadlines.begin());
+                job.deadline = std::min(job.limit, now + job.budget);
+                deadlines.emplace(job.deadline, id);
+            } else {
+                job.fanout->abort(net::Fanout::Status::Failed, "Timed out sending payload to sandtimer");
+            }
+            settle(it);
+        }
+    }
+
+    std::chrono::milliseconds wait_timeout() const {
+        constexpr std::chrono::milliseconds kIdleWait{1000};
+        if (deadlines.empty()) {
+            return kIdleWait;
+        }
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadlines.begin()->first - net::clock::now()) + std::chrono::milliseconds{1};
+        return std::clamp(remaining, std::chrono::milliseconds{0}, kIdleWait);
+    }
+
+    // Poller 的 token：高位是命令编号，低 16 位是目标下标
+    static constexpr unsigned kIndexBits = 16;
+    static constexpr std::uint64_t kIndexMask = (std::uint64_t{1} << kIndexBits) - 1;
+    static constexpr std::size_t kMaxConcurrentSends = 16;
+
+    const std::size_t capacity;
+    net::WinsockSession session;
+
+    std::mutex mutex;
+    std::condition_variable space;
+    std::vector<std::unique_ptr<AsyncJob>> incoming;
+    std::size_t outstanding = 0;  // 已提交、尚未结束的命令
+    std::uint64_t submitted = 0;
+    std::uint64_t completed = 0;
+    std::uint64_t failed = 0;
+    bool stopping = false;
+    std::unique_ptr<net::Poller> poller;
+    std::thread worker;
+
+    std::mutex cache_mutex;
+    std::unordered_map<std::string, std::vector<net::SocketAddress>> resolved;
+
+    // 以下只在 I/O 线程上访问
+    Active active;
+    std::deque<std::unique_ptr<AsyncJob>> ready;
+    std::unordered_map<Label, std::deque<std::unique_ptr<AsyncJob>>> lanes;
+    std::set<std::pair<net::clock::time_point, std::uint64_t>> deadlines;
+    std::uint64_t next_id = 0;
+};
+
+// 不可变的配置快照。发布之后只读；EndpointHealth 等共享状态自身是线程安全的
+struct TimerClient::Config {
+    std::string host;
+    std::uint16_t port = 0;
+    milliseconds timeout{5000};
+    milliseconds min_timeout{kDefaultMinTimeout};
+    milliseconds connect_attempt_delay{250};
+    CircuitBreaker::Options breaker_options;
+    WireFormat wire_format = WireFormat::Json;
+    std::shared_ptr<EndpointHealth> health;
+    std::vector<TimerEndpoint> endpoints;
+    std::shared_ptr<Sharding> sharding;
+    std::vector<TimerEndpoint> replicas;
+    ReplicationPolicy replication_policy = ReplicationPolicy::All;
+    std::shared_ptr<Replication> replication;
+    std::string shared_memory_path;
+    std::shared_ptr<SharedMemoryChannel> shared_memory;
+    std::shared_ptr<AsyncChannel> async;
+
+    // 按当前端点与熔断参数重建健康状态、分片表与副本表
+    void reset_health() {
+        health = std::make_shared<EndpointHealth>(breaker_options);
+        replication = nullptr;
+        if (!replicas.empty()) {
+            auto next = std::make_shared<Replication>(replication_policy);
+            for (const auto& endpoint : replicas) {
+                next->replicas.push_back(std::make_unique<Replica>(endpoint, breaker_options));
+            }
+            replication = std::move(next);
+        }
+        if (endpoints.empty()) {
+            sharding = nullptr;
+            return;
+        }
+        // 虚拟节点以 host:port 命名，增删端点时其他端点在环上的位置不变
+        auto next = std::make_shared<Sharding>();
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i < endpoints.size(); ++i) {
+            names.push_back(endpoints[i].host + ':' + std::to_string(endpoints[i].port));
+            next->shards.push_back(std::make_unique<Shard>(
+                endpoints[i], i == 0 ? health : std::make_shared<EndpointHealth>(breaker_options)));
+        }
+        next->ring = HashRing(names);
+        sharding = std::move(next);
+    }
+};
+
+const char* to_string(ReplicationPolicy policy) noexcept {
+    switch (policy) {
+        case ReplicationPolicy::FirstAck:
+            return "first";
+        case ReplicationPolicy::Quorum:
+            return "quorum";
+        case ReplicationPolicy::All:
+            return "all";
+    }
+    return "unknown";
 }
-inline std::string last_error_message(const std::string& prefix) {
-    std::ostringstream oss;
-    oss << prefix << ": " << std::strerror(errno);
-    return oss.str();
+
+ReplicationPolicy ParseReplicationPolicy(const std::string& text) {
+    for (ReplicationPolicy policy : {ReplicationPolicy::FirstAck, ReplicationPolicy::Quorum, ReplicationPolicy::All}) {
+        if (text == to_string(policy)) {
+            return policy;
+        }
+    }
+    throw std::invalid_argument("Unknown replication policy: " + text);
 }
-#endif
-}  // namespace
 
 TimerClientError::TimerClientError(const std::string& message) : std::runtime_error(message) {}
 
+CircuitOpenError::CircuitOpenError(const std::string& message) : TimerClientError(message) {}
+
+RequestCancelledError::RequestCancelledError(const std::string& message) : TimerClientError(message) {}
+
+DeadlineExceededError::DeadlineExceededError(const std::string& message) : TimerClientError(message) {}
+
 TimerClient::TimerClient() : TimerClient("127.0.0.1", 61420) {}
 
-TimerClient::TimerClient(std::string host, std::uint16_t port, milliseconds timeout)
-    : host_(std::move(host)), port_(port), timeout_(timeout) {}
+TimerClient::TimerClient(std::string host, std::uint16_t port, milliseconds timeout) {
+    auto config = std::make_shared<Config>();
+    config->host = std::move(host);
+    config->port = port;
+    config->timeout = timeout;
+    config->async = std::make_shared<AsyncChannel>(kDefaultAsyncQueueCapacity);
+    config->reset_health();
+    publish(std::move(config));
+}
+
+TimerClient::TimerClient(const TimerClient& other) : config_(other.snapshot()) {}
 
-void TimerClient::start_timer(const std::string& label, int seconds) const {
-    json::Value payload = json::make_object({
-        {"cmd", json::Value("start")},
-        {"label", json::Value(label.c_str())},
-        {"time", json::Value(seconds)}
+TimerClient& TimerClient::operator=(const TimerClient& other) {
+    if (this != &other) {
+        std::shared_ptr<const Config> config = other.snapshot();
+        std::lock_guard<std::mutex> lock(update_mutex_);
+        std::atomic_store(&config_, std::move(config));
+    }
+    return *this;
+}
+
+TimerClient::~TimerClient() = default;
+
+// 持有返回的快照期间，它引用的 Config 不会因并发的 setter 而释放。
+// libstdc++ 的 atomic_load 在按地址散列的自旋锁里复制 shared_ptr，只覆盖这一次复制
+std::shared_ptr<const TimerClient::Config> TimerClient::snapshot() const {
+    return std::atomic_load(&config_);
+}
+
+void TimerClient::publish(std::shared_ptr<Config> config) {
+    std::atomic_store(&config_, std::shared_ptr<const Config>(std::move(config)));
+}
+
+// 复制当前快照，修改后整体替换；正在进行的调用继续使用旧快照
+template <typename Mutate>
+void TimerClient::update(Mutate&& mutate) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    auto config = std::make_shared<Config>(*std::atomic_load(&config_));
+    mutate(*config);
+    publish(std::move(config));
+}
+
+std::string TimerClient::host() const {
+    return snapshot()->host;
+}
+
+std::uint16_t TimerClient::port() const {
+    return snapshot()->port;
+}
+
+TimerClient::milliseconds TimerClient::timeout() const {
+    return snapshot()->timeout;
+}
+
+TimerClient::milliseconds TimerClient::min_timeout() const {
+    return snapshot()->min_timeout;
+}
+
+TimerClient::milliseconds TimerClient::connect_attempt_delay() const {
+    return snapshot()->connect_attempt_delay;
+}
+
+CircuitBreaker::Options TimerClient::breaker_options() const {
+    return snapshot()->breaker_options;
+}
+
+WireFormat TimerClient::wire_format() const {
+    return snapshot()->wire_format;
+}
+
+std::vector<TimerEndpoint> TimerClient::endpoints() const {
+    return snapshot()->endpoints;
+}
+
+std::vector<TimerEndpoint> TimerClient::replicas() const {
+    return snapshot()->replicas;
+}
+
+ReplicationPolicy TimerClient::replication_policy() const {
+    return snapshot()->replication_policy;
+}
+
+std::string TimerClient::shared_memory_path() const {
+    return snapshot()->shared_memory_path;
+}
+
+std::size_t TimerClient::async_queue_capacity() const {
+    return snapshot()->async->capacity;
+}
+
+void TimerClient::set_host(std::string host) {
+    update([&](Config& config) {
+        config.host = std::move(host);
+        config.endpoints.clear();
+        config.replicas.clear();
+        config.reset_health();
     });
-    send_payload(payload);
 }
 
-void TimerClient::reset_timer(const std::string& label) const {
-    json::Value payload = json::make_object({
-        {"cmd", json::Value("reset")},
-        {"label", json::Value(label.c_str())}
+void TimerClient::set_port(std::uint16_t port) {
+    update([&](Config& config) {
+        config.port = port;
+        config.endpoints.clear();
+        config.replicas.clear();
+        config.reset_health();
+    });
+}
+
+void TimerClient::set_endpoints(std::vector<TimerEndpoint> endpoints) {
+    update([&](Config& config) {
+        if (!endpoints.empty()) {
+            config.host = endpoints.front().host;
+            config.port = endpoints.front().port;
+        }
+        config.endpoints = endpoints.size() >= 2 ? std::move(endpoints) : std::vector<TimerEndpoint>{};
+        config.replicas.clear();
+        config.reset_health();
     });
-    send_payload(payload);
+}
+
+void TimerClient::set_replicas(std::vector<TimerEndpoint> replicas, ReplicationPolicy policy) {
+    update([&](Config& config) {
+        config.replicas = std::move(replicas);
+        config.replication_policy = policy;
+        config.endpoints.clear();
+        config.reset_health();
+    });
+}
+
+void TimerClient::set_timeout(milliseconds timeout) {
+    update([&](Config& config) { config.timeout = timeout; });
+}
+
+void TimerClient::set_min_timeout(milliseconds timeout) {
+    update([&](Config& config) { config.min_timeout = timeout; });
+}
+
+void TimerClient::set_connect_attempt_delay(milliseconds delay) {
+    update([&](Config& config) { config.connect_attempt_delay = delay; });
+}
+
+void TimerClient::set_breaker_options(CircuitBreaker::Options options) {
+    update([&](Config& config) {
+        config.breaker_options = options;
+        config.reset_health();
+    });
+}
+
+void TimerClient::set_wire_format(WireFormat format) {
+    update([&](Config& config) { config.wire_format = format; });
+}
+
+void TimerClient::set_shared_memory_path(std::string path) {
+    update([&](Config& config) {
+        config.shared_memory_path = std::move(path);
+        config.shared_memory = config.shared_memory_path.empty()
+                                   ? nullptr
+                                   : std::make_shared<SharedMemoryChannel>(config.shared_memory_path);
+    });
+}
+
+void TimerClient::set_async_queue_capacity(std::size_t capacity) {
+    update([&](Config& config) { config.async = std::make_shared<AsyncChannel>(capacity); });
+}
+
+void TimerClient::start_timer(const std::string& label, int seconds) const {
+    send(TimerCommand{TimerOp::Start, label, seconds});
+}
+
+void TimerClient::reset_timer(const std::string& label) const {
+    send(TimerCommand{TimerOp::Reset, label, 0});
 }
 
 void TimerClient::cancel_timer(const std::string& label) const {
-    json::Value payload = json::make_object({
-        {"cmd", json::Value("cancel")},
-        {"label", json::Value(label.c_str())}
+    send(TimerCommand{TimerOp::Cancel, label, 0});
+}
+
+void TimerClient::send(const TimerCommand& command) const {
+    send(command, CallOptions{});
+}
+
+void TimerClient::send(const TimerCommand& command, const CallOptions& options) const {
+    const AllocationScope scope(AllocationTag::TimerClient);
+    // 整个调用使用同一份快照，并发的 setter 不会让它看到一半新一半旧的配置
+    const std::shared_ptr<const Config> config = snapshot();
+    if (config->shared_memory && (options.cancellation == nullptr || !options.cancellation->cancelled()) &&
+        config->shared_memory->try_send(command)) {
+        return;
+    }
+    // 直接编码到栈上的缓冲区，不构造 json::Value
+    EncodedCommand encoded;
+    EncodeCommand(command, config->wire_format, encoded);
+    if (config->replication) {
+        send_replicated(*config, encoded.view(), options);
+        return;
+    }
+    if (!config->sharding) {
+        send_payload(*config, encoded.view(), options, config->host, config->port, *config->health);
+        return;
+    }
+    Shard& shard = config->sharding->route(command.label);
+    shard.commands.fetch_add(1, std::memory_order_relaxed);
+    shard.in_flight.fetch_add(1, std::memory_order_relaxed);
+    try {
+        send_payload(*config, encoded.view(), options, shard.endpoint.host, shard.endpoint.port, *shard.health);
+    } catch (const RequestCancelledError&) {
+        // 调用方放弃的发送与熔断器一样不算端点故障
+        shard.in_flight.fetch_sub(1, std::memory_order_relaxed);
+        throw;
+    } catch (const DeadlineExceededError&) {
+        shard.in_flight.fetch_sub(1, std::memory_order_relaxed);
+        throw;
+    } catch (const TimerClientError&) {
+        shard.in_flight.fetch_sub(1, std::memory_order_relaxed);
+        shard.failures.fetch_add(1, std::memory_order_relaxed);
+        throw;
+    }
+    shard.in_flight.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::future<void> TimerClient::start_timer_async(const std::string& label, int seconds) const {
+    return send_async(TimerCommand{TimerOp::Start, label, seconds});
+}
+
+std::future<void> TimerClient::reset_timer_async(const std::string& label) const {
+    return send_async(TimerCommand{TimerOp::Reset, label, 0});
+}
+
+std::future<void> TimerClient::cancel_timer_async(const std::string& label) const {
+    return send_async(TimerCommand{TimerOp::Cancel, label, 0});
+}
+
+std::future<void> TimerClient::send_async(const TimerCommand& command) const {
+    const AllocationScope scope(AllocationTag::TimerClient);
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> future = promise->get_future();
+    send_async(command, [promise](std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value();
+        }
+    });
+    return future;
+}
+
+void TimerClient::start_timer_async(const std::string& label, int seconds, TimerCompletion completion) const {
+    send_async(TimerCommand{TimerOp::Start, label, seconds}, std::move(completion));
+}
+
+void TimerClient::reset_timer_async(const std::string& label, TimerCompletion completion) const {
+    send_async(TimerCommand{TimerOp::Reset, label, 0}, std::move(completion));
+}
+
+void TimerClient::cancel_timer_async(const std::string& label, TimerCompletion completion) const {
+    send_async(TimerCommand{TimerOp::Cancel, label, 0}, std::move(completion));
+}
+
+// 编码、熔断检查与地址解析在调用线程上完成，连接与发送交给 I/O 线程
+void TimerClient::send_async(const TimerCommand& command, TimerCompletion completion) const {
+    const AllocationScope scope(AllocationTag::TimerClient);
+    const std::shared_ptr<const Config> config = snapshot();
+    if (config->shared_memory && config->shared_memory->try_send(command)) {
+        completion(nullptr);
+        return;
+    }
+    EncodedCommand encoded;
+    EncodeCommand(command, config->wire_format, encoded);
+    auto job = std::make_unique<AsyncJob>();
+    job->label = command.label;
+    job->limit = net::clock::now() + (config->timeout.count() > 0 ? config->timeout : kUnboundedSendLimit);
+    job->deadline = job->limit;
+    const milliseconds timeout = config->timeout;
+
+    if (config->replication) {
+        const std::shared_ptr<Replication> replication = config->replication;
+        job->budget = replication->attempt_timeout(config->min_timeout, timeout);
+        job->fanout = replication->prepare(std::string(encoded.view()), timeout, job->budget, replication);
+        job->required = replication->required();
+        job->failure = [replication](const net::Fanout& fanout) {
+            return std::make_exception_ptr(TimerClientError(replication->failure(fanout)));
+        };
+    } else {
+        // 回调持有分片表与健康状态，reset_health 之后在途命令仍能安全记账
+        const std::shared_ptr<Sharding> sharding = config->sharding;
+        Shard* shard = sharding ? &sharding->route(command.label) : nullptr;
+        const std::shared_ptr<EndpointHealth> health = shard ? shard->health : config->health;
+        const std::string host = shard ? shard->endpoint.host : config->host;
+        const std::uint16_t port = shard ? shard->endpoint.port : config->port;
+        if (shard) {
+            shard->commands.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!health->breaker.allow_request()) {
+            if (shard) {
+                shard->failures.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::ostringstream oss;
+            oss << "sandtimer at " << host << ':' << port << " is unavailable (circuit open)";
+            completion(std::make_exception_ptr(CircuitOpenError(oss.str())));
+            return;
+        }
+        std::vector<net::SocketAddress> addresses;
+        try {
+            addresses = config->async->resolve(host, port);
+        } catch (const TimerClientError&) {
+            if (shard) {
+                shard->failures.fetch_add(1, std::memory_order_relaxed);
+            }
+            health->on_failure(host, port, timeout);
+            completion(std::current_exception());
+            return;
+        }
+        // 异步投递逐个尝试地址，上次成功的地址族排在前面
+        const int preferred = health->preferred_family.load(std::memory_order_relaxed);
+        std::stable_partition(addresses.begin(), addresses.end(),
+                              [preferred](const net::SocketAddress& address) { return address.family == preferred; });
+        if (shard) {
+            shard->in_flight.fetch_add(1, std::memory_order_relaxed);
+        }
+        const milliseconds budget = health->attempt_timeout(config->min_timeout, timeout);
+        job->budget = budget;
+        std::vector<std::vector<net::SocketAddress>> targets;
+        targets.push_back(std::move(addresses));
+        AsyncChannel* channel = config->async.get();
+        job->fanout = std::make_unique<net::Fanout>(
+            std::string(encoded.view()), std::move(targets),
+            [sharding, shard, health, host, port, timeout, budget, channel](std::size_t,
+                                                                           const net::Fanout::Target& target) {
+                if (shard) {
+                    shard->in_flight.fetch_sub(1, std::memory_order_relaxed);
+                }
+                health->record_rtt(target.status, target.latency, budget, target.retries);
+                switch (target.status) {
+                    case net::Fanout::Status::Delivered:
+                        health->preferred_family.store(target.addresses[target.next_address - 1].family,
+                                                       std::memory_order_relaxed);
+                        health->breaker.record_success();
+                        break;
+                    case net::Fanout::Status::Abandoned:
+                        health->breaker.record_abandoned();
+                        break;
+                    default:
+                        if (shard) {
+                            shard->failures.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        channel->forget(host, port);
+                        health->on_failure(host, port, timeout);
+                        break;
+                }
+            });
+        job->failure = [](const net::Fanout& fanout) {
+            const std::string& error = fanout.target(0).error;
+            return std::make_exception_ptr(
+                TimerClientError(error.empty() ? "Unable to deliver payload to sandtimer" : error));
+        };
+    }
+    job->completion = std::move(completion);
+    config->async->submit(std::move(job));
+}
+
+CircuitBreaker::State TimerClient::breaker_state() const {
+    return snapshot()->health->breaker.state();
+}
+
+json::Value TimerClient::metrics() const {
+    const std::shared_ptr<const Config> config = snapshot();
+    std::ostringstream endpoint;
+    endpoint << config->host << ':' << config->port;
+    const int family = config->health->preferred_family.load(std::memory_order_relaxed);
+    json::Value metrics = json::make_object({
+        {"endpoint", json::Value(endpoint.str())},
+        {"preferredFamily", json::Value(family_name(family))},
+        {"wireFormat", json::Value(to_string(config->wire_format))},
+        {"timeoutMs", json::Value(static_cast<double>(config->timeout.count()))},
+        {"minTimeoutMs", json::Value(static_cast<double>(config->min_timeout.count()))},
+        {"rtt", config->health->rtt_metrics(config->min_timeout, config->timeout)},
+        {"breaker", config->health->breaker.stats().ToJson()}
     });
-    send_payload(payload);
+    if (config->shared_memory) {
+        metrics.as_object()["sharedMemory"] = config->shared_memory->metrics();
+    }
+    metrics.as_object()["async"] = config->async->metrics();
+    if (config->replication) {
+        json::Value::Array replicas;
+        for (const auto& replica : config->replication->replicas) {
+            replicas.push_back(replica->ToJson(config->min_timeout, config->timeout));
+        }
+        metrics.as_object()["replicationPolicy"] = json::Value(to_string(config->replication->policy));
+        metrics.as_object()["replicas"] = json::Value(std::move(replicas));
+    }
+    if (config->sharding) {
+        const std::vector<double> shares = config->sharding->ring.ownership();
+        json::Value::Array shards;
+        for (std::size_t i = 0; i < config->sharding->shards.size(); ++i) {
+            const Shard& shard = *config->sharding->shards[i];
+            shards.push_back(json::make_object({
+                {"endpoint", json::Value(shard.endpoint.host + ':' + std::to_string(shard.endpoint.port))},
+                {"share", json::Value(shares[i])},
+                {"commands", json::Value(static_cast<double>(shard.commands.load(std::memory_order_relaxed)))},
+                {"failures", json::Value(static_cast<double>(shard.failures.load(std::memory_order_relaxed)))},
+                {"inFlight", json::Value(static_cast<double>(shard.in_flight.load(std::memory_order_relaxed)))},
+                {"rtt", shard.health->rtt_metrics(config->min_timeout, config->timeout)},
+                {"breaker", shard.health->breaker.stats().ToJson()}
+            }));
+        }
+        metrics.as_object()["shards"] = json::Value(std::move(shards));
+    }
+    return metrics;
 }
+
 // 发送消息给sandtimer，每次都建立新连接，发送完毕后关闭连接，所以接收端不readAll就能拿到完整消息。
-void TimerClient::send_payload(const json::Value& payload) const {
-    const std::string message = payload.dump();
-
-#ifdef _WIN32
-    WinsockSession session;
-#endif
-
-    struct AddrInfoDeleter {
-        void operator()(addrinfo* ptr) const { if (ptr) { freeaddrinfo(ptr); } }
-    };
-
-    addrinfo hints{};
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_protocol = IPPROTO_TCP;
-
-    std::unique_ptr<addrinfo, AddrInfoDeleter> info;
-    std::string port_string = std::to_string(port_);
-
-    addrinfo* raw_info = nullptr;
-    // DNS/地址解析
-    int status = getaddrinfo(host_.c_str(), port_string.c_str(), &hints, &raw_info);
-    if (status != 0) {
-#ifdef _WIN32
+void TimerClient::send_payload(const Config& config, std::string_view message, const CallOptions& options,
+                               const std::string& host, std::uint16_t port, EndpointHealth& health) {
+    using clock = std::chrono::steady_clock;
+    if (options.cancellation != nullptr && options.cancellation->cancelled()) {
+        throw RequestCancelledError("Request was cancelled before contacting sandtimer");
+    }
+    if (clock::now() >= options.deadline) {
+        throw DeadlineExceededError("Request deadline expired before contacting sandtimer");
+    }
+    // 熔断打开时直接失败，不做解析和连接
+    if (!health.breaker.allow_request()) {
         std::ostringstream oss;
-        oss << "getaddrinfo failed with error " << status;
-        throw TimerClientError(oss.str());
-#else
-        throw TimerClientError(std::string("getaddrinfo failed: ") + gai_strerror(status));
-#endif
+        oss << "sandtimer at " << host << ':' << port << " is unavailable (circuit open)";
+        throw CircuitOpenError(oss.str());
     }
-    info.reset(raw_info);
 
-    bool sent = false;
+    net::WinsockSession session;
+
+    // 并发竞速连接所有解析到的地址（Happy Eyeballs），连上后在截止时间内发送全部字节。
+    // 每轮连接与发送的截止时间按往返时间估计，静态的 timeout 只限制整次调用
+    const auto limit = std::min(
+        config.timeout.count() > 0 ? clock::now() + config.timeout : clock::time_point::max(), options.deadline);
+    const CallOptions bounded{limit, options.cancellation};
+    milliseconds budget = health.attempt_timeout(config.min_timeout, config.timeout);
+    clock::time_point start;
+    std::size_t retries = 0;
     std::string error_message;
-    // 遍历所有解析到的地址，尝试连接。连接后分块发送数据，直到所有字节发送完毕。
-    for (addrinfo* entry = info.get(); entry != nullptr; entry = entry->ai_next) {
-        socket_handle socket = ::socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
-        if (socket == kInvalidSocket) {
-            error_message = last_error_message("Failed to create socket");
-            continue;
-        }
-
-#ifdef _WIN32
-        DWORD timeout_ms = static_cast<DWORD>(timeout_.count());
-        setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout_ms), sizeof(timeout_ms));
-        setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout_ms), sizeof(timeout_ms));
-#else
-        struct timeval tv;
-        tv.tv_sec = static_cast<long>(timeout_.count() / 1000);
-        tv.tv_usec = static_cast<long>((timeout_.count() % 1000) * 1000);
-        setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-#endif
-
-        if (::connect(socket, entry->ai_addr, static_cast<int>(entry->ai_addrlen)) != 0) {
-            error_message = last_error_message("Failed to connect to sandtimer");
-            close_socket(socket);
-            continue;
-        }
-
-        const char* data = message.data();
-        std::size_t remaining = message.size();
-        while (remaining > 0) {
-            int chunk = ::send(socket, data, static_cast<int>(remaining), 0);
-#ifdef _WIN32
-            if (chunk == SOCKET_ERROR) {
-                error_message = last_error_message("Failed to send payload");
-                break;
+    try {
+        for (;;) {
+            start = clock::now();
+            const auto deadline = std::min(budget.count() > 0 ? start + budget : clock::time_point::max(), limit);
+            net::ConnectResult connection = health.connect(host, port, budget, config.connect_attempt_delay, bounded);
+            if (connection.ok()) {
+                const bool sent =
+                    net::send_all(connection.socket, message, deadline, options.cancellation, error_message);
+                net::close_socket(connection.socket);
+                if (sent) {
+                    health.record_rtt(net::Fanout::Status::Delivered, clock::now() - start, budget, retries);
+                    health.breaker.record_success();
+                    return;
+                }
+                break;  // 已经开始发送，不能重连
             }
-#else
-            if (chunk < 0) {
-                error_message = last_error_message("Failed to send payload");
+            error_message = connection.error;
+            const auto now = clock::now();
+            if (budget.count() == 0 || now - start < budget || now >= limit ||
+                static_cast<int>(retries) + 1 >= kConnectAttempts ||
+                (options.cancellation != nullptr && options.cancellation->cancelled())) {
                 break;
             }
-#endif
-            data += chunk;
-            remaining -= static_cast<std::size_t>(chunk);
+            ++retries;
+            budget *= 2;
         }
+    } catch (const TimerClientError&) {
+        health.on_failure(host, port, config.timeout);
+        throw;
+    }
 
-        close_socket(socket);
+    // 调用方取消或自身截止时间先到，不代表端点故障，不计入熔断
+    if (options.cancellation != nullptr && options.cancellation->cancelled()) {
+        health.breaker.record_abandoned();
+        throw RequestCancelledError(error_message);
+    }
+    if (options.deadline != clock::time_point::max() && clock::now() >= options.deadline) {
+        health.breaker.record_abandoned();
+        throw DeadlineExceededError(error_message);
+    }
+    health.record_rtt(net::Fanout::Status::Failed, clock::now() - start, budget, retries);
+    health.on_failure(host, port, config.timeout);
+    if (error_message.empty()) {
+        error_message = "Unable to deliver payload to sandtimer";
+    }
+    throw TimerClientError(error_message);
+}
 
-        if (remaining == 0) {
-            sent = true;
+// 所有副本在同一个 poll 循环里并发连接与发送，满足策略即返回，耗时取决于第 required 快的副本
+void TimerClient::send_replicated(const Config& config, std::string_view message, const CallOptions& options) {
+    using clock = std::chrono::steady_clock;
+    if (options.cancellation != nullptr && options.cancellation->cancelled()) {
+        throw RequestCancelledError("Request was cancelled before contacting sandtimer");
+    }
+    const auto start = clock::now();
+    if (start >= options.deadline) {
+        throw DeadlineExceededError("Request deadline expired before contacting sandtimer");
+    }
+    // 局部持有，后台线程与回调引用的副本在本次调用期间不会被 reset_health 释放
+    const std::shared_ptr<Replication> replication = config.replication;
+    const std::size_t count = replication->replicas.size();
+
+    net::WinsockSession session;
+    milliseconds budget = replication->attempt_timeout(config.min_timeout, config.timeout);
+    const std::shared_ptr<net::Fanout> fanout = replication->prepare(std::string(message), config.timeout, budget);
+
+    const std::size_t required = replication->required();
+    const auto limit =
+        std::min(config.timeout.count() > 0 ? start + config.timeout : clock::time_point::max(), options.deadline);
+    const auto straggler_deadline = start + (config.timeout.count() > 0 ? config.timeout : kUnboundedSendLimit);
+    auto deadline = std::min(budget.count() > 0 ? start + budget : clock::time_point::max(), limit);
+    for (int attempt = 1;; ++attempt) {
+        fanout->run(deadline, options.cancellation,
+                    [&] { return fanout->delivered() >= required || fanout->failed() > count - required; });
+        const auto now = clock::now();
+        if (fanout->finished() || fanout->delivered() >= required || fanout->failed() > count - required ||
+            now < deadline || now >= limit || attempt >= kConnectAttempts) {
             break;
         }
+        // 自适应超时先到：还没连上的副本重连，这一轮的超时翻倍
+        if (fanout->retry_stalled() == 0) {
+            break;
+        }
+        budget *= 2;
+        deadline = std::min(now + budget, limit);
     }
-
-    if (!sent) {
-        if (error_message.empty()) {
-            error_message = "Unable to deliver payload to sandtimer";
+    if (fanout->delivered() >= required) {
+        if (!fanout->finished()) {
+            replication->adopt(fanout, straggler_deadline);
         }
-        throw TimerClientError(error_message);
+        return;
+    }
+
+    // 调用方取消或自身截止时间先到，不代表端点故障，不计入熔断
+    if (options.cancellation != nullptr && options.cancellation->cancelled()) {
+        fanout->abort(net::Fanout::Status::Abandoned, "Sending to sandtimer was cancelled");
+        throw RequestCancelledError("Replicated send was cancelled");
+    }
+    const auto now = clock::now();
+    if (!fanout->finished() && options.deadline != clock::time_point::max() && now >= options.deadline) {
+        fanout->abort(net::Fanout::Status::Abandoned, "Request deadline exceeded");
+        throw DeadlineExceededError("Request deadline expired while replicating to sandtimer");
+    }
+    if (!fanout->finished() && now >= deadline) {
+        fanout->abort(net::Fanout::Status::Failed, "Timed out sending payload to sandtimer");
+    } else if (!fanout->finished()) {
+        // 策略已无法满足，其余副本仍然补发，保持各显示端一致
+        replication->adopt(fanout, straggler_deadline);
     }
+    throw TimerClientError(replication->failure(*fanout));
 }
 
 }  // namespace mcp_sandtimer
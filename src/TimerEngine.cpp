@@ -0,0 +1,189 @@
+#include "mcp_sandtimer/TimerEngine.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <utility>
+
+namespace mcp_sandtimer {
+
+std::string FormatTimestamp(TimerEngine::wall_clock::time_point time) {
+    const auto millis =
+        std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+    const std::time_t seconds = static_cast<std::time_t>(millis / 1000);
+    std::tm parts{};
+#ifdef _WIN32
+    gmtime_s(&parts, &seconds);
+#else
+    gmtime_r(&seconds, &parts);
+#endif
+    char buffer[40];
+    const std::size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &parts);
+    std::snprintf(buffer + length, sizeof(buffer) - length, ".%03dZ", static_cast<int>(millis % 1000));
+    return buffer;
+}
+
+json::Value TimerEngine::Timer::ToJson() const {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(expires_at - wall_clock::now());
+    return json::make_object({
+        {"label", json::Value(label.view())},
+        {"state", json::Value(expired ? "expired" : "running")},
+        {"durationSeconds", json::Value(seconds)},
+        {"startedAt", json::Value(FormatTimestamp(started_at))},
+        {"expiresAt", json::Value(FormatTimestamp(expires_at))},
+        {"remainingSeconds", json::Value(expired ? 0.0 : std::max(0.0, remaining.count() / 1000.0))}
+    });
+}
+
+json::Value TimerEngine::Stats::ToJson() const {
+    return json::make_object({
+        {"running", json::Value(static_cast<double>(running))},
+        {"expired", json::Value(static_cast<double>(expired))},
+        {"fired", json::Value(static_cast<double>(fired))}
+    });
+}
+
+TimerEngine::TimerEngine(ExpiredCallback on_expired) : on_expired_(std::move(on_expired)) {}
+
+TimerEngine::~TimerEngine() {
+    stop();
+}
+
+void TimerEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable() && worker_.get_id() != std::this_thread::get_id()) {
+        worker_.join();
+    }
+}
+
+void TimerEngine::apply(const TimerCommand& command) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return;
+    }
+    auto iter = entries_.find(command.label);
+    switch (command.op) {
+        case TimerOp::Start: {
+            if (iter == entries_.end()) {
+                iter = entries_.try_emplace(command.label).first;
+                iter->second.timer.label = command.label;
+            }
+            iter->second.timer.seconds = command.seconds;
+            schedule_locked(iter->second);
+            break;
+        }
+        case TimerOp::Reset:
+            if (iter != entries_.end()) {
+                schedule_locked(iter->second);
+            }
+            break;
+        case TimerOp::Cancel:
+            if (iter != entries_.end()) {
+                entries_.erase(iter);
+            }
+            break;
+    }
+}
+
+// 从现在起按 timer.seconds 重新计时；旧的堆项因 generation 变化而失效
+void TimerEngine::schedule_locked(Entry& entry) {
+    const auto duration = std::chrono::seconds(std::max(entry.timer.seconds, 0));
+    entry.timer.started_at = wall_clock::now();
+    entry.timer.expires_at = entry.timer.started_at + duration;
+    entry.timer.expired = false;
+    entry.deadline = clock::now() + duration;
+    entry.generation = next_generation_++;
+    due_.push(Due{entry.deadline, entry.generation, entry.timer.label});
+    if (!worker_.joinable()) {
+        worker_ = std::thread([this] { run(); });
+    }
+    wake_.notify_one();
+}
+
+std::optional<TimerEngine::Timer> TimerEngine::find(std::string_view label) const {
+    // 只查不驻留：查询从未启动过的 label 不会让驻留表增长
+    LabelTable::Id id = 0;
+    if (!LabelTable::global().find(label, id)) {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = entries_.find(Label::from_id(id));
+    if (iter == entries_.end()) {
+        return std::nullopt;
+    }
+    return iter->second.timer;
+}
+
+std::vector<TimerEngine::Timer> TimerEngine::timers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Timer> result;
+    result.reserve(entries_.size());
+    for (const auto& [label, entry] : entries_) {
+        result.push_back(entry.timer);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const Timer& a, const Timer& b) { return a.label.view() < b.label.view(); });
+    return result;
+}
+
+TimerEngine::Stats TimerEngine::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    for (const auto& [label, entry] : entries_) {
+        ++(entry.timer.expired ? stats.expired : stats.running);
+    }
+    stats.fired = fired_;
+    return stats;
+}
+
+void TimerEngine::evict_expired_locked() {
+    std::size_t expired = 0;
+    auto oldest = entries_.end();
+    for (auto iter = entries_.begin(); iter != entries_.end(); ++iter) {
+        if (!iter->second.timer.expired) {
+            continue;
+        }
+        ++expired;
+        if (oldest == entries_.end() || iter->second.deadline < oldest->second.deadline) {
+            oldest = iter;
+        }
+    }
+    if (expired > kMaxExpired) {
+        entries_.erase(oldest);
+    }
+}
+
+void TimerEngine::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (due_.empty()) {
+            wake_.wait(lock, [this] { return stopping_ || !due_.empty(); });
+            continue;
+        }
+        const clock::time_point deadline = due_.top().deadline;
+        if (clock::now() < deadline) {
+            wake_.wait_until(lock, deadline);
+            continue;
+        }
+        Due due = due_.top();
+        due_.pop();
+        auto iter = entries_.find(due.label);
+        if (iter == entries_.end() || iter->second.generation != due.generation) {
+            continue;
+        }
+        iter->second.timer.expired = true;
+        const Timer fired = iter->second.timer;
+        ++fired_;
+        evict_expired_locked();
+
+        lock.unlock();
+        on_expired_(fired);
+        lock.lock();
+    }
+}
+
+}  // namespace mcp_sandtimer
@@ -78,4 +78,13 @@ const std::vector<ToolDefinition>& GetToolDefinitions() {
     return kDefinitions;
 }
 
+const ToolDefinition* FindToolDefinition(const std::string& name) {
+    for (const auto& definition : GetToolDefinitions()) {
+        if (definition.name == name) {
+            return &definition;
+        }
+    }
+    return nullptr;
+}
+
 }  // namespace mcp_sandtimer
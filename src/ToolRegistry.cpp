@@ -0,0 +1,101 @@
+#include "mcp_sandtimer/ToolRegistry.h"
+
+#include <utility>
+
+namespace mcp_sandtimer {
+namespace {
+const std::string& method_name(const ToolRegistry::MethodEntry& entry) { return entry.name; }
+const std::string& tool_name(const ToolRegistry::ToolEntry& entry) { return entry.definition.name; }
+}  // namespace
+
+// FNV-1a 64 位
+std::uint64_t ToolRegistry::hash_name(std::string_view name) noexcept {
+    std::uint64_t hash = 1469598103934665603ull;
+    for (char ch : name) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+template <typename Entry, typename NameFn>
+std::uint32_t ToolRegistry::lookup(const Table<Entry>& table, std::string_view name, NameFn&& name_of) {
+    if (table.slots.empty()) {
+        return kEmpty;
+    }
+    const std::uint64_t hash = hash_name(name);
+    const std::size_t mask = table.slots.size() - 1;
+    // 线性探测；装载因子不超过 1/2，探测链很短
+    for (std::size_t i = static_cast<std::size_t>(hash) & mask;; i = (i + 1) & mask) {
+        const Slot& slot = table.slots[i];
+        if (slot.index == kEmpty) {
+            return kEmpty;
+        }
+        if (slot.hash == hash && name_of(table.entries[slot.index]) == name) {
+            return slot.index;
+        }
+    }
+}
+
+template <typename Entry, typename NameFn>
+void ToolRegistry::insert(Table<Entry>& table, Entry entry, NameFn&& name_of) {
+    const std::uint32_t existing = lookup(table, name_of(entry), name_of);
+    if (existing != kEmpty) {
+        table.entries[existing] = std::move(entry);
+        return;
+    }
+    table.entries.push_back(std::move(entry));
+
+    // 保持槽位数为 2 的幂且至少为条目数的两倍，超出时整体重建
+    std::size_t capacity = table.slots.empty() ? 16 : table.slots.size();
+    while (capacity < table.entries.size() * 2) {
+        capacity *= 2;
+    }
+    const bool rebuild = capacity != table.slots.size();
+    if (rebuild) {
+        table.slots.assign(capacity, Slot{});
+    }
+    const std::size_t mask = capacity - 1;
+    const std::size_t first = rebuild ? 0 : table.entries.size() - 1;
+    for (std::size_t index = first; index < table.entries.size(); ++index) {
+        const std::uint64_t hash = hash_name(name_of(table.entries[index]));
+        std::size_t i = static_cast<std::size_t>(hash) & mask;
+        while (table.slots[i].index != kEmpty) {
+            i = (i + 1) & mask;
+        }
+        table.slots[i] = Slot{hash, static_cast<std::uint32_t>(index)};
+    }
+}
+
+void ToolRegistry::register_method(std::string name, MethodHandler handler) {
+    insert(methods_, MethodEntry{std::move(name), std::move(handler)}, method_name);
+}
+
+void ToolRegistry::register_tool(ToolDefinition definition, ToolHandler handler) {
+    SchemaValidator validator = SchemaValidator::compile(definition.input_schema);
+    json::Value definition_json = definition.ToJson();
+    insert(tools_,
+           ToolEntry{std::move(definition), std::move(handler), std::move(definition_json), std::move(validator)},
+           tool_name);
+}
+
+const ToolRegistry::MethodEntry* ToolRegistry::find_method(std::string_view name) const {
+    const std::uint32_t index = lookup(methods_, name, method_name);
+    return index == kEmpty ? nullptr : &methods_.entries[index];
+}
+
+const ToolRegistry::ToolEntry* ToolRegistry::find_tool(std::string_view name) const {
+    const std::uint32_t index = lookup(tools_, name, tool_name);
+    return index == kEmpty ? nullptr : &tools_.entries[index];
+}
+
+json::Value ToolRegistry::tool_list() const {
+    json::Value::Array tools_array;
+    tools_array.reserve(tools_.entries.size());
+    for (const auto& entry : tools_.entries) {
+        tools_array.push_back(entry.definition_json);
+    }
+    return json::make_object({{"tools", json::Value(std::move(tools_array))}});
+}
+
+}  // namespace mcp_sandtimer
@@ -1,22 +1,49 @@
+#include "mcp_sandtimer/CommandCoalescer.h"
+#include "mcp_sandtimer/CommandSpool.h"
+#include "mcp_sandtimer/IdempotencyCache.h"
+#include "mcp_sandtimer/Logger.h"
 #include "mcp_sandtimer/MCPSandTimerServer.h"
 #include "mcp_sandtimer/TimerClient.h"
 #include "mcp_sandtimer/ToolDefinition.h"
 #include "mcp_sandtimer/Version.h"
 #include "mcp_sandtimer/Json.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace {
 
 struct Options {
     std::string host = "127.0.0.1";
     std::uint16_t port = 61420;
+    std::vector<mcp_sandtimer::TimerEndpoint> endpoints;
+    std::vector<mcp_sandtimer::TimerEndpoint> replicas;
+    std::string replication_policy = "all";
     int timeout_ms = 5000;
+    int min_timeout_ms = static_cast<int>(mcp_sandtimer::TimerClient::kDefaultMinTimeout.count());
+    int breaker_threshold = 3;
+    int breaker_open_ms = 2000;
+    std::string spool_path;
+    std::string shared_memory_path;
+    std::string wire_format = "json";
+    std::size_t spool_capacity = 1024;
+    std::string spool_backpressure = "reject";
+    std::string log_level = "info";
+    std::string log_file;
+    std::string framing = "auto";
+    int workers = 4;
+    int request_timeout_ms = 0;
+    int coalesce_ms = 0;
+    int idempotency_window_ms = 0;
+    std::size_t idempotency_capacity = 1024;
+    mcp_sandtimer::json::ParseLimits parse_limits;
     bool list_tools = false;
     bool show_version = false;
     bool show_help = false;
@@ -26,12 +53,34 @@ void PrintUsage() {
     std::cout << "Usage: mcp-sandtimer [options]\n"
               << "\n"
               << "Options:\n"
-              << "  --host <hostname>     Address of the sandtimer TCP server (default 127.0.0.1)\n"
-              << "  --port <port>         TCP port exposed by sandtimer (default 61420)\n"
-              << "  --timeout <seconds>   Connection timeout in seconds (default 5)\n"
-              << "  --list-tools          Print the MCP tool descriptions as JSON and exit\n"
-              << "  --version             Print version information and exit\n"
-              << "  -h, --help            Show this message\n";
+              << "  --host <hostname>         Address of the sandtimer TCP server (default 127.0.0.1)\n"
+              << "  --port <port>             TCP port exposed by sandtimer (default 61420)\n"
+              << "  --endpoints <list>        Comma-separated host:port list; labels are sharded across them by consistent hashing\n"
+              << "  --replicas <list>         Comma-separated host:port list; every command is sent to all of them in parallel\n"
+              << "  --replication-policy <p>  Acks needed before a replicated send returns: first, quorum or all (default all)\n"
+              << "  --timeout <seconds>       Upper bound on connect and send time in seconds, 0 for none (default 5)\n"
+              << "  --timeout-ms <ms>         Same as --timeout in milliseconds\n"
+              << "  --min-timeout-ms <ms>     Lower bound on the RTT-derived timeout (default 50)\n"
+              << "  --breaker-threshold <n>   Consecutive failures before failing fast (default 3)\n"
+              << "  --breaker-open-ms <ms>    Time to fail fast before retrying sandtimer (default 2000)\n"
+              << "  --spool <path>            Queue commands in a durable spool file and deliver them in the background\n"
+              << "  --spool-capacity <n>      Maximum number of spooled commands (default 1024)\n"
+              << "  --spool-backpressure <p>  When the spool is full: reject, drop-oldest or block (default reject)\n"
+              << "  --shared-memory <path>    Deliver commands through a co-located sandtimer's shared-memory ring, falling back to TCP\n"
+              << "  --wire-format <format>    Command encoding on TCP: json or binary (default json)\n"
+              << "  --max-message-bytes <n>   Largest accepted JSON-RPC message (default 4194304)\n"
+              << "  --max-json-depth <n>      Deepest accepted object/array nesting (default 128)\n"
+              << "  --framing <mode>          stdio framing: auto, content-length or ndjson (default auto)\n"
+              << "  --workers <n>             Threads executing requests; 0 runs them inline (default 4)\n"
+              << "  --request-timeout-ms <ms> Deadline for each tools/call, 0 for none (default 0)\n"
+              << "  --coalesce-ms <ms>        Hold commands this long to merge superseded ones per label, 0 for off (default 0)\n"
+              << "  --idempotency-ms <ms>     Replay results of tools/call retries with the same idempotencyKey for this long, 0 for off (default 0)\n"
+              << "  --idempotency-entries <n> Maximum number of remembered tools/call results (default 1024)\n"
+              << "  --log-level <level>       Minimum diagnostic level: debug, info, warn, error or off (default info)\n"
+              << "  --log-file <path>         Also append diagnostics to a JSON Lines file\n"
+              << "  --list-tools              Print the MCP tool descriptions as JSON and exit\n"
+              << "  --version                 Print version information and exit\n"
+              << "  -h, --help                Show this message\n";
 }
 
 bool ParseInteger(const std::string& text, long long& output) {
@@ -44,6 +93,34 @@ bool ParseInteger(const std::string& text, long long& output) {
     return true;
 }
 
+// host:port，IPv6 地址写成 [::1]:61420
+mcp_sandtimer::TimerEndpoint ParseEndpoint(const std::string& option, const std::string& text) {
+    const std::size_t colon = text.rfind(':');
+    if (colon == std::string::npos || colon == 0) {
+        throw std::runtime_error(option + " expects host:port entries, got: " + text);
+    }
+    std::string host = text.substr(0, colon);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+    long long port = 0;
+    if (host.empty() || !ParseInteger(text.substr(colon + 1), port) || port <= 0 || port > 65535) {
+        throw std::runtime_error(option + " expects host:port entries, got: " + text);
+    }
+    return mcp_sandtimer::TimerEndpoint{host, static_cast<std::uint16_t>(port)};
+}
+
+std::vector<mcp_sandtimer::TimerEndpoint> ParseEndpointList(const std::string& option, const std::string& list) {
+    std::vector<mcp_sandtimer::TimerEndpoint> endpoints;
+    std::size_t start = 0;
+    while (start <= list.size()) {
+        const std::size_t comma = std::min(list.find(',', start), list.size());
+        endpoints.push_back(ParseEndpoint(option, list.substr(start, comma - start)));
+        start = comma + 1;
+    }
+    return endpoints;
+}
+
 Options ParseOptions(int argc, char** argv) {
     Options options;
     for (int i = 1; i < argc; ++i) {
@@ -62,6 +139,22 @@ Options ParseOptions(int argc, char** argv) {
                 throw std::runtime_error("--port expects a positive integer between 1 and 65535");
             }
             options.port = static_cast<std::uint16_t>(value);
+        } else if (arg == "--endpoints") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--endpoints requires an argument");
+            }
+            options.endpoints = ParseEndpointList(arg, argv[++i]);
+        } else if (arg == "--replicas") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--replicas requires an argument");
+            }
+            options.replicas = ParseEndpointList(arg, argv[++i]);
+        } else if (arg == "--replication-policy") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--replication-policy requires an argument");
+            }
+            options.replication_policy = argv[++i];
+            mcp_sandtimer::ParseReplicationPolicy(options.replication_policy);
         } else if (arg == "--timeout") {
             if (i + 1 >= argc) {
                 throw std::runtime_error("--timeout requires an argument");
@@ -71,6 +164,155 @@ Options ParseOptions(int argc, char** argv) {
                 throw std::runtime_error("--timeout expects a non-negative integer");
             }
             options.timeout_ms = static_cast<int>(value * 1000);
+        } else if (arg == "--timeout-ms") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--timeout-ms requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value < 0) {
+                throw std::runtime_error("--timeout-ms expects a non-negative integer");
+            }
+            options.timeout_ms = static_cast<int>(value);
+        } else if (arg == "--min-timeout-ms") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--min-timeout-ms requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value < 0) {
+                throw std::runtime_error("--min-timeout-ms expects a non-negative integer");
+            }
+            options.min_timeout_ms = static_cast<int>(value);
+        } else if (arg == "--breaker-threshold") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--breaker-threshold requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value <= 0) {
+                throw std::runtime_error("--breaker-threshold expects a positive integer");
+            }
+            options.breaker_threshold = static_cast<int>(value);
+        } else if (arg == "--breaker-open-ms") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--breaker-open-ms requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value < 0) {
+                throw std::runtime_error("--breaker-open-ms expects a non-negative integer");
+            }
+            options.breaker_open_ms = static_cast<int>(value);
+        } else if (arg == "--spool") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--spool requires an argument");
+            }
+            options.spool_path = argv[++i];
+        } else if (arg == "--spool-capacity") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--spool-capacity requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value <= 0) {
+                throw std::runtime_error("--spool-capacity expects a positive integer");
+            }
+            options.spool_capacity = static_cast<std::size_t>(value);
+        } else if (arg == "--spool-backpressure") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--spool-backpressure requires an argument");
+            }
+            options.spool_backpressure = argv[++i];
+            mcp_sandtimer::ParseBackpressure(options.spool_backpressure);
+        } else if (arg == "--shared-memory") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--shared-memory requires an argument");
+            }
+            options.shared_memory_path = argv[++i];
+        } else if (arg == "--wire-format") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--wire-format requires an argument");
+            }
+            options.wire_format = argv[++i];
+            mcp_sandtimer::ParseWireFormat(options.wire_format);
+        } else if (arg == "--max-message-bytes") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--max-message-bytes requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value <= 0) {
+                throw std::runtime_error("--max-message-bytes expects a positive integer");
+            }
+            options.parse_limits.max_payload = static_cast<std::size_t>(value);
+            options.parse_limits.max_string_length =
+                std::min(options.parse_limits.max_string_length, options.parse_limits.max_payload);
+        } else if (arg == "--max-json-depth") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--max-json-depth requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value <= 0) {
+                throw std::runtime_error("--max-json-depth expects a positive integer");
+            }
+            options.parse_limits.max_depth = static_cast<std::size_t>(value);
+        } else if (arg == "--framing") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--framing requires an argument");
+            }
+            options.framing = argv[++i];
+            mcp_sandtimer::ParseMessageFraming(options.framing);
+        } else if (arg == "--workers") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--workers requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value < 0 || value > 64) {
+                throw std::runtime_error("--workers expects an integer between 0 and 64");
+            }
+            options.workers = static_cast<int>(value);
+        } else if (arg == "--request-timeout-ms") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--request-timeout-ms requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value < 0) {
+                throw std::runtime_error("--request-timeout-ms expects a non-negative integer");
+            }
+            options.request_timeout_ms = static_cast<int>(value);
+        } else if (arg == "--coalesce-ms") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--coalesce-ms requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value < 0) {
+                throw std::runtime_error("--coalesce-ms expects a non-negative integer");
+            }
+            options.coalesce_ms = static_cast<int>(value);
+        } else if (arg == "--idempotency-ms") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--idempotency-ms requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value < 0) {
+                throw std::runtime_error("--idempotency-ms expects a non-negative integer");
+            }
+            options.idempotency_window_ms = static_cast<int>(value);
+        } else if (arg == "--idempotency-entries") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--idempotency-entries requires an argument");
+            }
+            long long value = 0;
+            if (!ParseInteger(argv[++i], value) || value <= 0) {
+                throw std::runtime_error("--idempotency-entries expects a positive integer");
+            }
+            options.idempotency_capacity = static_cast<std::size_t>(value);
+        } else if (arg == "--log-level") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--log-level requires an argument");
+            }
+            options.log_level = argv[++i];
+            mcp_sandtimer::ParseLogLevel(options.log_level);
+        } else if (arg == "--log-file") {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("--log-file requires an argument");
+            }
+            options.log_file = argv[++i];
         } else if (arg == "--list-tools") {
             options.list_tools = true;
         } else if (arg == "--version") {
@@ -111,8 +353,58 @@ int main(int argc, char** argv) {
             return 0;
         }
 
+        mcp_sandtimer::Logger::Options log_options;
+        log_options.level = mcp_sandtimer::ParseLogLevel(options.log_level);
+        log_options.file_path = options.log_file;
+        mcp_sandtimer::Logger::instance().configure(log_options);
+
         mcp_sandtimer::TimerClient client(options.host, options.port, std::chrono::milliseconds(options.timeout_ms));
+        client.set_min_timeout(std::chrono::milliseconds(options.min_timeout_ms));
+        mcp_sandtimer::CircuitBreaker::Options breaker;
+        breaker.failure_threshold = options.breaker_threshold;
+        breaker.open_interval = std::chrono::milliseconds(options.breaker_open_ms);
+        client.set_breaker_options(breaker);
+        if (!options.endpoints.empty()) {
+            client.set_endpoints(options.endpoints);
+        }
+        if (!options.replicas.empty()) {
+            client.set_replicas(options.replicas, mcp_sandtimer::ParseReplicationPolicy(options.replication_policy));
+        }
+        client.set_shared_memory_path(options.shared_memory_path);
+        client.set_wire_format(mcp_sandtimer::ParseWireFormat(options.wire_format));
+        std::shared_ptr<mcp_sandtimer::CommandSpool> spool;
+        if (!options.spool_path.empty()) {
+            mcp_sandtimer::CommandSpool::Options spool_options;
+            spool_options.path = options.spool_path;
+            spool_options.capacity = options.spool_capacity;
+            spool_options.backpressure = mcp_sandtimer::ParseBackpressure(options.spool_backpressure);
+            spool = std::make_shared<mcp_sandtimer::CommandSpool>(client, spool_options);
+        }
+        std::shared_ptr<mcp_sandtimer::CommandCoalescer> coalescer;
+        if (options.coalesce_ms > 0) {
+            mcp_sandtimer::CommandCoalescer::Options coalescer_options;
+            coalescer_options.window = std::chrono::milliseconds(options.coalesce_ms);
+            coalescer = std::make_shared<mcp_sandtimer::CommandCoalescer>(client, coalescer_options);
+        }
+        // 不与 C stdio 同步，std::cin 才有自己的缓冲区，NDJSON 读取可以一次取走已到达的全部字节
+        std::ios::sync_with_stdio(false);
         mcp_sandtimer::MCPSandTimerServer server(std::move(client));
+        server.SetParseLimits(options.parse_limits);
+        server.SetFraming(mcp_sandtimer::ParseMessageFraming(options.framing));
+        server.SetWorkerCount(static_cast<std::size_t>(options.workers));
+        server.SetRequestTimeout(std::chrono::milliseconds(options.request_timeout_ms));
+        if (spool) {
+            server.EnableSpool(spool);
+        }
+        if (coalescer) {
+            server.EnableCoalescing(coalescer);
+        }
+        if (options.idempotency_window_ms > 0) {
+            mcp_sandtimer::IdempotencyCache::Options cache_options;
+            cache_options.capacity = options.idempotency_capacity;
+            cache_options.ttl = std::chrono::milliseconds(options.idempotency_window_ms);
+            server.EnableIdempotency(std::make_shared<mcp_sandtimer::IdempotencyCache>(cache_options));
+        }
         server.Serve();
         return 0;
     } catch (const std::exception& ex) {
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <streambuf>
+#include <string>
+
+namespace mcp_sandtimer::testing {
+
+// 像管道一样的输入：没有数据时阻塞读取方，直到测试写入更多内容或关闭
+class PipeBuffer : public std::streambuf {
+public:
+    void write(const std::string& data) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ += data;
+        }
+        ready_.notify_all();
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+protected:
+    int_type underflow() override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this] { return !pending_.empty() || closed_; });
+        if (pending_.empty()) {
+            return traits_type::eof();
+        }
+        current_ = std::move(pending_);
+        pending_.clear();
+        setg(current_.data(), current_.data(), current_.data() + current_.size());
+        return traits_type::to_int_type(current_[0]);
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::string pending_;
+    std::string current_;
+    bool closed_ = false;
+};
+
+}  // namespace mcp_sandtimer::testing
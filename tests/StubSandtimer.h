@@ -0,0 +1,295 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mcp_sandtimer/CommandCodec.h"
+#include "mcp_sandtimer/CommandRing.h"
+#include "mcp_sandtimer/TimerCommand.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// 测试用的本地 sandtimer 替身：监听 TCP 端口，每个连接读到 EOF 视为一条命令并记录下来。
+// 与真实接收端一样按首字节识别 JSON 与二进制编码
+namespace mcp_sandtimer::testing {
+
+class StubSandtimer {
+public:
+    explicit StubSandtimer(const std::string& address = "127.0.0.1", std::uint16_t port = 0) {
+#ifdef _WIN32
+        WSADATA data{};
+        WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+        sockaddr_storage storage{};
+        socklen_t length = 0;
+        const bool ipv6 = address.find(':') != std::string::npos;
+        if (ipv6) {
+            auto* addr = reinterpret_cast<sockaddr_in6*>(&storage);
+            addr->sin6_family = AF_INET6;
+            addr->sin6_port = htons(port);
+            inet_pton(AF_INET6, address.c_str(), &addr->sin6_addr);
+            length = sizeof(sockaddr_in6);
+        } else {
+            auto* addr = reinterpret_cast<sockaddr_in*>(&storage);
+            addr->sin_family = AF_INET;
+            addr->sin_port = htons(port);
+            inet_pton(AF_INET, address.c_str(), &addr->sin_addr);
+            length = sizeof(sockaddr_in);
+        }
+        listener_ = ::socket(ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listener_ == kInvalid) {
+            throw std::runtime_error("stub: socket() failed");
+        }
+        int reuse = 1;
+        setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        if (::bind(listener_, reinterpret_cast<sockaddr*>(&storage), length) != 0 || ::listen(listener_, 16) != 0) {
+            close_handle(listener_);
+            throw std::runtime_error("stub: unable to listen on " + address);
+        }
+        getsockname(listener_, reinterpret_cast<sockaddr*>(&storage), &length);
+        port_ = ntohs(ipv6 ? reinterpret_cast<sockaddr_in6*>(&storage)->sin6_port
+                           : reinterpret_cast<sockaddr_in*>(&storage)->sin_port);
+        worker_ = std::thread([this] { run(); });
+    }
+
+    StubSandtimer(const StubSandtimer&) = delete;
+    StubSandtimer& operator=(const StubSandtimer&) = delete;
+
+    ~StubSandtimer() {
+        stop();
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    std::uint16_t port() const noexcept { return port_; }
+
+    void stop() {
+        if (stopping_.exchange(true)) {
+            return;
+        }
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        close_handle(listener_);
+    }
+
+    std::vector<std::string> messages() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return messages_;
+    }
+
+    bool wait_for_messages(std::size_t count, std::chrono::milliseconds timeout) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return received_.wait_for(lock, timeout, [&] { return messages_.size() >= count; });
+    }
+
+    // 收到的原始字节按各自的格式解码，格式错误时抛出 CommandCodecError
+    std::vector<TimerCommand> commands() const {
+        std::vector<TimerCommand> commands;
+        for (const std::string& message : messages()) {
+            commands.push_back(DecodeCommand(message));
+        }
+        return commands;
+    }
+
+private:
+#ifdef _WIN32
+    using handle = SOCKET;
+    static constexpr handle kInvalid = INVALID_SOCKET;
+    static void close_handle(handle h) { if (h != kInvalid) { closesocket(h); } }
+#else
+    using handle = int;
+    static constexpr handle kInvalid = -1;
+    static void close_handle(handle h) { if (h != kInvalid) { ::close(h); } }
+#endif
+
+    handle listener_ = kInvalid;
+    std::uint16_t port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable received_;
+    std::vector<std::string> messages_;
+
+    void run() {
+        while (!stopping_) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(listener_, &readable);
+            timeval tv{0, 10000};
+            if (select(static_cast<int>(listener_) + 1, &readable, nullptr, nullptr, &tv) <= 0) {
+                continue;
+            }
+            handle client = ::accept(listener_, nullptr, nullptr);
+            if (client == kInvalid) {
+                continue;
+            }
+            std::string payload;
+            char buffer[4096];
+            while (true) {
+                const int got = static_cast<int>(::recv(client, buffer, sizeof(buffer), 0));
+                if (got <= 0) {
+                    break;
+                }
+                payload.append(buffer, static_cast<std::size_t>(got));
+            }
+            close_handle(client);
+            if (payload.empty()) {
+                continue;  // 纯连接探测，不算命令
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                messages_.push_back(std::move(payload));
+            }
+            received_.notify_all();
+        }
+    }
+};
+
+// 共享内存通道的 sandtimer 替身：作为消费者创建命令环，后台线程逐条取出并记录
+class SharedMemoryStub {
+public:
+    explicit SharedMemoryStub(const std::string& path, std::size_t capacity = CommandRing::kDefaultCapacity)
+        : ring_(path, CommandRing::Role::Consumer, capacity) {
+        worker_ = std::thread([this] { run(); });
+    }
+
+    SharedMemoryStub(const SharedMemoryStub&) = delete;
+    SharedMemoryStub& operator=(const SharedMemoryStub&) = delete;
+
+    ~SharedMemoryStub() { stop(); }
+
+    void stop() {
+        if (stopping_.exchange(true)) {
+            return;
+        }
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    CommandRing::Stats stats() const { return ring_.stats(); }
+
+    std::vector<TimerCommand> commands() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return commands_;
+    }
+
+    bool wait_for_commands(std::size_t count, std::chrono::milliseconds timeout) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return received_.wait_for(lock, timeout, [&] { return commands_.size() >= count; });
+    }
+
+private:
+    CommandRing ring_;
+    std::atomic<bool> stopping_{false};
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable received_;
+    std::vector<TimerCommand> commands_;
+
+    void run() {
+        TimerCommand command;
+        while (!stopping_) {
+            if (!ring_.pop(command, std::chrono::milliseconds(10))) {
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                commands_.push_back(command);
+            }
+            received_.notify_all();
+        }
+    }
+};
+
+// 模拟“黑洞”地址：监听但从不 accept，并预先占满 backlog，之后的 SYN 会被丢弃，连接一直挂起。
+// 指定 port 时接管该端口，例如模拟一个原本健康的端点突然不再响应
+class BlackHoleListener {
+public:
+    explicit BlackHoleListener(const std::string& address, std::uint16_t port = 0) {
+#ifdef _WIN32
+        WSADATA data{};
+        WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+        const bool ipv6 = address.find(':') != std::string::npos;
+        sockaddr_storage storage{};
+        socklen_t length = 0;
+        if (ipv6) {
+            auto* addr = reinterpret_cast<sockaddr_in6*>(&storage);
+            addr->sin6_family = AF_INET6;
+            addr->sin6_port = htons(port);
+            inet_pton(AF_INET6, address.c_str(), &addr->sin6_addr);
+            length = sizeof(sockaddr_in6);
+        } else {
+            auto* addr = reinterpret_cast<sockaddr_in*>(&storage);
+            addr->sin_family = AF_INET;
+            addr->sin_port = htons(port);
+            inet_pton(AF_INET, address.c_str(), &addr->sin_addr);
+            length = sizeof(sockaddr_in);
+        }
+        listener_ = ::socket(ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listener_ == kInvalid) {
+            throw std::runtime_error("black hole: socket() failed");
+        }
+        int reuse = 1;
+        setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        if (::bind(listener_, reinterpret_cast<sockaddr*>(&storage), length) != 0 || ::listen(listener_, 0) != 0) {
+            close_handle(listener_);
+            throw std::runtime_error("black hole: unable to listen on " + address);
+        }
+        getsockname(listener_, reinterpret_cast<sockaddr*>(&storage), &length);
+        filler_ = ::socket(ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        ::connect(filler_, reinterpret_cast<sockaddr*>(&storage), length);
+        port_ = ntohs(ipv6 ? reinterpret_cast<sockaddr_in6*>(&storage)->sin6_port
+                           : reinterpret_cast<sockaddr_in*>(&storage)->sin_port);
+    }
+
+    BlackHoleListener(const BlackHoleListener&) = delete;
+    BlackHoleListener& operator=(const BlackHoleListener&) = delete;
+
+    ~BlackHoleListener() {
+        close_handle(filler_);
+        close_handle(listener_);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    std::uint16_t port() const noexcept { return port_; }
+
+private:
+#ifdef _WIN32
+    using handle = SOCKET;
+    static constexpr handle kInvalid = INVALID_SOCKET;
+    static void close_handle(handle h) { if (h != kInvalid) { closesocket(h); } }
+#else
+    using handle = int;
+    static constexpr handle kInvalid = -1;
+    static void close_handle(handle h) { if (h != kInvalid) { ::close(h); } }
+#endif
+
+    handle listener_ = kInvalid;
+    handle filler_ = kInvalid;
+    std::uint16_t port_ = 0;
+};
+
+}  // namespace mcp_sandtimer::testing
@@ -0,0 +1,171 @@
+#include "mcp_sandtimer/AllocationTracker.h"
+#include "mcp_sandtimer/MCPSandTimerServer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::AllocationScope;
+using mcp_sandtimer::AllocationTag;
+using mcp_sandtimer::AllocationTracker;
+using mcp_sandtimer::json::Value;
+
+std::uint64_t TagAllocations(AllocationTag tag) {
+    return AllocationTracker::stats().tags[static_cast<std::size_t>(tag)].allocations;
+}
+
+struct alignas(64) CacheLine {
+    char bytes[64];
+};
+
+// 分配按当前标签计数，释放后活跃字节数回到原值；作用域可以嵌套；对齐分配同样计数
+bool TestCountsAndTags() {
+    if (!AllocationTracker::installed()) {
+        std::cerr << "Allocation hooks are not installed" << std::endl;
+        return false;
+    }
+    const AllocationTracker::Stats before = AllocationTracker::stats();
+    const std::uint64_t thread_before = AllocationTracker::thread_allocations();
+    {
+        const AllocationScope framing(AllocationTag::Framing);
+        auto buffer = std::make_unique<char[]>(4096);
+        {
+            const AllocationScope parser(AllocationTag::JsonParser);
+            std::vector<int> values(100);
+            const AllocationTracker::Stats during = AllocationTracker::stats();
+            if (during.live_bytes < before.live_bytes + 4096 + 400) {
+                std::cerr << "Live bytes did not grow: " << during.ToJson().dump() << std::endl;
+                return false;
+            }
+        }
+        auto line = std::make_unique<CacheLine>();
+        if (reinterpret_cast<std::uintptr_t>(line.get()) % alignof(CacheLine) != 0) {
+            std::cerr << "Over-aligned allocation is misaligned" << std::endl;
+            return false;
+        }
+    }
+    const AllocationTracker::Stats after = AllocationTracker::stats();
+    const auto& framing = after.tags[static_cast<std::size_t>(AllocationTag::Framing)];
+    const auto& parser = after.tags[static_cast<std::size_t>(AllocationTag::JsonParser)];
+    const auto& framing_before = before.tags[static_cast<std::size_t>(AllocationTag::Framing)];
+    const auto& parser_before = before.tags[static_cast<std::size_t>(AllocationTag::JsonParser)];
+    if (framing.allocations - framing_before.allocations != 2 || parser.allocations - parser_before.allocations != 1 ||
+        framing.bytes - framing_before.bytes != 4096 + sizeof(CacheLine) ||
+        AllocationTracker::thread_allocations() - thread_before != 3) {
+        std::cerr << "Unexpected tag counts: " << after.ToJson().dump() << std::endl;
+        return false;
+    }
+    if (after.live_bytes != before.live_bytes || framing.live_bytes != framing_before.live_bytes ||
+        after.deallocations - before.deallocations != 3 || after.peak_live_bytes < before.live_bytes + 4096) {
+        std::cerr << "Live bytes did not return after release: " << after.ToJson().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 大小加上头部会溢出的请求按分配失败处理，而不是回绕成一个很小的块
+bool TestOversizedAllocationFails() {
+    volatile std::size_t huge = SIZE_MAX - 8;
+    const AllocationTracker::Stats before = AllocationTracker::stats();
+    try {
+        void* pointer = ::operator new(huge);
+        ::operator delete(pointer);
+        std::cerr << "Oversized operator new returned a block" << std::endl;
+        return false;
+    } catch (const std::bad_alloc&) {
+    }
+    if (::operator new(huge, std::nothrow) != nullptr ||
+        ::operator new(huge, std::align_val_t{64}, std::nothrow) != nullptr) {
+        std::cerr << "Oversized nothrow operator new returned a block" << std::endl;
+        return false;
+    }
+    if (AllocationTracker::stats().live_bytes != before.live_bytes) {
+        std::cerr << "Failed allocations were counted" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 解析与 TimerClient 的分配计入各自的标签
+bool TestSubsystemTags() {
+    const std::uint64_t parser_before = TagAllocations(AllocationTag::JsonParser);
+    const Value message = Value::parse(R"({"jsonrpc":"2.0","id":1,"method":"ping","params":{"label":"tea"}})");
+    if (TagAllocations(AllocationTag::JsonParser) == parser_before) {
+        std::cerr << "Parser allocations were not tagged" << std::endl;
+        return false;
+    }
+
+    mcp_sandtimer::testing::StubSandtimer stub;
+    mcp_sandtimer::TimerClient client("127.0.0.1", stub.port(), std::chrono::milliseconds(2000));
+    const std::uint64_t client_before = TagAllocations(AllocationTag::TimerClient);
+    client.start_timer("tea", 60);
+    client.start_timer_async("coffee", 60).get();
+    if (TagAllocations(AllocationTag::TimerClient) == client_before) {
+        std::cerr << "TimerClient allocations were not tagged" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// sandtimer/metrics 报告内存占用与每条消息的分配次数
+bool TestServerMetrics() {
+    mcp_sandtimer::testing::StubSandtimer stub;
+    std::istringstream input(
+        R"({"jsonrpc":"2.0","id":1,"method":"tools/call","params":{"name":"start_timer","arguments":{"label":"tea","time":60}}})" "\n"
+        R"({"jsonrpc":"2.0","id":2,"method":"ping"})" "\n"
+        R"({"jsonrpc":"2.0","id":3,"method":"sandtimer/metrics"})" "\n");
+    std::ostringstream output;
+    mcp_sandtimer::MCPSandTimerServer server(
+        mcp_sandtimer::TimerClient("127.0.0.1", stub.port(), std::chrono::milliseconds(2000)), input, output);
+    server.SetWorkerCount(0);
+    server.Serve();
+
+    std::istringstream lines(output.str());
+    std::string line;
+    Value metrics;
+    while (std::getline(lines, line)) {
+        metrics = Value::parse(line);
+    }
+    const Value* memory = metrics.find("result") != nullptr ? metrics.find("result")->find("memory") : nullptr;
+    if (memory == nullptr || !memory->find("installed")->as_bool() || memory->find("peakRssBytes")->as_number() <= 0 ||
+        memory->find("liveBytes")->as_number() <= 0 ||
+        memory->find("tags")->find("framing")->find("allocations")->as_number() <= 0) {
+        std::cerr << "Unexpected memory metrics: " << output.str() << std::endl;
+        return false;
+    }
+    // metrics 请求自身还没处理完，只计入前两条
+    const Value* per_message = memory->find("perMessage");
+    if (per_message->find("messages")->as_number() != 2 || per_message->find("meanAllocations")->as_number() <= 0 ||
+        per_message->find("maxAllocations")->as_number() < per_message->find("meanAllocations")->as_number()) {
+        std::cerr << "Unexpected per-message allocations: " << memory->dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestCountsAndTags()) {
+        return 1;
+    }
+    if (!TestOversizedAllocationFails()) {
+        return 1;
+    }
+    if (!TestSubsystemTags()) {
+        return 1;
+    }
+    if (!TestServerMetrics()) {
+        return 1;
+    }
+    return 0;
+}
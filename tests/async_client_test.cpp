@@ -0,0 +1,162 @@
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::TimerOp;
+using mcp_sandtimer::testing::StubSandtimer;
+
+// 统计回调完成情况，等待全部命令结束
+class Completions {
+public:
+    mcp_sandtimer::TimerCompletion callback() {
+        return [this](std::exception_ptr error) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++(error ? failed_ : succeeded_);
+            done_.notify_all();
+        };
+    }
+
+    bool wait(int count, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return done_.wait_for(lock, timeout, [&] { return succeeded_ + failed_ >= count; });
+    }
+
+    int succeeded() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return succeeded_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable done_;
+    int succeeded_ = 0;
+    int failed_ = 0;
+};
+
+// 单个线程连续提交大量命令，全部成功送达；同一 label 的命令保持提交顺序
+bool TestManyCommandsInOrder() {
+    StubSandtimer stub;
+    mcp_sandtimer::TimerClient client("127.0.0.1", stub.port(), std::chrono::milliseconds(10000));
+    Completions completions;
+    constexpr int kLabels = 100;
+    for (int i = 0; i < kLabels; ++i) {
+        const std::string label = "timer-" + std::to_string(i);
+        client.start_timer_async(label, 60 + i, completions.callback());
+    }
+    for (int i = 0; i < kLabels; ++i) {
+        client.reset_timer_async("timer-" + std::to_string(i), completions.callback());
+    }
+    for (int i = 0; i < kLabels; ++i) {
+        client.cancel_timer_async("timer-" + std::to_string(i), completions.callback());
+    }
+    if (!completions.wait(kLabels * 3, std::chrono::milliseconds(20000)) || completions.succeeded() != kLabels * 3) {
+        std::cerr << "Only " << completions.succeeded() << " async commands succeeded" << std::endl;
+        return false;
+    }
+    if (!stub.wait_for_messages(kLabels * 3, std::chrono::milliseconds(5000))) {
+        std::cerr << "Stub did not receive every command" << std::endl;
+        return false;
+    }
+    std::map<std::string, std::vector<TimerOp>> by_label;
+    for (const auto& command : stub.commands()) {
+        by_label[command.label.str()].push_back(command.op);
+    }
+    const std::vector<TimerOp> expected{TimerOp::Start, TimerOp::Reset, TimerOp::Cancel};
+    for (const auto& [label, ops] : by_label) {
+        if (ops != expected) {
+            std::cerr << "Commands for " << label << " arrived out of order" << std::endl;
+            return false;
+        }
+    }
+    const auto metrics = client.metrics();
+    const auto* async = metrics.find("async");
+    if (by_label.size() != kLabels || async == nullptr || async->find("completed")->as_number() != kLabels * 3 ||
+        async->find("outstanding")->as_number() != 0) {
+        std::cerr << "Unexpected async metrics: " << metrics.dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 端点不可达时 future 抛出异常；熔断打开后直接得到 CircuitOpenError
+bool TestFailures() {
+    std::uint16_t port = 0;
+    {
+        StubSandtimer stub;
+        port = stub.port();
+    }
+    mcp_sandtimer::TimerClient client("127.0.0.1", port, std::chrono::milliseconds(2000));
+    mcp_sandtimer::CircuitBreaker::Options breaker;
+    breaker.failure_threshold = 1;
+    breaker.open_interval = std::chrono::milliseconds(60000);
+    client.set_breaker_options(breaker);
+    try {
+        client.start_timer_async("dead", 5).get();
+        std::cerr << "Async send to a closed port succeeded" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::CircuitOpenError&) {
+        std::cerr << "First failure should not be reported as an open circuit" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::TimerClientError&) {
+    }
+    try {
+        client.start_timer_async("dead", 5).get();
+        std::cerr << "Async send succeeded while the circuit was open" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::CircuitOpenError&) {
+    }
+    return true;
+}
+
+// 队列满时提交方阻塞，直到在途命令完成或超时腾出位置
+bool TestBackpressure() {
+    mcp_sandtimer::testing::BlackHoleListener black_hole("127.0.0.1");
+    mcp_sandtimer::TimerClient client("127.0.0.1", black_hole.port(), std::chrono::milliseconds(300));
+    client.set_async_queue_capacity(2);
+    std::vector<std::future<void>> futures;
+    futures.push_back(client.start_timer_async("a", 1));
+    futures.push_back(client.start_timer_async("b", 1));
+    const auto start = std::chrono::steady_clock::now();
+    futures.push_back(client.start_timer_async("c", 1));
+    const auto blocked = std::chrono::steady_clock::now() - start;
+    if (blocked < std::chrono::milliseconds(200)) {
+        std::cerr << "Submitting to a full queue did not block" << std::endl;
+        return false;
+    }
+    for (auto& future : futures) {
+        try {
+            future.get();
+            std::cerr << "Send to a black hole succeeded" << std::endl;
+            return false;
+        } catch (const mcp_sandtimer::TimerClientError&) {
+        }
+    }
+    return client.async_queue_capacity() == 2;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestManyCommandsInOrder()) {
+        return 1;
+    }
+    if (!TestFailures()) {
+        return 1;
+    }
+    if (!TestBackpressure()) {
+        return 1;
+    }
+    return 0;
+}
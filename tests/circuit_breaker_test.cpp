@@ -0,0 +1,123 @@
+#include "mcp_sandtimer/CircuitBreaker.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::CircuitBreaker;
+using mcp_sandtimer::CircuitOpenError;
+using mcp_sandtimer::TimerClient;
+using mcp_sandtimer::TimerClientError;
+using std::chrono::milliseconds;
+
+bool TestStateMachine() {
+    CircuitBreaker::Options options;
+    options.failure_threshold = 2;
+    options.open_interval = milliseconds{30};
+    CircuitBreaker breaker(options);
+
+    breaker.record_failure();
+    if (breaker.state() != CircuitBreaker::State::Closed) {
+        std::cerr << "Breaker opened before reaching the threshold" << std::endl;
+        return false;
+    }
+    if (!breaker.record_failure() || breaker.state() != CircuitBreaker::State::Open) {
+        std::cerr << "Breaker did not open at the threshold" << std::endl;
+        return false;
+    }
+    if (breaker.allow_request()) {
+        std::cerr << "Open breaker allowed a request" << std::endl;
+        return false;
+    }
+
+    std::this_thread::sleep_for(milliseconds{40});
+    if (!breaker.allow_request() || breaker.state() != CircuitBreaker::State::HalfOpen) {
+        std::cerr << "Breaker did not half-open after the interval" << std::endl;
+        return false;
+    }
+    if (breaker.allow_request()) {
+        std::cerr << "Half-open breaker allowed a second trial" << std::endl;
+        return false;
+    }
+    breaker.record_success();
+
+    const auto stats = breaker.stats();
+    if (stats.state != CircuitBreaker::State::Closed || stats.opened != 1 || stats.half_opened != 1 ||
+        stats.closed != 1 || stats.rejected != 2) {
+        std::cerr << "Unexpected breaker statistics: " << stats.ToJson().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TestClientFailsFastAndRecovers() {
+    // 先占用一个端口再关闭，得到一个拒绝连接的端点
+    std::uint16_t port = 0;
+    {
+        mcp_sandtimer::testing::StubSandtimer reserve;
+        port = reserve.port();
+    }
+
+    TimerClient client("127.0.0.1", port, milliseconds{500});
+    CircuitBreaker::Options options;
+    options.failure_threshold = 1;
+    options.open_interval = milliseconds{60000};
+    options.probe_interval = milliseconds{20};
+    client.set_breaker_options(options);
+
+    try {
+        client.start_timer("demo", 5);
+        std::cerr << "Expected delivery to an unreachable endpoint to fail" << std::endl;
+        return false;
+    } catch (const CircuitOpenError&) {
+        std::cerr << "First failure must reach the network" << std::endl;
+        return false;
+    } catch (const TimerClientError&) {
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    try {
+        client.reset_timer("demo");
+        std::cerr << "Expected open circuit to reject the call" << std::endl;
+        return false;
+    } catch (const CircuitOpenError&) {
+    }
+    if (std::chrono::steady_clock::now() - begin > milliseconds{50}) {
+        std::cerr << "Open circuit did not fail fast" << std::endl;
+        return false;
+    }
+
+    mcp_sandtimer::testing::StubSandtimer stub("127.0.0.1", port);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (client.breaker_state() == CircuitBreaker::State::Open && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds{5});
+    }
+    if (client.breaker_state() != CircuitBreaker::State::HalfOpen) {
+        std::cerr << "Background probe did not detect recovery" << std::endl;
+        return false;
+    }
+
+    client.cancel_timer("demo");
+    if (client.breaker_state() != CircuitBreaker::State::Closed || !stub.wait_for_messages(1, std::chrono::seconds{2})) {
+        std::cerr << "Trial request did not close the circuit" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestStateMachine()) {
+        return 1;
+    }
+    if (!TestClientFailsFastAndRecovers()) {
+        return 1;
+    }
+    return 0;
+}
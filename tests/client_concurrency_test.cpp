@@ -0,0 +1,149 @@
+#include "mcp_sandtimer/CircuitBreaker.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+// 并发压力测试：多个线程同时发送、修改配置、拷贝客户端并读取 metrics。
+// 用 -DENABLE_TSAN=ON 构建时由 ThreadSanitizer 检查数据竞争
+namespace {
+
+using mcp_sandtimer::testing::StubSandtimer;
+
+constexpr int kSenders = 6;
+constexpr int kCommandsPerSender = 40;
+
+// 熔断器的无锁快路径与加锁慢路径交错执行，计数不丢失
+bool TestBreakerUnderContention() {
+    mcp_sandtimer::CircuitBreaker::Options options;
+    options.failure_threshold = 1000000;
+    mcp_sandtimer::CircuitBreaker breaker(options);
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 20000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&breaker, t] {
+            for (int i = 0; i < kIterations; ++i) {
+                if (breaker.allow_request()) {
+                    // 偶尔失败一次，迫使后续的成功走加锁路径清零
+                    if ((i + t) % 97 == 0) {
+                        breaker.record_failure();
+                    } else {
+                        breaker.record_success();
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto stats = breaker.stats();
+    if (stats.successes + stats.failures != static_cast<std::uint64_t>(kThreads) * kIterations ||
+        breaker.state() != mcp_sandtimer::CircuitBreaker::State::Closed) {
+        std::cerr << "Breaker lost updates: " << stats.ToJson().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 发送线程与修改配置的线程并发运行，每条命令都送达且能被解码
+bool TestConcurrentClient() {
+    std::vector<std::unique_ptr<StubSandtimer>> stubs;
+    std::vector<mcp_sandtimer::TimerEndpoint> endpoints;
+    for (int i = 0; i < 2; ++i) {
+        stubs.push_back(std::make_unique<StubSandtimer>());
+        endpoints.push_back({"127.0.0.1", stubs.back()->port()});
+    }
+    mcp_sandtimer::TimerClient client("127.0.0.1", 1, std::chrono::milliseconds(10000));
+    client.set_endpoints(endpoints);
+
+    std::atomic<bool> running{true};
+    std::atomic<int> errors{0};
+    std::thread mutator([&] {
+        int round = 0;
+        while (running.load()) {
+            client.set_timeout(std::chrono::milliseconds(10000 + round % 7));
+            client.set_wire_format(round % 2 == 0 ? mcp_sandtimer::WireFormat::Binary
+                                                  : mcp_sandtimer::WireFormat::Json);
+            client.set_connect_attempt_delay(std::chrono::milliseconds(200 + round % 50));
+            if (round % 10 == 0) {
+                client.set_endpoints(endpoints);
+            }
+            const auto metrics = client.metrics();
+            if (client.endpoints().size() != endpoints.size() || metrics.find("shards") == nullptr) {
+                errors.fetch_add(1);
+            }
+            ++round;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::vector<std::thread> senders;
+    for (int t = 0; t < kSenders; ++t) {
+        senders.emplace_back([&, t] {
+            // 一半线程使用拷贝出的客户端，拷贝与原对象共享健康状态
+            const mcp_sandtimer::TimerClient copy = client;
+            const mcp_sandtimer::TimerClient& sender = t % 2 == 0 ? client : copy;
+            for (int i = 0; i < kCommandsPerSender; ++i) {
+                const std::string label = "t" + std::to_string(t) + "-" + std::to_string(i);
+                try {
+                    if (i % 4 == 3) {
+                        sender.start_timer_async(label, 30).get();
+                    } else {
+                        sender.start_timer(label, 30);
+                    }
+                } catch (const std::exception& error) {
+                    std::cerr << "Send failed: " << error.what() << std::endl;
+                    errors.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& sender : senders) {
+        sender.join();
+    }
+    running.store(false);
+    mutator.join();
+
+    constexpr std::size_t kTotal = kSenders * kCommandsPerSender;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    std::size_t received = 0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        received = stubs[0]->messages().size() + stubs[1]->messages().size();
+        if (received >= kTotal) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::size_t decoded = 0;
+    for (const auto& stub : stubs) {
+        decoded += stub->commands().size();
+    }
+    if (errors.load() != 0 || received != kTotal || decoded != kTotal) {
+        std::cerr << "Received " << received << " of " << kTotal << " commands with " << errors.load() << " errors"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestBreakerUnderContention()) {
+        return 1;
+    }
+    if (!TestConcurrentClient()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "mcp_sandtimer/CommandCoalescer.h"
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::CommandCoalescer;
+using mcp_sandtimer::TimerCommand;
+using mcp_sandtimer::TimerOp;
+using mcp_sandtimer::testing::StubSandtimer;
+using Outcome = CommandCoalescer::Outcome;
+
+CommandCoalescer::Options Window(int ms) {
+    CommandCoalescer::Options options;
+    options.window = std::chrono::milliseconds(ms);
+    return options;
+}
+
+// 在后台线程提交，等几毫秒让提交顺序确定
+std::future<Outcome> Submit(CommandCoalescer& coalescer, TimerCommand command,
+                            mcp_sandtimer::CallOptions options = {}) {
+    auto future = std::async(std::launch::async, [&coalescer, command, options] {
+        return coalescer.submit(command, options);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    return future;
+}
+
+std::multiset<std::string> Received(const StubSandtimer& stub) {
+    std::multiset<std::string> received;
+    for (const auto& command : stub.commands()) {
+        received.insert(std::string(to_string(command.op)) + " " + command.label.str());
+    }
+    return received;
+}
+
+// start→reset→reset→cancel 只发出 cancel；其他 label 的命令照常发出；每个调用都得到自己的去向
+bool TestCollapsesBurst() {
+    StubSandtimer stub;
+    mcp_sandtimer::TimerClient client("127.0.0.1", stub.port(), std::chrono::milliseconds(5000));
+    CommandCoalescer coalescer(client, Window(300));
+
+    auto start = Submit(coalescer, {TimerOp::Start, "burst", 60});
+    auto other = Submit(coalescer, {TimerOp::Start, "other", 30});
+    auto reset1 = Submit(coalescer, {TimerOp::Reset, "burst", 0});
+    auto reset2 = Submit(coalescer, {TimerOp::Reset, "burst", 0});
+    auto cancel = Submit(coalescer, {TimerOp::Cancel, "burst", 0});
+
+    const std::vector<Outcome> outcomes{start.get(), other.get(), reset1.get(), reset2.get(), cancel.get()};
+    const std::vector<Outcome> expected{Outcome::Superseded, Outcome::Sent, Outcome::Superseded, Outcome::Superseded,
+                                        Outcome::Sent};
+    if (outcomes != expected) {
+        std::cerr << "Unexpected outcomes:";
+        for (Outcome outcome : outcomes) {
+            std::cerr << ' ' << to_string(outcome);
+        }
+        std::cerr << std::endl;
+        return false;
+    }
+    stub.wait_for_messages(2, std::chrono::milliseconds(2000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto stats = coalescer.stats();
+    if (Received(stub) != std::multiset<std::string>{"start other", "cancel burst"} || stats.submitted != 5 ||
+        stats.sent != 2 || stats.superseded != 3 || stats.pending != 0) {
+        std::cerr << "Unexpected traffic: " << stats.ToJson().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 待发 start 之后的 reset 并入 start，随它一起完成；窗口过后的 reset 单独发出
+bool TestMergesResets() {
+    StubSandtimer stub;
+    mcp_sandtimer::TimerClient client("127.0.0.1", stub.port(), std::chrono::milliseconds(5000));
+    CommandCoalescer coalescer(client, Window(200));
+
+    auto start = Submit(coalescer, {TimerOp::Start, "tea", 180});
+    auto reset = Submit(coalescer, {TimerOp::Reset, "tea", 0});
+    if (start.get() != Outcome::Sent || reset.get() != Outcome::Merged) {
+        std::cerr << "Reset was not merged into the pending start" << std::endl;
+        return false;
+    }
+    if (coalescer.submit({TimerOp::Reset, "tea", 0}) != Outcome::Sent) {
+        std::cerr << "A reset after the window was not sent" << std::endl;
+        return false;
+    }
+    stub.wait_for_messages(2, std::chrono::milliseconds(2000));
+    const auto stats = coalescer.stats();
+    if (Received(stub) != std::multiset<std::string>{"start tea", "reset tea"} || stats.merged != 1 ||
+        stats.sent != 2) {
+        std::cerr << "Unexpected traffic after merging: " << stats.ToJson().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 窗口内被取消的调用撤回命令，不发出；送达失败的错误交给调用方
+bool TestWithdrawAndFailure() {
+    StubSandtimer stub;
+    mcp_sandtimer::TimerClient client("127.0.0.1", stub.port(), std::chrono::milliseconds(5000));
+    {
+        CommandCoalescer coalescer(client, Window(500));
+        mcp_sandtimer::CancellationToken token;
+        mcp_sandtimer::CallOptions options;
+        options.cancellation = &token;
+        auto cancelled = Submit(coalescer, {TimerOp::Start, "abandoned", 60}, options);
+        token.cancel();
+        try {
+            cancelled.get();
+            std::cerr << "Cancelled submit returned normally" << std::endl;
+            return false;
+        } catch (const mcp_sandtimer::RequestCancelledError&) {
+        }
+        if (coalescer.stats().withdrawn != 1) {
+            std::cerr << "Cancelled command was not withdrawn" << std::endl;
+            return false;
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (!stub.messages().empty()) {
+        std::cerr << "A withdrawn command reached sandtimer" << std::endl;
+        return false;
+    }
+
+    stub.stop();
+    mcp_sandtimer::TimerClient unreachable("127.0.0.1", stub.port(), std::chrono::milliseconds(500));
+    CommandCoalescer coalescer(unreachable, Window(10));
+    try {
+        coalescer.submit({TimerOp::Start, "lost", 60});
+        std::cerr << "Send to a closed port succeeded" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::TimerClientError&) {
+    }
+    if (coalescer.stats().failed != 1) {
+        std::cerr << "Failure was not counted" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestCollapsesBurst()) {
+        return 1;
+    }
+    if (!TestMergesResets()) {
+        return 1;
+    }
+    if (!TestWithdrawAndFailure()) {
+        return 1;
+    }
+    return 0;
+}
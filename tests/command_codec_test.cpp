@@ -0,0 +1,140 @@
+#include "mcp_sandtimer/CommandCodec.h"
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::CommandCodecError;
+using mcp_sandtimer::EncodedCommand;
+using mcp_sandtimer::TimerCommand;
+using mcp_sandtimer::TimerOp;
+using mcp_sandtimer::WireFormat;
+using mcp_sandtimer::json::Value;
+
+const std::vector<TimerCommand> kCommands = {
+    {TimerOp::Start, "tea", 180},
+    {TimerOp::Reset, "", 0},
+    {TimerOp::Cancel, "quote \" backslash \\ tab \t nul", 0},
+    {TimerOp::Start, std::string("\x01\x1f", 2) + "é😀", -5},
+    {TimerOp::Start, std::string(EncodedCommand::kInlineCapacity, '\n'), 2147483647},
+};
+
+// 以前由 json::Value 构造的负载，GUI 收到的字节必须保持不变
+std::string LegacyJson(const TimerCommand& command) {
+    Value payload = mcp_sandtimer::json::make_object({
+        {"cmd", Value(mcp_sandtimer::to_string(command.op))},
+        {"label", Value(command.label)}
+    });
+    if (command.op == TimerOp::Start) {
+        payload.as_object()["time"] = Value(command.seconds);
+    }
+    return payload.dump();
+}
+
+bool SameCommand(const TimerCommand& a, const TimerCommand& b) {
+    return a.op == b.op && a.label == b.label && (a.op != TimerOp::Start || a.seconds == b.seconds);
+}
+
+// 两种编码都能无损往返；JSON 编码与旧实现逐字节相同
+bool TestRoundTrip() {
+    for (const TimerCommand& command : kCommands) {
+        EncodedCommand json;
+        mcp_sandtimer::EncodeCommand(command, WireFormat::Json, json);
+        if (json.view() != LegacyJson(command)) {
+            std::cerr << "JSON encoding changed: " << json.view() << std::endl;
+            return false;
+        }
+        EncodedCommand binary;
+        mcp_sandtimer::EncodeCommand(command, WireFormat::Binary, binary);
+        if (binary.view().size() != mcp_sandtimer::codec::kBinaryHeaderSize + command.label.size() ||
+            mcp_sandtimer::DetectWireFormat(binary.view()) != WireFormat::Binary ||
+            mcp_sandtimer::DetectWireFormat(json.view()) != WireFormat::Json) {
+            std::cerr << "Unexpected binary layout for label of " << command.label.size() << " bytes" << std::endl;
+            return false;
+        }
+        if (!SameCommand(mcp_sandtimer::DecodeCommand(json.view()), command) ||
+            !SameCommand(mcp_sandtimer::DecodeCommand(binary.view()), command)) {
+            std::cerr << "Round trip changed the command" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ExpectCodecError(const std::string& payload, const std::string& what) {
+    try {
+        mcp_sandtimer::DecodeCommand(payload);
+    } catch (const CommandCodecError&) {
+        return true;
+    }
+    std::cerr << "Expected CommandCodecError for " << what << std::endl;
+    return false;
+}
+
+// 截断、版本不符、长度不一致或字段缺失的负载被拒绝
+bool TestMalformed() {
+    EncodedCommand encoded;
+    mcp_sandtimer::EncodeCommand(TimerCommand{TimerOp::Start, "tea", 60}, WireFormat::Binary, encoded);
+    const std::string binary(encoded.view());
+    std::string wrong_version = binary;
+    wrong_version[1] = 9;
+    std::string wrong_op = binary;
+    wrong_op[2] = 7;
+    return ExpectCodecError(binary.substr(0, 8), "a truncated header") &&
+           ExpectCodecError(binary.substr(0, binary.size() - 1), "a truncated label") &&
+           ExpectCodecError(binary + "x", "trailing bytes") && ExpectCodecError(wrong_version, "an unknown version") &&
+           ExpectCodecError(wrong_op, "an unknown op") && ExpectCodecError("{\"cmd\":\"start\",\"label\":\"x\"}", "start without time") &&
+           ExpectCodecError("{\"cmd\":\"pause\",\"label\":\"x\"}", "an unknown command") &&
+           ExpectCodecError("{\"cmd\":\"reset\"", "truncated JSON");
+}
+
+// 客户端按配置的编码发送，替身按首字节识别后解码
+bool TestClientFormats() {
+    mcp_sandtimer::testing::StubSandtimer stub;
+    mcp_sandtimer::TimerClient client("127.0.0.1", stub.port(), std::chrono::milliseconds(2000));
+    client.start_timer("json", 30);
+    client.set_wire_format(WireFormat::Binary);
+    client.start_timer("binary", 45);
+    client.cancel_timer("binary");
+    if (!stub.wait_for_messages(3, std::chrono::milliseconds(2000))) {
+        std::cerr << "Stub did not receive all commands" << std::endl;
+        return false;
+    }
+    const auto messages = stub.messages();
+    const auto commands = stub.commands();
+    if (mcp_sandtimer::DetectWireFormat(messages[0]) != WireFormat::Json ||
+        mcp_sandtimer::DetectWireFormat(messages[1]) != WireFormat::Binary ||
+        !SameCommand(commands[0], TimerCommand{TimerOp::Start, "json", 30}) ||
+        !SameCommand(commands[1], TimerCommand{TimerOp::Start, "binary", 45}) ||
+        !SameCommand(commands[2], TimerCommand{TimerOp::Cancel, "binary", 0})) {
+        std::cerr << "Stub decoded unexpected commands" << std::endl;
+        return false;
+    }
+    if (client.metrics().find("wireFormat")->as_string() != "binary") {
+        std::cerr << "Metrics do not report the wire format" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestRoundTrip()) {
+        return 1;
+    }
+    if (!TestMalformed()) {
+        return 1;
+    }
+    if (!TestClientFormats()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "mcp_sandtimer/CommandRing.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::CommandRing;
+using mcp_sandtimer::CommandRingError;
+using mcp_sandtimer::TimerCommand;
+using mcp_sandtimer::TimerOp;
+
+std::string TempRingPath(const std::string& name) {
+    const std::string path = CommandRing::DefaultPath("mcp_sandtimer_test_" + name);
+    std::filesystem::remove(path);
+    return path;
+}
+
+// 环满时拒绝写入；取出顺序与写入一致，跨越环尾回绕后字段不变
+bool TestOrderAndCapacity() {
+    const std::string path = TempRingPath("order");
+    {
+        CommandRing consumer(path, CommandRing::Role::Consumer, 8);
+        CommandRing producer(path, CommandRing::Role::Producer);
+        if (producer.capacity() != 8) {
+            std::cerr << "Producer saw capacity " << producer.capacity() << std::endl;
+            return false;
+        }
+        for (int i = 0; i < 8; ++i) {
+            if (!producer.try_push(TimerCommand{TimerOp::Start, "t" + std::to_string(i), i})) {
+                std::cerr << "Push " << i << " was rejected" << std::endl;
+                return false;
+            }
+        }
+        if (producer.try_push(TimerCommand{TimerOp::Cancel, "overflow", 0}) || consumer.size() != 8) {
+            std::cerr << "Full ring accepted another command" << std::endl;
+            return false;
+        }
+        TimerCommand command;
+        for (int i = 0; i < 1000; ++i) {
+            if (!consumer.try_pop(command) || command.label != "t" + std::to_string(i) || command.seconds != i ||
+                command.op != (i < 8 ? TimerOp::Start : TimerOp::Reset)) {
+                std::cerr << "Unexpected command at " << i << ": " << command.label << std::endl;
+                return false;
+            }
+            producer.try_push(TimerCommand{TimerOp::Reset, "t" + std::to_string(i + 8), i + 8});
+        }
+        try {
+            producer.try_push(TimerCommand{TimerOp::Start, std::string(CommandRing::kMaxLabelLength + 1, 'x'), 1});
+            std::cerr << "Oversized label was accepted" << std::endl;
+            return false;
+        } catch (const CommandRingError&) {
+        }
+    }
+    std::filesystem::remove(path);
+    return true;
+}
+
+// 生产者不能凭空创建区域；消费者退出后标记为离线，重新上线时保留未取走的命令
+bool TestConsumerLifecycle() {
+    const std::string path = TempRingPath("lifecycle");
+    try {
+        CommandRing producer(path, CommandRing::Role::Producer);
+        std::cerr << "Producer opened a ring that does not exist" << std::endl;
+        return false;
+    } catch (const CommandRingError&) {
+    }
+    auto consumer = std::make_unique<CommandRing>(path, CommandRing::Role::Consumer, 16);
+    CommandRing producer(path, CommandRing::Role::Producer);
+    producer.try_push(TimerCommand{TimerOp::Start, "pending", 30});
+    consumer.reset();
+    if (producer.consumer_online()) {
+        std::cerr << "Consumer still reported online after exit" << std::endl;
+        return false;
+    }
+    consumer = std::make_unique<CommandRing>(path, CommandRing::Role::Consumer, 16);
+    TimerCommand command;
+    if (!producer.consumer_online() || !consumer->try_pop(command) || command.label != "pending") {
+        std::cerr << "Pending command was not kept across a consumer restart" << std::endl;
+        return false;
+    }
+    consumer.reset();
+    std::filesystem::remove(path);
+    return true;
+}
+
+// 睡眠中的消费者被生产者唤醒，而不是等到超时
+bool TestWakeup() {
+    const std::string path = TempRingPath("wakeup");
+    CommandRing consumer(path, CommandRing::Role::Consumer, 16);
+    CommandRing producer(path, CommandRing::Role::Producer);
+    const auto begin = std::chrono::steady_clock::now();
+    std::thread writer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        producer.try_push(TimerCommand{TimerOp::Cancel, "late", 0});
+    });
+    TimerCommand command;
+    const bool popped = consumer.pop(command, std::chrono::milliseconds(5000));
+    const auto waited = std::chrono::steady_clock::now() - begin;
+    writer.join();
+    std::filesystem::remove(path);
+    if (!popped || command.label != "late" || waited > std::chrono::milliseconds(2500)) {
+        std::cerr << "Consumer was not woken: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(waited).count() << " ms" << std::endl;
+        return false;
+    }
+    if (consumer.pop(command, std::chrono::milliseconds(20))) {
+        std::cerr << "pop returned a command from an empty ring" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// TimerClient 优先走共享内存；label 过长或消费者离线时回退到 TCP
+bool TestClientTransport() {
+    const std::string path = TempRingPath("client");
+    mcp_sandtimer::testing::StubSandtimer tcp;
+    auto ring = std::make_unique<mcp_sandtimer::testing::SharedMemoryStub>(path);
+    mcp_sandtimer::TimerClient client("127.0.0.1", tcp.port(), std::chrono::milliseconds(2000));
+    client.set_shared_memory_path(path);
+
+    client.start_timer("tea", 180);
+    client.reset_timer("tea");
+    client.start_timer(std::string(CommandRing::kMaxLabelLength + 1, 'y'), 5);
+    if (!ring->wait_for_commands(2, std::chrono::milliseconds(2000)) || !tcp.wait_for_messages(1, std::chrono::milliseconds(2000))) {
+        std::cerr << "Commands were not delivered" << std::endl;
+        return false;
+    }
+    const auto commands = ring->commands();
+    if (commands.size() != 2 || commands[0].op != TimerOp::Start || commands[0].seconds != 180 ||
+        commands[1].op != TimerOp::Reset || tcp.messages().size() != 1) {
+        std::cerr << "Unexpected split between transports: " << commands.size() << " via ring, "
+                  << tcp.messages().size() << " via TCP" << std::endl;
+        return false;
+    }
+
+    ring.reset();
+    client.cancel_timer("tea");
+    if (!tcp.wait_for_messages(2, std::chrono::milliseconds(2000)) ||
+        tcp.messages()[1].find("\"cancel\"") == std::string::npos) {
+        std::cerr << "Client did not fall back to TCP once the consumer left" << std::endl;
+        return false;
+    }
+    const auto metrics = client.metrics();
+    const auto* shared = metrics.find("sharedMemory");
+    if (shared == nullptr || shared->find("fallbacks")->as_number() != 2) {
+        std::cerr << "Unexpected metrics: " << metrics.dump() << std::endl;
+        return false;
+    }
+    std::filesystem::remove(path);
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestOrderAndCapacity()) {
+        return 1;
+    }
+    if (!TestConsumerLifecycle()) {
+        return 1;
+    }
+    if (!TestWakeup()) {
+        return 1;
+    }
+    if (!TestClientTransport()) {
+        return 1;
+    }
+    return 0;
+}
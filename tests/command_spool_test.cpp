@@ -0,0 +1,181 @@
+#include "mcp_sandtimer/CommandSpool.h"
+#include "mcp_sandtimer/Json.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::CommandSpool;
+using mcp_sandtimer::TimerClient;
+using mcp_sandtimer::TimerCommand;
+using mcp_sandtimer::TimerOp;
+using std::chrono::milliseconds;
+
+std::uint16_t UnusedPort() {
+    mcp_sandtimer::testing::StubSandtimer reserve;
+    return reserve.port();
+}
+
+std::string TempSpoolPath(const std::string& name) {
+    auto path = std::filesystem::temp_directory_path() / ("mcp_sandtimer_" + name + ".spool");
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+CommandSpool::Options MakeOptions(const std::string& path, std::size_t capacity) {
+    CommandSpool::Options options;
+    options.path = path;
+    options.capacity = capacity;
+    options.retry_interval = milliseconds{20};
+    return options;
+}
+
+// 端点不可达时命令落盘并合并，重启后按顺序补发
+bool TestCollapseAndRecover() {
+    const std::uint16_t port = UnusedPort();
+    const std::string path = TempSpoolPath("recover");
+    TimerClient client("127.0.0.1", port, milliseconds{200});
+    {
+        CommandSpool spool(client, MakeOptions(path, 16));
+        spool.append(TimerCommand{TimerOp::Start, "alpha", 10});
+        spool.append(TimerCommand{TimerOp::Reset, "alpha", 0});
+        spool.append(TimerCommand{TimerOp::Cancel, "beta", 0});
+        spool.append(TimerCommand{TimerOp::Start, "beta", 20});
+        spool.append(TimerCommand{TimerOp::Start, "gamma", 30});
+        spool.append(TimerCommand{TimerOp::Cancel, "gamma", 0});
+        if (spool.stats().superseded != 3) {
+            std::cerr << "Unexpected collapse count: " << spool.stats().ToJson().dump() << std::endl;
+            return false;
+        }
+    }
+
+    mcp_sandtimer::testing::StubSandtimer stub("127.0.0.1", port);
+    CommandSpool spool(TimerClient("127.0.0.1", port, milliseconds{1000}), MakeOptions(path, 16));
+    if (spool.stats().recovered != 3) {
+        std::cerr << "Expected three commands to survive the restart: " << spool.stats().ToJson().dump() << std::endl;
+        return false;
+    }
+    if (!spool.wait_until_drained(std::chrono::seconds{5}) || !stub.wait_for_messages(3, std::chrono::seconds{2})) {
+        std::cerr << "Spool did not drain after the endpoint returned" << std::endl;
+        return false;
+    }
+    const std::vector<std::string> expected = {"start:alpha", "start:beta", "cancel:gamma"};
+    const auto messages = stub.messages();
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        const auto payload = mcp_sandtimer::json::Value::parse(messages[i]);
+        const auto& object = payload.as_object();
+        const std::string actual = object.at("cmd").as_string() + ":" + object.at("label").as_string();
+        if (actual != expected[i]) {
+            std::cerr << "Delivery " << i << " was " << actual << ", expected " << expected[i] << std::endl;
+            return false;
+        }
+    }
+    std::filesystem::remove(path);
+    return true;
+}
+
+bool TestBackpressure() {
+    const std::uint16_t port = UnusedPort();
+    TimerClient client("127.0.0.1", port, milliseconds{200});
+
+    const std::string reject_path = TempSpoolPath("reject");
+    {
+        CommandSpool spool(client, MakeOptions(reject_path, 2));
+        spool.append(TimerCommand{TimerOp::Start, "one", 1});
+        spool.append(TimerCommand{TimerOp::Start, "two", 2});
+        try {
+            spool.append(TimerCommand{TimerOp::Start, "three", 3});
+            std::cerr << "Full spool accepted a command under the reject policy" << std::endl;
+            return false;
+        } catch (const mcp_sandtimer::SpoolError&) {
+        }
+    }
+    std::filesystem::remove(reject_path);
+
+    const std::string drop_path = TempSpoolPath("drop");
+    {
+        auto options = MakeOptions(drop_path, 2);
+        options.backpressure = CommandSpool::Backpressure::DropOldest;
+        CommandSpool spool(client, options);
+        spool.append(TimerCommand{TimerOp::Start, "one", 1});
+        spool.append(TimerCommand{TimerOp::Start, "two", 2});
+        spool.append(TimerCommand{TimerOp::Start, "three", 3});
+        const auto stats = spool.stats();
+        if (stats.dropped != 1 || stats.depth != 2) {
+            std::cerr << "Drop-oldest policy misbehaved: " << stats.ToJson().dump() << std::endl;
+            return false;
+        }
+    }
+    std::filesystem::remove(drop_path);
+    return true;
+}
+
+// 队列满而拒绝 cancel 时，同一 label 之前的 start 不能已经被合并掉
+bool TestRejectKeepsSupersededCommands() {
+    const std::uint16_t port = UnusedPort();
+    const std::string path = TempSpoolPath("reject_keeps");
+    {
+        CommandSpool spool(TimerClient("127.0.0.1", port, milliseconds{200}), MakeOptions(path, 2));
+        spool.append(TimerCommand{TimerOp::Start, "one", 1});
+        spool.append(TimerCommand{TimerOp::Start, "two", 2});
+        try {
+            spool.append(TimerCommand{TimerOp::Cancel, "two", 0});
+            std::cerr << "Full spool accepted a cancel under the reject policy" << std::endl;
+            return false;
+        } catch (const mcp_sandtimer::SpoolError&) {
+        }
+        const auto stats = spool.stats();
+        if (stats.superseded != 0 || stats.rejected != 1 || stats.depth != 2) {
+            std::cerr << "Rejected cancel changed the spool: " << stats.ToJson().dump() << std::endl;
+            return false;
+        }
+        // 队首正是被覆盖的命令时，释放它就有了空间
+        spool.append(TimerCommand{TimerOp::Cancel, "one", 0});
+        if (spool.stats().superseded != 1 || spool.stats().depth != 2) {
+            std::cerr << "Cancel did not replace the start at the head: " << spool.stats().ToJson().dump() << std::endl;
+            return false;
+        }
+    }
+
+    mcp_sandtimer::testing::StubSandtimer stub("127.0.0.1", port);
+    CommandSpool spool(TimerClient("127.0.0.1", port, milliseconds{1000}), MakeOptions(path, 2));
+    if (!spool.wait_until_drained(std::chrono::seconds{5}) || !stub.wait_for_messages(2, std::chrono::seconds{2})) {
+        std::cerr << "Spool did not drain after the endpoint returned" << std::endl;
+        return false;
+    }
+    const std::vector<std::string> expected = {"start:two", "cancel:one"};
+    const auto messages = stub.messages();
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        const auto payload = mcp_sandtimer::json::Value::parse(messages[i]);
+        const auto& object = payload.as_object();
+        const std::string actual = object.at("cmd").as_string() + ":" + object.at("label").as_string();
+        if (actual != expected[i]) {
+            std::cerr << "Delivery " << i << " was " << actual << ", expected " << expected[i] << std::endl;
+            return false;
+        }
+    }
+    std::filesystem::remove(path);
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestCollapseAndRecover()) {
+        return 1;
+    }
+    if (!TestBackpressure()) {
+        return 1;
+    }
+    if (!TestRejectKeepsSupersededCommands()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Socket.h"
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::net::SocketAddress;
+using std::chrono::milliseconds;
+
+SocketAddress MakeAddress(const std::string& text, std::uint16_t port) {
+    SocketAddress address;
+    if (text.find(':') != std::string::npos) {
+        auto* addr = reinterpret_cast<sockaddr_in6*>(&address.storage);
+        addr->sin6_family = AF_INET6;
+        addr->sin6_port = htons(port);
+        inet_pton(AF_INET6, text.c_str(), &addr->sin6_addr);
+        address.family = AF_INET6;
+        address.length = sizeof(sockaddr_in6);
+    } else {
+        auto* addr = reinterpret_cast<sockaddr_in*>(&address.storage);
+        addr->sin_family = AF_INET;
+        addr->sin_port = htons(port);
+        inet_pton(AF_INET, text.c_str(), &addr->sin_addr);
+        address.family = AF_INET;
+        address.length = sizeof(sockaddr_in);
+    }
+    return address;
+}
+
+// IPv6 候选地址黑洞时，应在错峰间隔后用 IPv4 连上，而不是等满整个超时
+bool TestFallbackFromBlackHoledFamily() {
+    std::unique_ptr<mcp_sandtimer::testing::BlackHoleListener> black_hole;
+    try {
+        black_hole = std::make_unique<mcp_sandtimer::testing::BlackHoleListener>("::1");
+    } catch (const std::exception&) {
+        std::cout << "IPv6 loopback unavailable; skipping black-hole race" << std::endl;
+        return true;
+    }
+    mcp_sandtimer::testing::StubSandtimer stub("127.0.0.1");
+
+    const std::vector<SocketAddress> candidates = {
+        MakeAddress("::1", black_hole->port()),
+        MakeAddress("127.0.0.1", stub.port()),
+    };
+    mcp_sandtimer::net::ConnectOptions options;
+    options.attempt_delay = milliseconds{50};
+    options.timeout = milliseconds{3000};
+
+    const auto begin = std::chrono::steady_clock::now();
+    auto result = mcp_sandtimer::net::connect_happy_eyeballs(candidates, options);
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    mcp_sandtimer::net::close_socket(result.socket);
+    if (!result.ok() || result.family != AF_INET) {
+        std::cerr << "Expected the IPv4 attempt to win: " << result.error << std::endl;
+        return false;
+    }
+    if (elapsed > milliseconds{1000}) {
+        std::cerr << "Fallback waited for the black-holed address" << std::endl;
+        return false;
+    }
+
+    // 记住 IPv4 后，IPv4 应该先被尝试，无需等待错峰间隔
+    options.preferred_family = AF_INET;
+    options.attempt_delay = milliseconds{1000};
+    const auto second_begin = std::chrono::steady_clock::now();
+    result = mcp_sandtimer::net::connect_happy_eyeballs(candidates, options);
+    const auto second_elapsed = std::chrono::steady_clock::now() - second_begin;
+    mcp_sandtimer::net::close_socket(result.socket);
+    if (!result.ok() || result.family != AF_INET || second_elapsed > milliseconds{500}) {
+        std::cerr << "Preferred family was not attempted first" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TestAllCandidatesFail() {
+    std::uint16_t port = 0;
+    {
+        mcp_sandtimer::testing::StubSandtimer reserve;
+        port = reserve.port();
+    }
+    mcp_sandtimer::net::ConnectOptions options;
+    options.timeout = milliseconds{1000};
+    auto result = mcp_sandtimer::net::connect_happy_eyeballs({MakeAddress("127.0.0.1", port)}, options);
+    if (result.ok() || result.error.empty()) {
+        std::cerr << "Expected refused connection to report an error" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TestClientRemembersFamily() {
+    mcp_sandtimer::testing::StubSandtimer stub("127.0.0.1");
+    mcp_sandtimer::TimerClient client("127.0.0.1", stub.port(), milliseconds{1000});
+    client.start_timer("eyeballs", 3);
+    if (!stub.wait_for_messages(1, std::chrono::seconds{2})) {
+        std::cerr << "Stub did not receive the command" << std::endl;
+        return false;
+    }
+    const auto metrics = client.metrics();
+    if (metrics.as_object().at("preferredFamily").as_string() != "ipv4") {
+        std::cerr << "Winning family was not remembered: " << metrics.dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestFallbackFromBlackHoledFamily()) {
+        return 1;
+    }
+    if (!TestAllCandidatesFail()) {
+        return 1;
+    }
+    if (!TestClientRemembersFamily()) {
+        return 1;
+    }
+    return 0;
+}
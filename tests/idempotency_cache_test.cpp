@@ -0,0 +1,194 @@
+#include "mcp_sandtimer/IdempotencyCache.h"
+#include "mcp_sandtimer/MCPSandTimerServer.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::CallOptions;
+using mcp_sandtimer::IdempotencyCache;
+using mcp_sandtimer::json::Value;
+using Source = IdempotencyCache::Source;
+using std::chrono::milliseconds;
+
+IdempotencyCache::Options MakeOptions(std::size_t capacity, milliseconds ttl) {
+    IdempotencyCache::Options options;
+    options.capacity = capacity;
+    options.ttl = ttl;
+    return options;
+}
+
+// 命中直接返回；超出容量时淘汰最久未用的；过期后重新执行；失败的结果不缓存
+bool TestLruAndTtl() {
+    IdempotencyCache cache(MakeOptions(2, milliseconds(200)));
+    int computed = 0;
+    auto run = [&](const std::string& key) {
+        return cache.run(key, CallOptions{}, [&] { return key + "#" + std::to_string(++computed); });
+    };
+    run("a");
+    run("b");
+    const auto hit = run("a");
+    run("c");  // b 最久未用，被淘汰
+    if (hit.source != Source::Cached || hit.value != "a#1" || run("a").source != Source::Cached ||
+        run("b").value != "b#4" || cache.stats().evicted != 2) {
+        std::cerr << "Unexpected LRU behaviour: " << cache.stats().ToJson().dump() << std::endl;
+        return false;
+    }
+    std::this_thread::sleep_for(milliseconds(250));
+    if (run("b").source != Source::Computed || cache.stats().expired == 0) {
+        std::cerr << "Entry did not expire: " << cache.stats().ToJson().dump() << std::endl;
+        return false;
+    }
+
+    try {
+        cache.run("fails", CallOptions{}, []() -> std::string { throw std::runtime_error("unreachable"); });
+        return false;
+    } catch (const std::runtime_error&) {
+    }
+    if (cache.run("fails", CallOptions{}, [] { return std::string("ok"); }).source != Source::Computed) {
+        std::cerr << "A failed result was cached" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 同一 key 的并发调用只执行一次，其余等待并得到同一结果；执行者失败时由等待者重新执行
+bool TestSingleFlight() {
+    IdempotencyCache cache(MakeOptions(16, milliseconds(10000)));
+    std::atomic<int> computed{0};
+    std::atomic<int> joined{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            const auto result = cache.run("same", CallOptions{}, [&] {
+                std::this_thread::sleep_for(milliseconds(100));
+                return "result-" + std::to_string(++computed);
+            });
+            if (result.value == "result-1" && result.source != Source::Computed) {
+                ++joined;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (computed.load() != 1 || joined.load() != 3) {
+        std::cerr << "Computed " << computed.load() << " times, " << joined.load() << " calls joined" << std::endl;
+        return false;
+    }
+
+    std::atomic<int> attempts{0};
+    std::thread leader([&] {
+        try {
+            cache.run("retry", CallOptions{}, [&]() -> std::string {
+                ++attempts;
+                std::this_thread::sleep_for(milliseconds(100));
+                throw std::runtime_error("leader failed");
+            });
+        } catch (const std::runtime_error&) {
+        }
+    });
+    std::this_thread::sleep_for(milliseconds(30));
+    const auto follower = cache.run("retry", CallOptions{}, [&] {
+        ++attempts;
+        return std::string("follower");
+    });
+    leader.join();
+    if (follower.value != "follower" || follower.source != Source::Computed || attempts.load() != 2) {
+        std::cerr << "Follower did not take over after the leader failed" << std::endl;
+        return false;
+    }
+
+    // 等待者按自己的截止时间放弃
+    std::thread slow([&] {
+        cache.run("slow", CallOptions{}, [] {
+            std::this_thread::sleep_for(milliseconds(300));
+            return std::string("slow");
+        });
+    });
+    std::this_thread::sleep_for(milliseconds(30));
+    CallOptions options;
+    options.deadline = std::chrono::steady_clock::now() + milliseconds(50);
+    bool expired = false;
+    try {
+        cache.run("slow", options, [] { return std::string("duplicate"); });
+    } catch (const mcp_sandtimer::DeadlineExceededError&) {
+        expired = true;
+    }
+    slow.join();
+    if (!expired) {
+        std::cerr << "Waiter ignored its deadline" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string StartCall(int id, const std::string& meta) {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) +
+           R"(,"method":"tools/call","params":{"name":"start_timer","arguments":{"time":60,"label":"tea"})" + meta +
+           "}}\n";
+}
+
+// 服务端：带相同 idempotencyKey 的重试不再发往 sandtimer；不带 key 的调用即使参数相同也照常执行
+bool TestServerReplaysRetries() {
+    mcp_sandtimer::testing::StubSandtimer stub;
+    std::istringstream input(StartCall(1, R"(,"_meta":{"idempotencyKey":"retry-1"})") +
+                             StartCall(2, R"(,"_meta":{"idempotencyKey":"retry-1"})") +
+                             StartCall(3, "") +
+                             R"({"jsonrpc":"2.0","id":4,"method":"tools/call","params":{"name":"start_timer","arguments":{"label":"tea","time":60}}})" "\n" +
+                             R"({"jsonrpc":"2.0","id":5,"method":"sandtimer/metrics"})" "\n");
+    std::ostringstream output;
+    mcp_sandtimer::MCPSandTimerServer server(
+        mcp_sandtimer::TimerClient("127.0.0.1", stub.port(), milliseconds(5000)), input, output);
+    server.SetWorkerCount(0);
+    server.EnableIdempotency(std::make_shared<IdempotencyCache>(MakeOptions(16, milliseconds(10000))));
+    server.Serve();
+
+    std::vector<Value> responses;
+    std::istringstream lines(output.str());
+    std::string line;
+    while (std::getline(lines, line)) {
+        responses.push_back(Value::parse(line));
+    }
+    auto replayed = [&](std::size_t index) {
+        const Value* meta = responses[index].find("result")->find("_meta");
+        return meta != nullptr && meta->find("idempotency")->as_string() == "cached";
+    };
+    stub.wait_for_messages(3, milliseconds(2000));
+    if (responses.size() != 5 || replayed(0) || !replayed(1) || replayed(2) || replayed(3) ||
+        stub.messages().size() != 3) {
+        std::cerr << "Unexpected responses: " << output.str() << std::endl;
+        return false;
+    }
+    const Value* stats = responses[4].find("result")->find("idempotency");
+    if (stats == nullptr || stats->find("hits")->as_number() != 1 || stats->find("misses")->as_number() != 1) {
+        std::cerr << "Unexpected idempotency metrics: " << responses[4].dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestLruAndTtl()) {
+        return 1;
+    }
+    if (!TestSingleFlight()) {
+        return 1;
+    }
+    if (!TestServerReplaysRetries()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/MCPSandTimerServer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using mcp_sandtimer::json::ParseError;
+using mcp_sandtimer::json::ParseLimits;
+using mcp_sandtimer::json::PushParser;
+using mcp_sandtimer::json::Value;
+
+const std::vector<std::string> kSeeds = {
+    R"({"jsonrpc":"2.0","id":1,"method":"tools/call","params":{"name":"start_timer","arguments":{"label":"tea","time":180}}})",
+    R"({"a":[1,-2.5e3,true,false,null,"x\"y\\zé😀"],"b":{"c":{"d":[[],{}]}}})",
+    R"([0,-0,1e-7,123456789012345,1234567890123456789,"",{"":""}])",
+};
+
+std::string Mutate(std::string input, std::mt19937& random) {
+    const std::string alphabet = "{}[]\",:\\-+.0123456789eEtrufalsn \t\r\nxu";
+    const int mutations = 1 + static_cast<int>(random() % 4);
+    for (int m = 0; m < mutations && !input.empty(); ++m) {
+        const std::size_t pos = random() % input.size();
+        switch (random() % 3) {
+            case 0:
+                input[pos] = alphabet[random() % alphabet.size()];
+                break;
+            case 1:
+                input.erase(pos, 1 + random() % 3);
+                break;
+            default:
+                input.insert(pos, 1, alphabet[random() % alphabet.size()]);
+                break;
+        }
+    }
+    return input;
+}
+
+// 随机变异种子文档：解析要么成功要么抛出 ParseError；成功时序列化结果可以再次解析且不变
+bool TestFuzzedInputs() {
+    std::mt19937 random(20240611);
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        const std::string input = Mutate(kSeeds[iteration % kSeeds.size()], random);
+        try {
+            const std::string dumped = Value::parse(input).dump();
+            if (Value::parse(dumped).dump() != dumped) {
+                std::cerr << "Round trip mismatch for input: " << input << std::endl;
+                return false;
+            }
+        } catch (const ParseError&) {
+        }
+    }
+    return true;
+}
+
+bool ExpectParseError(const std::string& input, const ParseLimits& limits, const std::string& what) {
+    try {
+        Value::parse(input.data(), input.size(), limits);
+    } catch (const ParseError&) {
+        return true;
+    }
+    std::cerr << "Expected ParseError for " << what << std::endl;
+    return false;
+}
+
+// 嵌套、负载与字符串上限；深度远超上限的输入也不会耗尽调用栈
+bool TestLimits() {
+    ParseLimits limits;
+    limits.max_depth = 8;
+    const std::string at_limit = std::string(8, '[') + std::string(8, ']');
+    if (Value::parse(at_limit.data(), at_limit.size(), limits).dump() != at_limit) {
+        std::cerr << "Nesting at the limit was rejected" << std::endl;
+        return false;
+    }
+    if (!ExpectParseError(std::string(9, '[') + std::string(9, ']'), limits, "depth 9")) {
+        return false;
+    }
+    const std::string hostile(1000000, '[');
+    if (!ExpectParseError(hostile, ParseLimits{}, "a million open brackets")) {
+        return false;
+    }
+    std::string deep_objects;
+    for (int i = 0; i < 200000; ++i) {
+        deep_objects += "{\"a\":";
+    }
+    if (!ExpectParseError(deep_objects, ParseLimits{}, "deep objects")) {
+        return false;
+    }
+
+    limits = ParseLimits{};
+    limits.max_string_length = 16;
+    if (!ExpectParseError("[\"" + std::string(17, 'x') + "\"]", limits, "long string") ||
+        !ExpectParseError("{\"" + std::string(17, 'k') + "\":1}", limits, "long key") ||
+        !ExpectParseError("\"" + std::string(10, 'x') + std::string(4, '\\') + "u00e9\\u00e9\\u00e9\"", limits,
+                          "long escaped string")) {
+        return false;
+    }
+    const std::string exact = "\"" + std::string(16, 'x') + "\"";
+    if (Value::parse(exact.data(), exact.size(), limits).as_string().size() != 16) {
+        std::cerr << "String at the limit was rejected" << std::endl;
+        return false;
+    }
+
+    limits = ParseLimits{};
+    limits.max_payload = 8;
+    if (!ExpectParseError("[1,2,3,4]", limits, "payload over the limit")) {
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::string> BatchParse(const std::string& input, const ParseLimits& limits) {
+    try {
+        return Value::parse(input.data(), input.size(), limits).dump();
+    } catch (const ParseError&) {
+        return std::nullopt;
+    }
+}
+
+// 按随机长度切块喂给 PushParser；顶层值之后仍有数据视为失败，与 Value::parse 的语义一致
+std::optional<std::string> ChunkedParse(PushParser& parser, const std::string& input, std::mt19937& random) {
+    parser.reset();
+    std::size_t pos = 0;
+    while (pos < input.size()) {
+        const std::size_t limit = random() % 8 == 0 ? 256 : 8;
+        const std::size_t size = std::min<std::size_t>(1 + random() % limit, input.size() - pos);
+        const PushParser::Status status = parser.feed(input.data() + pos, size);
+        if (status == PushParser::Status::Error ||
+            (status == PushParser::Status::Done && parser.consumed() < size)) {
+            return std::nullopt;
+        }
+        pos += size;
+    }
+    if (parser.finish() != PushParser::Status::Done) {
+        return std::nullopt;
+    }
+    try {
+        return parser.take_value().dump();
+    } catch (const ParseError&) {
+        return std::nullopt;  // 与 BatchParse 一样，非有限数字在序列化时拒绝
+    }
+}
+
+// 同一输入的任意切分方式与一次性解析结果相同（接受/拒绝以及解析出的值）
+bool TestChunkedEquivalence() {
+    std::mt19937 random(20240612);
+    ParseLimits limits;
+    limits.max_depth = 6;
+    limits.max_string_length = 24;
+    limits.max_payload = 160;
+    PushParser parser(limits);
+    std::vector<std::string> inputs = {"", " ", "0", "-", "1.", "1e", "-0.5E+3 ", "[1,]", "{\"a\":1,}", "\"\\ud83d\"",
+                                       "\"\\ud83d\\u0041\"", "tru", "nul", "[[[[[[]]]]]]", "[[[[[[[]]]]]]]"};
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        inputs.push_back(Mutate(kSeeds[iteration % kSeeds.size()], random));
+    }
+    for (const std::string& input : inputs) {
+        for (int split = 0; split < 3; ++split) {
+            const auto expected = BatchParse(input, limits);
+            const auto actual = ChunkedParse(parser, input, random);
+            if (expected != actual) {
+                std::cerr << "Chunked parse disagrees for input: " << input << " (" << expected.value_or("error")
+                          << " vs " << actual.value_or(parser.error()) << ")" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 一个块里包含多条消息时，feed 在第一条结束处停下，剩余字节交给下一轮
+bool TestPipelinedDocuments() {
+    const std::string input = "{\"id\":1} \n[2,\"x\"]\n";
+    PushParser parser;
+    if (parser.feed(input.data(), input.size()) != PushParser::Status::Done || parser.consumed() != 10 ||
+        parser.take_value().dump() != "{\"id\":1}") {
+        std::cerr << "First document was not split off: " << parser.consumed() << std::endl;
+        return false;
+    }
+    parser.reset();
+    const std::string rest = input.substr(10);
+    if (parser.feed(rest.data(), rest.size()) != PushParser::Status::Done || parser.consumed() != rest.size() ||
+        parser.take_value().dump() != "[2,\"x\"]") {
+        std::cerr << "Second document was not parsed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string Frame(const std::string& payload) {
+    return "Content-Length: " + std::to_string(payload.size()) + "\r\n\r\n" + payload;
+}
+
+// 超过上限的消息被跳过，随后的请求照常处理；声明巨大长度的头部不会触发分配
+bool TestServerLimits() {
+    const std::string big = R"({"jsonrpc":"2.0","id":1,"method":"ping","params":{"pad":")" + std::string(4096, 'x') + "\"}}";
+    const std::string ping = R"({"jsonrpc":"2.0","id":2,"method":"ping"})";
+    std::istringstream input(Frame(big) + Frame(ping) + "Content-Length: 99999999999999\r\n\r\n{}");
+    std::ostringstream output;
+    mcp_sandtimer::MCPSandTimerServer server(mcp_sandtimer::TimerClient("127.0.0.1", 1), input, output);
+    ParseLimits limits;
+    limits.max_payload = 1024;
+    server.SetParseLimits(limits);
+    server.Serve();
+
+    const std::string text = output.str();
+    if (text.find("\"id\":2") == std::string::npos || text.find("\"id\":1") != std::string::npos) {
+        std::cerr << "Unexpected responses: " << text << std::endl;
+        return false;
+    }
+
+    std::istringstream long_header(std::string(100000, 'X') + "\r\n\r\n" + Frame(ping));
+    std::ostringstream long_output;
+    mcp_sandtimer::MCPSandTimerServer other(mcp_sandtimer::TimerClient("127.0.0.1", 1), long_header, long_output);
+    other.Serve();
+    if (long_output.str().find("\"id\":2") == std::string::npos) {
+        std::cerr << "Server did not recover after an oversized header line" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestFuzzedInputs()) {
+        return 1;
+    }
+    if (!TestLimits()) {
+        return 1;
+    }
+    if (!TestChunkedEquivalence()) {
+        return 1;
+    }
+    if (!TestPipelinedDocuments()) {
+        return 1;
+    }
+    if (!TestServerLimits()) {
+        return 1;
+    }
+    return 0;
+}
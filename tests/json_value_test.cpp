@@ -0,0 +1,158 @@
+#include "mcp_sandtimer/Json.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using mcp_sandtimer::json::Value;
+
+// 拷贝共享对象/数组节点，修改时只克隆被修改的那一层
+bool TestCopyOnWrite() {
+    const Value original = Value::parse(R"({"schema":{"properties":{"label":{"type":"string"}}},"list":[1,2,3]})");
+    Value copy = original;
+    if (&std::as_const(copy).as_object() != &original.as_object()) {
+        std::cerr << "Copy did not share the object node" << std::endl;
+        return false;
+    }
+
+    copy.as_object()["added"] = Value(true);
+    if (original.find("added") != nullptr || copy.find("added") == nullptr) {
+        std::cerr << "Mutation leaked into the shared original" << std::endl;
+        return false;
+    }
+    // 外层已克隆，未修改的子树仍然共享
+    if (&copy.find("schema")->as_object() != &original.find("schema")->as_object()) {
+        std::cerr << "Unmodified subtree was cloned" << std::endl;
+        return false;
+    }
+
+    copy.as_object()["schema"].as_object()["properties"].as_object()["label"].as_object()["minLength"] = Value(1);
+    copy.as_object()["list"].as_array().push_back(Value(4));
+    const Value* label = original.find("schema")->find("properties")->find("label");
+    if (label->find("minLength") != nullptr || original.find("list")->as_array().size() != 3) {
+        std::cerr << "Nested mutation leaked into the shared original" << std::endl;
+        return false;
+    }
+    if (copy.dump() !=
+        R"({"added":true,"list":[1,2,3,4],"schema":{"properties":{"label":{"minLength":1,"type":"string"}}}})") {
+        std::cerr << "Unexpected copy contents: " << copy.dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 多个线程同时拷贝、序列化同一棵共享树（引用计数为原子操作）
+bool TestConcurrentSharing() {
+    const Value shared = Value::parse(R"({"tools":[{"name":"start_timer","inputSchema":{"type":"object"}}]})");
+    const std::string expected = shared.dump();
+    std::vector<std::thread> threads;
+    std::vector<bool> ok(4, true);
+    for (std::size_t t = 0; t < ok.size(); ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                Value response = mcp_sandtimer::json::make_object({{"result", shared}});
+                if (i % 100 == 0) {
+                    response.as_object()["result"].as_object()["extra"] = Value(i);
+                }
+                if (response.find("result")->find("tools")->dump() != shared.find("tools")->dump()) {
+                    ok[t] = false;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (bool result : ok) {
+        if (!result) {
+            std::cerr << "Concurrent copies observed a modified tree" << std::endl;
+            return false;
+        }
+    }
+    if (shared.dump() != expected) {
+        std::cerr << "Shared tree was modified" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 先取得可变引用再拷贝：副本复制一层，之后经由该引用的修改不会出现在副本中
+bool TestMutableReferenceDoesNotAlias() {
+    Value value = Value::parse(R"({"label":"tea"})");
+    Value::Object& members = value.as_object();
+    const Value copy = value;
+    members["time"] = Value(60);
+    if (copy.find("time") != nullptr || value.find("time") == nullptr) {
+        std::cerr << "Copy aliases a node that is still being mutated: " << copy.dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 旧的 make_object/make_array 写法仍可编译：std::pair 列表与 initializer_list<Value>
+bool TestLegacyBuilders() {
+    using mcp_sandtimer::json::make_array;
+    using mcp_sandtimer::json::make_object;
+    const std::initializer_list<std::pair<const std::string, Value>> members = {{"b", Value(2)}, {"a", Value(1)}};
+    const std::initializer_list<Value> items = {Value(1), Value("two")};
+    const Value object = make_object(members);
+    const Value pairs = make_object({std::pair<const std::string, Value>("k", Value(true))});
+    const Value array = make_array(items);
+    const Value braced = make_array({Value(1), Value(2)});
+    const Value modern = make_object({{"list", make_array(Value(1), Value(2))}});
+    if (object.dump() != R"({"a":1,"b":2})" || pairs.dump() != R"({"k":true})" || array.dump() != R"([1,"two"])" ||
+        braced.dump() != "[1,2]" || modern.dump() != R"({"list":[1,2]})") {
+        std::cerr << "Legacy builders produced unexpected values" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 其他线程读取并释放副本的同时修改原对象：被共享过的节点总是先克隆，不会原地修改
+bool TestMutateWhileCopiesAreReleased() {
+    for (int round = 0; round < 50; ++round) {
+        Value value = Value::parse(R"({"tools":[{"name":"start_timer"}],"count":0})");
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([copy = value]() mutable {
+                if (copy.find("tools")->dump() != R"([{"name":"start_timer"}])" || copy.find("count")->as_number() != 0) {
+                    std::cerr << "Reader observed a concurrent mutation" << std::endl;
+                    std::abort();
+                }
+                copy = Value();
+            });
+        }
+        value.as_object()["count"] = Value(round + 1);
+        value.as_object()["tools"].as_array().clear();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestCopyOnWrite()) {
+        return 1;
+    }
+    if (!TestConcurrentSharing()) {
+        return 1;
+    }
+    if (!TestMutableReferenceDoesNotAlias()) {
+        return 1;
+    }
+    if (!TestLegacyBuilders()) {
+        return 1;
+    }
+    if (!TestMutateWhileCopiesAreReleased()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "mcp_sandtimer/CommandCodec.h"
+#include "mcp_sandtimer/LabelTable.h"
+#include "mcp_sandtimer/TimerCommand.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// 统计全局 operator new 的调用次数，确认重复的 label 不再分配
+namespace {
+std::atomic<bool> counting{false};
+std::atomic<std::size_t> allocations{0};
+}  // namespace
+
+void* operator new(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+using mcp_sandtimer::Label;
+using mcp_sandtimer::LabelTable;
+
+// 同一 label 得到同一 ID，视图内容不变；空 label 固定为 0；find 不插入
+bool TestStableIds() {
+    LabelTable table;
+    const LabelTable::Id alpha = table.intern("alpha");
+    std::string scratch = "alpha";
+    const LabelTable::Id again = table.intern(scratch);
+    scratch = "overwritten";
+    if (alpha == 0 || again != alpha || table.view(alpha) != "alpha" || table.intern("beta") == alpha ||
+        table.intern("") != 0 || !table.view(0).empty()) {
+        std::cerr << "Interned IDs are not stable" << std::endl;
+        return false;
+    }
+    LabelTable::Id id = 0;
+    if (table.find("gamma", id) || table.stats().labels != 2 || !table.find("beta", id) || table.view(id) != "beta") {
+        std::cerr << "find() inserted or missed a label: " << table.stats().ToJson().dump() << std::endl;
+        return false;
+    }
+
+    const Label first("timer-1");
+    const Label second(std::string("timer-1"));
+    std::ostringstream out;
+    out << first;
+    if (first != second || first.view() != "timer-1" || out.str() != "timer-1" || Label("timer-2") == first ||
+        std::hash<Label>{}(first) != first.id() || !Label().empty() || Label("").id() != 0) {
+        std::cerr << "Label handles do not compare by ID" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 超过初始槽位与单个段的容量后，所有 ID 和视图仍然有效；超长 label 单独存放
+bool TestGrowth() {
+    LabelTable table;
+    constexpr int kLabels = 10000;
+    std::vector<LabelTable::Id> ids;
+    for (int i = 0; i < kLabels; ++i) {
+        ids.push_back(table.intern("label-" + std::to_string(i)));
+    }
+    const std::string long_label(100000, 'x');
+    const LabelTable::Id long_id = table.intern(long_label);
+    for (int i = 0; i < kLabels; ++i) {
+        const std::string expected = "label-" + std::to_string(i);
+        if (table.view(ids[i]) != expected || table.intern(expected) != ids[i]) {
+            std::cerr << "Label " << expected << " moved after growth" << std::endl;
+            return false;
+        }
+    }
+    const auto stats = table.stats();
+    if (table.view(long_id) != long_label || stats.labels != kLabels + 1 || stats.slots < 2 * stats.labels) {
+        std::cerr << "Unexpected stats after growth: " << stats.ToJson().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 多个线程以不同顺序并发驻留同一批 label，得到相同的 ID，且 ID 互不重复
+bool TestConcurrentIntern() {
+    LabelTable table;
+    constexpr int kThreads = 4;
+    constexpr int kLabels = 3000;
+    std::vector<std::vector<LabelTable::Id>> ids(kThreads, std::vector<LabelTable::Id>(kLabels));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&table, &ids, t] {
+            for (int n = 0; n < kLabels; ++n) {
+                const int i = t % 2 == 0 ? n : kLabels - 1 - n;
+                ids[t][i] = table.intern("shared-" + std::to_string(i));
+                LabelTable::Id found = 0;
+                if (!table.find("shared-" + std::to_string(i), found) || found != ids[t][i]) {
+                    ids[t][i] = 0;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::unordered_set<LabelTable::Id> distinct(ids[0].begin(), ids[0].end());
+    for (int t = 1; t < kThreads; ++t) {
+        if (ids[t] != ids[0]) {
+            std::cerr << "Threads disagree on interned IDs" << std::endl;
+            return false;
+        }
+    }
+    if (distinct.size() != kLabels || distinct.count(0) != 0 || table.stats().labels != kLabels) {
+        std::cerr << "Concurrent interning produced " << distinct.size() << " distinct IDs: "
+                  << table.stats().ToJson().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 已驻留的 label：构造命令、拷贝、编码与二进制解码都不分配内存
+bool TestRepeatedCommandsDoNotAllocate() {
+    const std::string text = "build-and-test";
+    const mcp_sandtimer::TimerCommand warm{mcp_sandtimer::TimerOp::Start, text, 90};
+    mcp_sandtimer::EncodedCommand binary;
+    mcp_sandtimer::EncodeCommand(warm, mcp_sandtimer::WireFormat::Binary, binary);
+
+    allocations.store(0);
+    counting.store(true);
+    bool decoded = true;
+    for (int i = 0; i < 1000; ++i) {
+        const mcp_sandtimer::TimerCommand command{mcp_sandtimer::TimerOp::Start, std::string_view(text), 90};
+        const mcp_sandtimer::TimerCommand copy = command;
+        mcp_sandtimer::EncodedCommand json;
+        mcp_sandtimer::EncodeCommand(copy, mcp_sandtimer::WireFormat::Json, json);
+        decoded = decoded && mcp_sandtimer::DecodeCommand(binary.view()).label == command.label;
+    }
+    counting.store(false);
+    if (allocations.load() != 0 || !decoded) {
+        std::cerr << "Repeated commands allocated " << allocations.load() << " times" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestStableIds()) {
+        return 1;
+    }
+    if (!TestGrowth()) {
+        return 1;
+    }
+    if (!TestConcurrentIntern()) {
+        return 1;
+    }
+    if (!TestRepeatedCommandsDoNotAllocate()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/Logger.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using mcp_sandtimer::LogLevel;
+using mcp_sandtimer::Logger;
+using mcp_sandtimer::json::Value;
+
+std::string TempLogPath(const std::string& name) {
+    auto path = std::filesystem::temp_directory_path() / ("mcp_sandtimer_" + name + ".jsonl");
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+std::vector<Value> ReadLines(const std::string& path) {
+    std::vector<Value> lines;
+    std::ifstream input(path);
+    std::string line;
+    while (std::getline(input, line)) {
+        lines.push_back(Value::parse(line));
+    }
+    return lines;
+}
+
+Logger::Options FileOptions(const std::string& path) {
+    Logger::Options options;
+    options.level = LogLevel::Info;
+    options.write_stderr = false;
+    options.file_path = path;
+    return options;
+}
+
+// 记录按级别过滤后以 JSON Lines 写入文件，字段完整且特殊字符被转义
+bool TestJsonLinesSink() {
+    const std::string path = TempLogPath("sink");
+    {
+        Logger logger;
+        logger.configure(FileOptions(path));
+        logger.debug("test.debug", "hidden");
+        logger.info("test.info", "Ignoring notification", "notifications/\"odd\"");
+        logger.error("test.error", "boom");
+        logger.flush();
+    }
+    const auto lines = ReadLines(path);
+    std::filesystem::remove(path);
+    if (lines.size() != 2) {
+        std::cerr << "Expected 2 log lines, got " << lines.size() << std::endl;
+        return false;
+    }
+    const auto& first = lines[0].as_object();
+    if (first.at("level").as_string() != "info" || first.at("event").as_string() != "test.info" ||
+        first.at("message").as_string() != "Ignoring notification" ||
+        first.at("detail").as_string() != "notifications/\"odd\"" || first.count("time") == 0) {
+        std::cerr << "Unexpected record: " << lines[0].dump() << std::endl;
+        return false;
+    }
+    if (lines[1].as_object().at("level").as_string() != "error") {
+        std::cerr << "Unexpected record: " << lines[1].dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 同一事件超过限额后只计数，刷新时补一条汇总
+bool TestRateLimit() {
+    const std::string path = TempLogPath("rate");
+    Logger::Stats stats;
+    {
+        Logger logger;
+        auto options = FileOptions(path);
+        options.rate_limit_per_second = 5;
+        logger.configure(options);
+        for (int i = 0; i < 100; ++i) {
+            logger.warn("test.repeated", "again");
+        }
+        logger.info("test.other", "unrelated");
+        logger.flush();
+        stats = logger.stats();
+    }
+    const auto lines = ReadLines(path);
+    std::filesystem::remove(path);
+    if (stats.suppressed != 95 || lines.size() != 7) {
+        std::cerr << "Unexpected rate limiting: " << stats.ToJson().dump() << ", " << lines.size() << " lines" << std::endl;
+        return false;
+    }
+    if (lines.back().as_object().at("message").as_string() != "Suppressed 95 repeated messages") {
+        std::cerr << "Missing suppression summary: " << lines.back().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 多个线程并发写入：每条记录要么写出要么计入 dropped，不会丢失或重复
+// 哈希落在同一个桶的两个事件各自限流，汇总记录分别写出各自的事件名
+bool TestRateLimitCollisions() {
+    const std::string path = TempLogPath("collide");
+    Logger::Stats stats;
+    {
+        Logger logger;
+        auto options = FileOptions(path);
+        options.rate_limit_per_second = 5;
+        logger.configure(options);
+        // 两个事件名的 FNV-1a 哈希对 64 取模相同
+        for (int i = 0; i < 10; ++i) {
+            logger.warn("test.first", "again");
+        }
+        for (int i = 0; i < 10; ++i) {
+            logger.warn("test.second.39", "again");
+        }
+        logger.flush();
+        stats = logger.stats();
+    }
+    const auto lines = ReadLines(path);
+    std::filesystem::remove(path);
+    if (stats.suppressed != 10 || lines.size() != 12) {
+        std::cerr << "Colliding events shared a limit: " << stats.ToJson().dump() << ", " << lines.size() << " lines"
+                  << std::endl;
+        return false;
+    }
+    std::vector<std::string> summaries;
+    for (const auto& line : lines) {
+        const auto& object = line.as_object();
+        if (object.at("message").as_string() == "Suppressed 5 repeated messages") {
+            summaries.push_back(object.at("event").as_string());
+        }
+    }
+    std::sort(summaries.begin(), summaries.end());
+    if (summaries != std::vector<std::string>{"test.first", "test.second.39"}) {
+        std::cerr << "Suppression summaries named the wrong events" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TestConcurrentProducers() {
+    const std::string path = TempLogPath("concurrent");
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 2000;
+    Logger::Stats stats;
+    {
+        Logger logger;
+        auto options = FileOptions(path);
+        options.rate_limit_per_second = 0;
+        logger.configure(options);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < kPerThread; ++i) {
+                    logger.info("test.concurrent", "message", std::to_string(t * kPerThread + i));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        logger.flush();
+        stats = logger.stats();
+    }
+    const auto lines = ReadLines(path);
+    std::filesystem::remove(path);
+    if (stats.written + stats.dropped != kThreads * kPerThread || lines.size() != stats.written) {
+        std::cerr << "Lost records: " << stats.ToJson().dump() << ", " << lines.size() << " lines" << std::endl;
+        return false;
+    }
+    std::vector<bool> seen(kThreads * kPerThread, false);
+    for (const auto& line : lines) {
+        const int index = std::stoi(line.as_object().at("detail").as_string());
+        if (seen[index]) {
+            std::cerr << "Duplicate record " << index << std::endl;
+            return false;
+        }
+        seen[index] = true;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestJsonLinesSink()) {
+        return 1;
+    }
+    if (!TestRateLimit()) {
+        return 1;
+    }
+    if (!TestRateLimitCollisions()) {
+        return 1;
+    }
+    if (!TestConcurrentProducers()) {
+        return 1;
+    }
+    return 0;
+}
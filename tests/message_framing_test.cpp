@@ -0,0 +1,129 @@
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/MCPSandTimerServer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+using mcp_sandtimer::MCPSandTimerServer;
+using mcp_sandtimer::MessageFraming;
+using mcp_sandtimer::json::Value;
+
+// 每次 underflow 只提供几个字节，模拟消息被拆成多次 read 到达
+class TricklingBuffer : public std::streambuf {
+public:
+    TricklingBuffer(std::string data, std::size_t step) : data_(std::move(data)), step_(step) {}
+
+protected:
+    int_type underflow() override {
+        if (position_ >= data_.size()) {
+            return traits_type::eof();
+        }
+        const std::size_t size = std::min(step_, data_.size() - position_);
+        std::memcpy(window_, data_.data() + position_, size);
+        position_ += size;
+        setg(window_, window_, window_ + size);
+        return traits_type::to_int_type(window_[0]);
+    }
+
+private:
+    std::string data_;
+    std::size_t step_;
+    std::size_t position_ = 0;
+    char window_[64];
+};
+
+std::string Ping(int id) {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) + R"(,"method":"ping"})";
+}
+
+std::string Serve(std::istream& input, MessageFraming* detected = nullptr,
+                  const mcp_sandtimer::json::ParseLimits& limits = {}) {
+    std::ostringstream output;
+    MCPSandTimerServer server(mcp_sandtimer::TimerClient("127.0.0.1", 1), input, output);
+    server.SetParseLimits(limits);
+    server.Serve();
+    if (detected != nullptr) {
+        *detected = server.framing();
+    }
+    return output.str();
+}
+
+std::vector<Value> ParseLines(const std::string& text) {
+    std::vector<Value> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines.push_back(Value::parse(line));
+    }
+    return lines;
+}
+
+// 首字节为 '{' 时按 NDJSON 处理：空行、CRLF、无结尾换行都可接受，回复每行一条且不带头部
+bool TestNdjsonDetected() {
+    for (std::size_t step : {std::size_t{1}, std::size_t{5}, std::size_t{64}}) {
+        TricklingBuffer buffer("\n" + Ping(1) + "\n\n  " + Ping(2) + "\r\n" + "{not json}\n" + Ping(3), step);
+        std::istream input(&buffer);
+        MessageFraming framing = MessageFraming::Auto;
+        const std::string output = Serve(input, &framing);
+        if (framing != MessageFraming::Ndjson || output.find("Content-Length") != std::string::npos) {
+            std::cerr << "NDJSON input was not answered with NDJSON: " << output << std::endl;
+            return false;
+        }
+        const auto lines = ParseLines(output);
+        if (lines.size() != 3 || lines[0].find("id")->as_number() != 1 || lines[2].find("id")->as_number() != 3) {
+            std::cerr << "Unexpected NDJSON responses (step " << step << "): " << output << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 以头部开头的流仍按 Content-Length 分帧读写
+bool TestContentLengthDetected() {
+    const std::string ping = Ping(7);
+    std::istringstream input("Content-Length: " + std::to_string(ping.size()) + "\r\n\r\n" + ping);
+    MessageFraming framing = MessageFraming::Auto;
+    const std::string output = Serve(input, &framing);
+    if (framing != MessageFraming::ContentLength || output.rfind("Content-Length: ", 0) != 0 ||
+        output.find("\"id\":7") == std::string::npos) {
+        std::cerr << "Unexpected Content-Length response: " << output << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 超过上限的行被整行丢弃，缓冲区不随之增长，后续消息照常处理
+bool TestOversizedLineSkipped() {
+    mcp_sandtimer::json::ParseLimits limits;
+    limits.max_payload = 256;
+    const std::string big = R"({"jsonrpc":"2.0","id":1,"method":"ping","params":{"pad":")" + std::string(200000, 'x') + "\"}}";
+    std::istringstream input(big + "\n" + Ping(2) + "\n");
+    const auto lines = ParseLines(Serve(input, nullptr, limits));
+    if (lines.size() != 1 || lines[0].find("id")->as_number() != 2) {
+        std::cerr << "Oversized line was not skipped" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestNdjsonDetected()) {
+        return 1;
+    }
+    if (!TestContentLengthDetected()) {
+        return 1;
+    }
+    if (!TestOversizedLineSkipped()) {
+        return 1;
+    }
+    return 0;
+}
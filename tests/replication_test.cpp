@@ -0,0 +1,133 @@
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::ReplicationPolicy;
+using mcp_sandtimer::TimerEndpoint;
+using mcp_sandtimer::TimerOp;
+using mcp_sandtimer::testing::StubSandtimer;
+
+using Stubs = std::vector<std::unique_ptr<StubSandtimer>>;
+
+Stubs MakeStubs(int count, std::vector<TimerEndpoint>& endpoints) {
+    Stubs stubs;
+    for (int i = 0; i < count; ++i) {
+        stubs.push_back(std::make_unique<StubSandtimer>());
+        endpoints.push_back({"127.0.0.1", stubs.back()->port()});
+    }
+    return stubs;
+}
+
+// 策略 all：每个副本都收到全部命令，顺序与发送顺序一致
+bool TestAllReplicasReceive() {
+    std::vector<TimerEndpoint> endpoints;
+    const Stubs stubs = MakeStubs(3, endpoints);
+    mcp_sandtimer::TimerClient client("127.0.0.1", 1, std::chrono::milliseconds(2000));
+    client.set_replicas(endpoints, ReplicationPolicy::All);
+    client.start_timer("tea", 180);
+    client.reset_timer("tea");
+    client.cancel_timer("tea");
+    for (const auto& stub : stubs) {
+        if (!stub->wait_for_messages(3, std::chrono::milliseconds(2000))) {
+            std::cerr << "Replica did not receive every command" << std::endl;
+            return false;
+        }
+        const auto commands = stub->commands();
+        if (commands[0].op != TimerOp::Start || commands[1].op != TimerOp::Reset || commands[2].op != TimerOp::Cancel) {
+            std::cerr << "Replica received commands out of order" << std::endl;
+            return false;
+        }
+    }
+    const auto metrics = client.metrics();
+    const auto& replicas = metrics.find("replicas")->as_array();
+    if (metrics.find("replicationPolicy")->as_string() != "all" || replicas.size() != 3) {
+        std::cerr << "Unexpected replication metrics: " << metrics.dump() << std::endl;
+        return false;
+    }
+    for (const auto& replica : replicas) {
+        if (replica.find("delivered")->as_number() != 3 || replica.find("failed")->as_number() != 0 ||
+            replica.find("meanLatencyMs")->as_number() < 0 || replica.find("maxLatencyMs") == nullptr) {
+            std::cerr << "Unexpected replica metrics: " << replica.dump() << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 策略 first：一个副本连接挂起时，调用随最快的副本返回，而不是等到超时
+bool TestFirstAckIgnoresSlowReplica() {
+    mcp_sandtimer::testing::BlackHoleListener black_hole("127.0.0.1");
+    StubSandtimer stub;
+    mcp_sandtimer::TimerClient client("127.0.0.1", 1, std::chrono::milliseconds(3000));
+    client.set_replicas({{"127.0.0.1", black_hole.port()}, {"127.0.0.1", stub.port()}}, ReplicationPolicy::FirstAck);
+    const auto start = std::chrono::steady_clock::now();
+    client.start_timer("fast", 10);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed > std::chrono::milliseconds(1500)) {
+        std::cerr << "First-ack send waited for the slow replica" << std::endl;
+        return false;
+    }
+    if (!stub.wait_for_messages(1, std::chrono::milliseconds(2000))) {
+        std::cerr << "Fast replica did not receive the command" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 一个副本不可达：quorum 仍然成功；all 抛出异常，但可达的副本照常收到命令
+bool TestDeadReplica() {
+    std::vector<TimerEndpoint> endpoints;
+    const Stubs stubs = MakeStubs(3, endpoints);
+    stubs[0]->stop();
+    mcp_sandtimer::TimerClient client("127.0.0.1", 1, std::chrono::milliseconds(2000));
+    client.set_replicas(endpoints, ReplicationPolicy::Quorum);
+    client.start_timer("quorum", 60);
+
+    client.set_replicas(endpoints, ReplicationPolicy::All);
+    try {
+        client.start_timer("all", 60);
+        std::cerr << "Send with policy 'all' succeeded despite a dead replica" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::TimerClientError& error) {
+        if (std::string(error.what()).find("2 of 3") == std::string::npos) {
+            std::cerr << "Unexpected error: " << error.what() << std::endl;
+            return false;
+        }
+    }
+    for (std::size_t i = 1; i < stubs.size(); ++i) {
+        if (!stubs[i]->wait_for_messages(2, std::chrono::milliseconds(2000))) {
+            std::cerr << "Live replica " << i << " missed a command" << std::endl;
+            return false;
+        }
+    }
+    const auto metrics = client.metrics();
+    const auto& dead = metrics.find("replicas")->as_array()[0];
+    if (dead.find("failed")->as_number() != 1 || dead.find("delivered")->as_number() != 0) {
+        std::cerr << "Dead replica metrics are wrong: " << dead.dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestAllReplicasReceive()) {
+        return 1;
+    }
+    if (!TestFirstAckIgnoresSlowReplica()) {
+        return 1;
+    }
+    if (!TestDeadReplica()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "mcp_sandtimer/Logger.h"
+#include "mcp_sandtimer/MCPSandTimerServer.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+// 统计全局 operator new 的调用次数，用来确认请求路径没有深拷贝消息树
+namespace {
+std::atomic<bool> counting{false};
+std::atomic<std::size_t> allocations{0};
+}  // namespace
+
+void* operator new(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+using mcp_sandtimer::json::Value;
+
+std::string Frame(const std::string& payload) {
+    return "Content-Length: " + std::to_string(payload.size()) + "\r\n\r\n" + payload;
+}
+
+template <typename Fn>
+std::size_t CountAllocations(Fn&& fn) {
+    allocations.store(0);
+    counting.store(true);
+    fn();
+    counting.store(false);
+    return allocations.load();
+}
+
+// 一次 tools/call 的开销扣除解析本身后，应当与 params/arguments 的大小无关
+std::size_t DispatchAllocations(const std::string& payload) {
+    mcp_sandtimer::TimerClient client("127.0.0.1", 1);
+    std::istringstream input(Frame(payload));
+    std::ostringstream output;
+    mcp_sandtimer::MCPSandTimerServer server(client, input, output);
+    server.registry().register_tool(
+        mcp_sandtimer::ToolDefinition{"inspect", "Accepts anything.", Value::parse(R"({"type":"object"})")},
+        [](const Value& arguments) { return arguments.find("label") != nullptr ? std::string("ok") : std::string("no"); });
+
+    const std::size_t serve = CountAllocations([&] { server.Serve(); });
+    const std::size_t parse = CountAllocations([&] { Value::parse(payload); });
+    if (output.str().find("\"text\":\"ok\"") == std::string::npos) {
+        std::cerr << "Unexpected response: " << output.str() << std::endl;
+        return 0;
+    }
+    return serve - parse;
+}
+
+std::string MakeCall(int extra_members) {
+    std::string bulk;
+    for (int i = 0; i < extra_members; ++i) {
+        bulk += ",\"field_" + std::to_string(i) + "\":{\"nested\":[\"a string long enough to need the heap\",1,2,3]}";
+    }
+    return R"({"jsonrpc":"2.0","id":1,"method":"tools/call","params":{"name":"inspect","_meta":{"trace":"x")" + bulk +
+           R"(},"arguments":{"label":"demo")" + bulk + "}}}";
+}
+
+bool TestNoCopiesOnRequestPath() {
+    const std::size_t small = DispatchAllocations(MakeCall(0));
+    const std::size_t large = DispatchAllocations(MakeCall(200));
+    if (small == 0 || small != large) {
+        std::cerr << "Request path allocations depend on message size: " << small << " vs " << large << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 移出 API 转移所有权后原值变为 null，且不重新分配
+bool TestTakeApi() {
+    Value message = Value::parse(R"({"params":{"label":"a label that does not fit in SSO"}})");
+    const Value* label = message.find("params")->find("label");
+    const char* data = label->as_string().data();
+    Value::Object params = message.as_object()["params"].take_object();
+    std::string text = params["label"].take_string();
+    if (text.data() != data || !params["label"].is_null() || !message.find("params")->is_null()) {
+        std::cerr << "take_* did not move the storage" << std::endl;
+        return false;
+    }
+    if (message.find("missing") != nullptr || Value(1).find("x") != nullptr) {
+        std::cerr << "find() returned a member that does not exist" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// make_object / make_array 移动临时子树，字符串右值直接接管存储
+bool TestBuildersMove() {
+    Value schema = Value::parse(R"({"properties":{"label":{"description":"a description long enough for the heap"}}})");
+    const char* data = schema.find("properties")->find("label")->find("description")->as_string().data();
+    std::string text = "another string that does not fit in SSO";
+    const char* text_data = text.data();
+
+    Value result;
+    const std::size_t count = CountAllocations([&] {
+        result = mcp_sandtimer::json::make_object({
+            {"inputSchema", std::move(schema)},
+            {"items", mcp_sandtimer::json::make_array(Value(std::move(text)), Value(1))}
+        });
+    });
+    const Value* moved = result.find("inputSchema")->find("properties")->find("label")->find("description");
+    if (moved->as_string().data() != data || result.find("items")->as_array()[0].as_string().data() != text_data) {
+        std::cerr << "Builders copied a subtree or string" << std::endl;
+        return false;
+    }
+    // 外层对象与 items 数组各自的节点，没有额外的深拷贝
+    if (count > 6) {
+        std::cerr << "Builders allocated " << count << " times" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    // 日志单例的一次性初始化不计入第一次测量
+    mcp_sandtimer::Logger::instance();
+    if (!TestNoCopiesOnRequestPath()) {
+        return 1;
+    }
+    if (!TestTakeApi()) {
+        return 1;
+    }
+    if (!TestBuildersMove()) {
+        return 1;
+    }
+    return 0;
+}
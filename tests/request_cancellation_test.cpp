@@ -0,0 +1,250 @@
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/MCPSandTimerServer.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "PipeBuffer.h"
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::MCPSandTimerServer;
+using mcp_sandtimer::TimerClient;
+using mcp_sandtimer::json::Value;
+using mcp_sandtimer::testing::PipeBuffer;
+using std::chrono::milliseconds;
+using clock_type = std::chrono::steady_clock;
+
+std::string StartCall(int id, const std::string& meta = "") {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) +
+           R"(,"method":"tools/call","params":{"name":"start_timer","arguments":{"label":"tea","time":60})" + meta +
+           "}}\n";
+}
+
+std::vector<Value> ParseLines(const std::string& text) {
+    std::vector<Value> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines.push_back(Value::parse(line));
+    }
+    return lines;
+}
+
+const Value* FindResponse(const std::vector<Value>& lines, int id) {
+    for (const auto& line : lines) {
+        const Value* value = line.find("id");
+        if (value != nullptr && value->is_number() && value->as_number() == id) {
+            return &line;
+        }
+    }
+    return nullptr;
+}
+
+int ErrorCode(const Value* response) {
+    const Value* error = response != nullptr ? response->find("error") : nullptr;
+    return error != nullptr ? static_cast<int>(error->find("code")->as_number()) : 0;
+}
+
+// 连接挂在黑洞地址上时收到取消通知：在途连接被放弃并立即回复取消错误；之后的请求按顺序回复
+bool TestCancelInFlightCall() {
+    mcp_sandtimer::testing::BlackHoleListener black_hole("127.0.0.1");
+    PipeBuffer buffer;
+    std::istream input(&buffer);
+    std::ostringstream output;
+    MCPSandTimerServer server(TimerClient("127.0.0.1", black_hole.port(), milliseconds{5000}), input, output);
+    server.SetWorkerCount(4);
+    std::thread serving([&] { server.Serve(); });
+
+    buffer.write(StartCall(1));
+    buffer.write(R"({"jsonrpc":"2.0","id":2,"method":"ping"})" "\n");
+    std::this_thread::sleep_for(milliseconds{200});
+    const auto cancelled_at = clock_type::now();
+    buffer.write(R"({"jsonrpc":"2.0","method":"notifications/cancelled","params":{"requestId":1,"reason":"user"}})" "\n");
+    buffer.close();
+    serving.join();
+    const auto elapsed = clock_type::now() - cancelled_at;
+
+    const auto lines = ParseLines(output.str());
+    if (ErrorCode(FindResponse(lines, 1)) != -32800 || FindResponse(lines, 2) == nullptr) {
+        std::cerr << "Unexpected responses: " << output.str() << std::endl;
+        return false;
+    }
+    if (lines.front().find("id")->as_number() != 1) {
+        std::cerr << "ping was answered before the pending tools/call" << std::endl;
+        return false;
+    }
+    if (elapsed > milliseconds{1000}) {
+        std::cerr << "Cancellation took " << std::chrono::duration_cast<milliseconds>(elapsed).count() << " ms"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 客户端 _meta.timeoutMs 与服务端默认截止时间都会缩短请求，先到者生效；默认的同步执行同样适用
+bool TestDeadlines() {
+    mcp_sandtimer::testing::BlackHoleListener black_hole("127.0.0.1");
+    std::istringstream input(StartCall(1, R"(,"_meta":{"timeoutMs":100})") + StartCall(2));
+    std::ostringstream output;
+    MCPSandTimerServer server(TimerClient("127.0.0.1", black_hole.port(), milliseconds{5000}), input, output);
+    server.SetRequestTimeout(milliseconds{300});
+    const auto begin = clock_type::now();
+    server.Serve();
+    const auto elapsed = clock_type::now() - begin;
+
+    const auto lines = ParseLines(output.str());
+    if (ErrorCode(FindResponse(lines, 1)) != -32003 || ErrorCode(FindResponse(lines, 2)) != -32003) {
+        std::cerr << "Expected deadline errors: " << output.str() << std::endl;
+        return false;
+    }
+    if (elapsed > milliseconds{2000}) {
+        std::cerr << "Deadlines were not enforced" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 多个工作线程时，同一 label 的命令仍按到达顺序发往 sandtimer
+bool TestPerLabelOrder() {
+    mcp_sandtimer::testing::StubSandtimer stub;
+    constexpr int kLabels = 100;
+    std::string requests;
+    for (int i = 0; i < kLabels; ++i) {
+        const std::string label = "L" + std::to_string(i);
+        requests += R"({"jsonrpc":"2.0","id":)" + std::to_string(2 * i) +
+                    R"(,"method":"tools/call","params":{"name":"start_timer","arguments":{"label":")" + label +
+                    R"(","time":60}}})" "\n";
+        requests += R"({"jsonrpc":"2.0","id":)" + std::to_string(2 * i + 1) +
+                    R"(,"method":"tools/call","params":{"name":"cancel_timer","arguments":{"label":" )" + label +
+                    R"("}}})" "\n";
+    }
+    std::istringstream input(requests);
+    std::ostringstream output;
+    TimerClient client("127.0.0.1", stub.port(), milliseconds{5000});
+    client.set_min_timeout(milliseconds{2000});  // 机器繁忙时按往返时间估计的连接超时可能过短，这里只检查顺序
+    MCPSandTimerServer server(std::move(client), input, output);
+    server.SetWorkerCount(4);
+    server.Serve();
+
+    stub.wait_for_messages(2 * kLabels, milliseconds{5000});
+    const auto messages = stub.messages();
+    std::vector<int> started(kLabels, -1);
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        const Value command = Value::parse(messages[i]);
+        const int label = std::stoi(command.find("label")->as_string().substr(1));
+        if (command.find("cmd")->as_string() == "start") {
+            started[label] = static_cast<int>(i);
+        } else if (started[label] < 0) {
+            std::cerr << "cancel for L" << label << " reached sandtimer before its start" << std::endl;
+            return false;
+        }
+    }
+    if (messages.size() != 2 * kLabels) {
+        std::cerr << "Expected " << 2 * kLabels << " commands, got " << messages.size() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// shutdown 等之前的请求执行完后回复，之后不再读取：输入未关闭时 Serve() 也会返回，后续消息不被处理
+bool TestShutdownStopsReading() {
+    mcp_sandtimer::testing::StubSandtimer stub;
+    PipeBuffer buffer;
+    std::istream input(&buffer);
+    std::ostringstream output;
+    MCPSandTimerServer server(TimerClient("127.0.0.1", stub.port(), milliseconds{5000}), input, output);
+    server.SetWorkerCount(4);
+    std::mutex mutex;
+    std::condition_variable stopped_cv;
+    bool stopped = false;
+    std::thread serving([&] {
+        server.Serve();
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+        stopped_cv.notify_all();
+    });
+
+    buffer.write(StartCall(1) + R"({"jsonrpc":"2.0","id":2,"method":"shutdown"})" "\n");
+    bool returned = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        returned = stopped_cv.wait_for(lock, std::chrono::seconds{5}, [&] { return stopped; });
+    }
+    buffer.write(R"({"jsonrpc":"2.0","id":3,"method":"ping"})" "\n");
+    buffer.close();
+    serving.join();
+    if (!returned) {
+        std::cerr << "Serve() kept reading after shutdown" << std::endl;
+        return false;
+    }
+
+    const auto lines = ParseLines(output.str());
+    if (lines.size() != 2 || lines[0].find("id")->as_number() != 1 || lines[1].find("id")->as_number() != 2 ||
+        ErrorCode(&lines[0]) != 0) {
+        std::cerr << "Unexpected responses around shutdown: " << output.str() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 调用方的截止时间与取消不代表端点故障，不应使熔断器打开
+bool TestAbandonedCallsDoNotTripBreaker() {
+    mcp_sandtimer::testing::BlackHoleListener black_hole("127.0.0.1");
+    TimerClient client("127.0.0.1", black_hole.port(), milliseconds{5000});
+    const mcp_sandtimer::TimerCommand command{mcp_sandtimer::TimerOp::Start, "tea", 60};
+    for (int i = 0; i < 5; ++i) {
+        mcp_sandtimer::CallOptions options;
+        options.deadline = clock_type::now() + milliseconds{30};
+        try {
+            client.send(command, options);
+            std::cerr << "Send to a black hole succeeded" << std::endl;
+            return false;
+        } catch (const mcp_sandtimer::DeadlineExceededError&) {
+        }
+    }
+    mcp_sandtimer::CancellationToken token;
+    token.cancel();
+    mcp_sandtimer::CallOptions options;
+    options.cancellation = &token;
+    try {
+        client.send(command, options);
+        return false;
+    } catch (const mcp_sandtimer::RequestCancelledError&) {
+    }
+    if (client.breaker_state() != mcp_sandtimer::CircuitBreaker::State::Closed) {
+        std::cerr << "Abandoned calls opened the circuit breaker" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestCancelInFlightCall()) {
+        return 1;
+    }
+    if (!TestDeadlines()) {
+        return 1;
+    }
+    if (!TestPerLabelOrder()) {
+        return 1;
+    }
+    if (!TestShutdownStopsReading()) {
+        return 1;
+    }
+    if (!TestAbandonedCallsDoNotTripBreaker()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "mcp_sandtimer/RttEstimator.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::RttEstimator;
+using std::chrono::milliseconds;
+
+// 样本按 RFC 6298 平滑；超时翻倍退避，新样本恢复；结果裁剪到上下限
+bool TestEstimator() {
+    RttEstimator estimator;
+    if (estimator.timeout(milliseconds{10}, milliseconds{5000}) != milliseconds{5000}) {
+        std::cerr << "Estimator without samples should use the upper bound" << std::endl;
+        return false;
+    }
+    estimator.record_sample(milliseconds{100});
+    auto stats = estimator.stats();
+    // 第一个样本：SRTT = R，RTTVAR = R/2，超时 = R + 4·R/2
+    if (stats.srtt_ms != 100 || stats.rttvar_ms != 50 ||
+        estimator.timeout(milliseconds{10}, milliseconds{5000}) != milliseconds{300}) {
+        std::cerr << "Unexpected first sample: " << stats.ToJson().dump() << std::endl;
+        return false;
+    }
+    estimator.record_sample(milliseconds{60});
+    stats = estimator.stats();
+    // RTTVAR = 3/4·50 + 1/4·40 = 47.5，SRTT = 7/8·100 + 1/8·60 = 95
+    if (std::abs(stats.srtt_ms - 95) > 0.01 || std::abs(stats.rttvar_ms - 47.5) > 0.01 ||
+        estimator.timeout(milliseconds{10}, milliseconds{5000}) != milliseconds{285}) {
+        std::cerr << "Unexpected second sample: " << stats.ToJson().dump() << std::endl;
+        return false;
+    }
+    estimator.record_timeout();
+    estimator.record_timeout();
+    if (estimator.timeout(milliseconds{10}, milliseconds{5000}) != milliseconds{1140} ||
+        estimator.timeout(milliseconds{10}, milliseconds{1000}) != milliseconds{1000}) {
+        std::cerr << "Timeouts did not back off: " << estimator.stats().ToJson().dump() << std::endl;
+        return false;
+    }
+    estimator.record_sample(milliseconds{95});
+    if (estimator.stats().backoff != 0 || estimator.timeout(milliseconds{10}, milliseconds{5000}) >= milliseconds{300}) {
+        std::cerr << "A new sample did not clear the backoff" << std::endl;
+        return false;
+    }
+    // 本机往返只有几十微秒，超时取下限；下限高于上限时以上限为准
+    RttEstimator local;
+    for (int i = 0; i < 8; ++i) {
+        local.record_sample(std::chrono::microseconds{50});
+    }
+    if (local.timeout(milliseconds{20}, milliseconds{5000}) != milliseconds{20} ||
+        local.timeout(milliseconds{200}, milliseconds{100}) != milliseconds{100}) {
+        std::cerr << "Bounds were not applied: " << local.stats().ToJson().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 端点学到本机的往返时间后突然不再响应：超时后重连一次（超时翻倍），
+// 失败在一两百毫秒内报告，而不是等满静态超时
+bool TestFailsFastOnHealthyHost() {
+    mcp_sandtimer::testing::StubSandtimer stub;
+    const std::uint16_t port = stub.port();
+    mcp_sandtimer::TimerClient client("127.0.0.1", port, milliseconds(5000));
+    for (int i = 0; i < 20; ++i) {
+        client.start_timer("warm-" + std::to_string(i), 60);
+    }
+    const auto metrics = client.metrics();
+    const auto* rtt = metrics.find("rtt");
+    // 偶尔丢失 SYN 的连接重连后送达，按 Karn 算法不计样本
+    if (rtt == nullptr || rtt->find("samples")->as_number() < 15 ||
+        rtt->find("effectiveTimeoutMs")->as_number() >= 5000) {
+        std::cerr << "Unexpected RTT metrics after warm-up: " << metrics.dump() << std::endl;
+        return false;
+    }
+    const double learned = rtt->find("effectiveTimeoutMs")->as_number();
+
+    stub.stop();
+    mcp_sandtimer::testing::BlackHoleListener black_hole("127.0.0.1", port);
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        client.start_timer("stalled", 60);
+        std::cerr << "Send to a black hole succeeded" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::TimerClientError&) {
+    }
+    const auto elapsed = std::chrono::duration_cast<milliseconds>(std::chrono::steady_clock::now() - start);
+    if (elapsed.count() < learned - 1 || elapsed > milliseconds(1500)) {
+        std::cerr << "Failure took " << elapsed.count() << " ms with a learned timeout of " << learned << " ms"
+                  << std::endl;
+        return false;
+    }
+    // 异步投递同样按退避后的估计超时失败；每次超时（含重连前的那次）都使估计翻倍
+    try {
+        client.start_timer_async("stalled-async", 60).get();
+        std::cerr << "Async send to a black hole succeeded" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::TimerClientError&) {
+    }
+    const auto after = client.metrics();
+    if (std::chrono::steady_clock::now() - start > milliseconds(3000) ||
+        after.find("rtt")->find("timeouts")->as_number() < 4 || after.find("rtt")->find("backoff")->as_number() != 4) {
+        std::cerr << "Unexpected RTT metrics after timeouts: " << after.dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestEstimator()) {
+        return 1;
+    }
+    if (!TestFailsFastOnHealthyHost()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "mcp_sandtimer/SchemaValidator.h"
+#include "mcp_sandtimer/ToolDefinition.h"
+#include "mcp_sandtimer/ToolRegistry.h"
+
+#include <iostream>
+#include <string>
+
+namespace {
+
+using mcp_sandtimer::ValidationError;
+using mcp_sandtimer::json::Value;
+
+bool Expect(const mcp_sandtimer::SchemaValidator& validator, const std::string& arguments, bool valid,
+            const std::string& path = "") {
+    ValidationError error;
+    const bool result = validator.validate(Value::parse(arguments), &error);
+    if (result != valid || (!valid && error.path != path)) {
+        std::cerr << "Validation of " << arguments << " returned " << result << " at '" << error.path
+                  << "' (" << error.message << "), expected " << valid << " at '" << path << "'" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    // 注册表在注册时编译 schema
+    mcp_sandtimer::ToolRegistry registry;
+    registry.register_tool(*mcp_sandtimer::FindToolDefinition("start_timer"), [](const Value&) { return std::string(); });
+    const auto* start = registry.find_tool("start_timer");
+    if (start == nullptr || start->validator.empty()) {
+        std::cerr << "start_timer schema was not compiled" << std::endl;
+        return 1;
+    }
+    const auto& validator = start->validator;
+    bool ok = Expect(validator, R"({"label":"tea","time":180})", true);
+    ok = Expect(validator, R"({"label":"tea"})", false, "/time") && ok;
+    ok = Expect(validator, R"({"label":"tea","time":0.5})", false, "/time") && ok;
+    ok = Expect(validator, R"({"label":"","time":5})", false, "/label") && ok;
+    ok = Expect(validator, R"({"label":7,"time":5})", false, "/label") && ok;
+    ok = Expect(validator, R"({"label":"tea","time":5,"color":"red"})", false, "/color") && ok;
+    ok = Expect(validator, R"([])", false, "") && ok;
+
+    // 修改 input_schema 后重新注册，校验随之更新
+    auto relaxed = *mcp_sandtimer::FindToolDefinition("start_timer");
+    relaxed.input_schema = Value::parse(R"({"type":"object","properties":{"label":{"type":"string"}}})");
+    registry.register_tool(relaxed, [](const Value&) { return std::string(); });
+    ok = Expect(registry.find_tool("start_timer")->validator, R"({"label":"tea"})", true) && ok;
+
+    // 嵌套对象与数组的错误路径
+    const auto nested = mcp_sandtimer::SchemaValidator::compile(Value::parse(R"({
+        "type": "object",
+        "properties": {
+            "steps": {"type": "array", "items": {
+                "type": "object",
+                "properties": {"a/b": {"type": "integer", "maximum": 10}},
+                "required": ["a/b"]
+            }}
+        }
+    })"));
+    ok = Expect(nested, R"({"steps":[{"a/b":1},{"a/b":2}]})", true) && ok;
+    ok = Expect(nested, R"({"steps":[{"a/b":1},{"a/b":2.5}]})", false, "/steps/1/a~1b") && ok;
+    ok = Expect(nested, R"({"steps":[{"a/b":11}]})", false, "/steps/0/a~1b") && ok;
+    ok = Expect(nested, R"({"steps":[{}]})", false, "/steps/0/a~1b") && ok;
+
+    try {
+        mcp_sandtimer::SchemaValidator::compile(Value::parse(R"({"type":"object","required":["missing"]})"));
+        std::cerr << "Undeclared required property was accepted" << std::endl;
+        ok = false;
+    } catch (const mcp_sandtimer::SchemaError&) {
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+#include "mcp_sandtimer/HashRing.h"
+#include "mcp_sandtimer/TimerClient.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::HashRing;
+using mcp_sandtimer::TimerOp;
+
+constexpr int kLabels = 20000;
+
+std::vector<std::string> Nodes(int count) {
+    std::vector<std::string> nodes;
+    for (int i = 0; i < count; ++i) {
+        nodes.push_back("10.0.0." + std::to_string(i + 1) + ":61420");
+    }
+    return nodes;
+}
+
+// 四个端点各自分到大致相同的 label，环上占据的比例与实际分配一致
+bool TestBalance() {
+    const HashRing ring(Nodes(4));
+    std::vector<int> counts(4, 0);
+    for (int i = 0; i < kLabels; ++i) {
+        ++counts[ring.locate("timer-" + std::to_string(i))];
+    }
+    const std::vector<double> shares = ring.ownership();
+    for (std::size_t node = 0; node < counts.size(); ++node) {
+        const double fraction = static_cast<double>(counts[node]) / kLabels;
+        if (fraction < 0.18 || fraction > 0.32 || shares[node] < 0.18 || shares[node] > 0.32) {
+            std::cerr << "Node " << node << " owns " << fraction << " of labels, " << shares[node] << " of the ring"
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 新增端点只会从现有端点拿走约 1/N 的 label，不会在旧端点之间搬动
+bool TestMinimalMovementOnAdd() {
+    const HashRing before(Nodes(4));
+    const HashRing after(Nodes(5));
+    int moved = 0;
+    for (int i = 0; i < kLabels; ++i) {
+        const std::string label = "timer-" + std::to_string(i);
+        const std::size_t old_owner = before.locate(label);
+        const std::size_t new_owner = after.locate(label);
+        if (old_owner != new_owner) {
+            if (new_owner != 4) {
+                std::cerr << label << " moved between existing endpoints" << std::endl;
+                return false;
+            }
+            ++moved;
+        }
+    }
+    const double fraction = static_cast<double>(moved) / kLabels;
+    if (fraction < 0.12 || fraction > 0.28) {
+        std::cerr << "Adding an endpoint moved " << fraction << " of labels" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 不可用端点上的 label 顺延到其他端点，其余 label 的归属不变
+bool TestSkipUnhealthy() {
+    const HashRing ring(Nodes(4));
+    for (int i = 0; i < kLabels; ++i) {
+        const std::string label = "timer-" + std::to_string(i);
+        const std::size_t owner = ring.locate(label);
+        const std::size_t rerouted = ring.locate(label, [](std::size_t node) { return node != 2; });
+        if ((owner != 2 && rerouted != owner) || rerouted == 2) {
+            std::cerr << label << " was rerouted from " << owner << " to " << rerouted << std::endl;
+            return false;
+        }
+    }
+    if (ring.locate("x", [](std::size_t) { return false; }) != ring.locate("x")) {
+        std::cerr << "With no usable endpoint the original owner should be returned" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+using Stubs = std::vector<std::unique_ptr<mcp_sandtimer::testing::StubSandtimer>>;
+
+// 替身在连接关闭后才记录命令，等到各替身合计收到 count 条
+bool WaitForTotal(const Stubs& stubs, std::size_t first, std::size_t count) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::size_t total = 0;
+        for (std::size_t i = first; i < stubs.size(); ++i) {
+            total += stubs[i]->messages().size();
+        }
+        if (total >= count) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+// 同一 label 的三条命令落在同一个替身上；端点熔断后它的 label 转到其他端点
+bool TestClientRouting() {
+    Stubs stubs;
+    std::vector<mcp_sandtimer::TimerEndpoint> endpoints;
+    for (int i = 0; i < 3; ++i) {
+        stubs.push_back(std::make_unique<mcp_sandtimer::testing::StubSandtimer>());
+        endpoints.push_back({"127.0.0.1", stubs.back()->port()});
+    }
+    mcp_sandtimer::TimerClient client("127.0.0.1", 1, std::chrono::milliseconds(2000));
+    mcp_sandtimer::CircuitBreaker::Options breaker;
+    breaker.failure_threshold = 1;
+    breaker.open_interval = std::chrono::milliseconds(60000);
+    client.set_breaker_options(breaker);
+    client.set_endpoints(endpoints);
+
+    constexpr int kTimers = 30;
+    for (int i = 0; i < kTimers; ++i) {
+        const std::string label = "agent-" + std::to_string(i);
+        client.start_timer(label, 60);
+        client.reset_timer(label);
+        client.cancel_timer(label);
+    }
+    if (!WaitForTotal(stubs, 0, kTimers * 3)) {
+        std::cerr << "Stubs did not receive every command" << std::endl;
+        return false;
+    }
+    std::size_t total = 0;
+    for (const auto& stub : stubs) {
+        const auto commands = stub->commands();
+        total += commands.size();
+        if (commands.empty() || commands.size() % 3 != 0) {
+            std::cerr << "Stub received " << commands.size() << " commands" << std::endl;
+            return false;
+        }
+        for (std::size_t i = 0; i < commands.size(); i += 3) {
+            if (commands[i].op != TimerOp::Start || commands[i + 1].label != commands[i].label ||
+                commands[i + 2].label != commands[i].label) {
+                std::cerr << "Commands for " << commands[i].label << " were split across endpoints" << std::endl;
+                return false;
+            }
+        }
+    }
+    const auto metrics = client.metrics();
+    const auto& shards = metrics.find("shards")->as_array();
+    double routed = 0;
+    for (const auto& shard : shards) {
+        routed += shard.find("commands")->as_number();
+    }
+    if (total != kTimers * 3 || shards.size() != 3 || routed != total) {
+        std::cerr << "Unexpected routing totals: " << metrics.dump() << std::endl;
+        return false;
+    }
+
+    // 停掉第一个端点：第一次发送失败并打开熔断，之后它的 label 由其他端点接收
+    const std::string victim = stubs[0]->commands().front().label.str();
+    stubs[0]->stop();
+    try {
+        client.start_timer(victim, 5);
+        std::cerr << "Send to a stopped endpoint succeeded" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::TimerClientError&) {
+    }
+    client.start_timer(victim, 5);
+    if (!WaitForTotal(stubs, 1, total - stubs[0]->messages().size() + 1)) {
+        std::cerr << "Label was not rerouted after its endpoint failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 调用方取消或超过截止时间的发送不计入分片的 failures
+bool TestAbandonedSendsAreNotShardFailures() {
+    Stubs stubs;
+    std::vector<mcp_sandtimer::TimerEndpoint> endpoints;
+    for (int i = 0; i < 2; ++i) {
+        stubs.push_back(std::make_unique<mcp_sandtimer::testing::StubSandtimer>());
+        endpoints.push_back({"127.0.0.1", stubs.back()->port()});
+    }
+    mcp_sandtimer::TimerClient client("127.0.0.1", 1, std::chrono::milliseconds(2000));
+    client.set_endpoints(endpoints);
+    const mcp_sandtimer::TimerCommand command{TimerOp::Start, "agent", 60};
+
+    mcp_sandtimer::CancellationToken token;
+    token.cancel();
+    mcp_sandtimer::CallOptions cancelled;
+    cancelled.cancellation = &token;
+    mcp_sandtimer::CallOptions expired;
+    expired.deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+    try {
+        client.send(command, cancelled);
+        std::cerr << "Cancelled send succeeded" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::RequestCancelledError&) {
+    }
+    try {
+        client.send(command, expired);
+        std::cerr << "Expired send succeeded" << std::endl;
+        return false;
+    } catch (const mcp_sandtimer::DeadlineExceededError&) {
+    }
+
+    const auto metrics = client.metrics();
+    double failures = 0;
+    double in_flight = 0;
+    for (const auto& shard : metrics.find("shards")->as_array()) {
+        failures += shard.find("failures")->as_number();
+        in_flight += shard.find("inFlight")->as_number();
+    }
+    if (failures != 0 || in_flight != 0) {
+        std::cerr << "Abandoned sends were counted against a shard: " << metrics.dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestBalance()) {
+        return 1;
+    }
+    if (!TestMinimalMovementOnAdd()) {
+        return 1;
+    }
+    if (!TestSkipUnhealthy()) {
+        return 1;
+    }
+    if (!TestClientRouting()) {
+        return 1;
+    }
+    if (!TestAbandonedSendsAreNotShardFailures()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "mcp_sandtimer/Json.h"
+#include "mcp_sandtimer/MCPSandTimerServer.h"
+#include "mcp_sandtimer/TimerEngine.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PipeBuffer.h"
+#include "StubSandtimer.h"
+
+namespace {
+
+using mcp_sandtimer::TimerCommand;
+using mcp_sandtimer::TimerEngine;
+using mcp_sandtimer::TimerOp;
+using mcp_sandtimer::json::Value;
+using std::chrono::milliseconds;
+
+// 到期回调按时触发；被取消的不触发，重新开始的只按最后一次触发一次
+bool TestEngineFiresOnce() {
+    std::mutex mutex;
+    std::condition_variable fired_cv;
+    std::vector<std::string> fired;
+    TimerEngine engine([&](const TimerEngine::Timer& timer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        fired.push_back(timer.label.str());
+        fired_cv.notify_all();
+    });
+    engine.apply(TimerCommand{TimerOp::Start, "quick", 0});
+    engine.apply(TimerCommand{TimerOp::Start, "cancelled", 1});
+    engine.apply(TimerCommand{TimerOp::Cancel, "cancelled", 0});
+    engine.apply(TimerCommand{TimerOp::Start, "again", 1});
+    engine.apply(TimerCommand{TimerOp::Start, "again", 1});
+    engine.apply(TimerCommand{TimerOp::Reset, "unknown", 0});
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        fired_cv.wait_for(lock, milliseconds{3000}, [&] { return fired.size() >= 2; });
+    }
+    std::this_thread::sleep_for(milliseconds{200});
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fired != std::vector<std::string>{"quick", "again"}) {
+        std::cerr << "Unexpected expirations:";
+        for (const auto& label : fired) {
+            std::cerr << ' ' << label;
+        }
+        std::cerr << std::endl;
+        return false;
+    }
+    const auto quick = engine.find("quick");
+    if (!quick || !quick->expired || engine.find("cancelled") || engine.find("unknown") ||
+        engine.stats().fired != 2) {
+        std::cerr << "Unexpected engine state: " << engine.stats().ToJson().dump() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<Value> ParseLines(const std::string& text) {
+    std::vector<Value> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines.push_back(Value::parse(line));
+    }
+    return lines;
+}
+
+std::vector<const Value*> Notifications(const std::vector<Value>& lines, const std::string& method) {
+    std::vector<const Value*> result;
+    for (const auto& line : lines) {
+        const Value* name = line.find("method");
+        if (name != nullptr && name->as_string() == method) {
+            result.push_back(line.find("params"));
+        }
+    }
+    return result;
+}
+
+// 订阅计时器资源后启动倒计时：到期时推送 timer/expired 与 resources/updated，读取资源得到 expired 状态
+bool TestServerPushesExpiry() {
+    mcp_sandtimer::testing::StubSandtimer stub;
+    mcp_sandtimer::testing::PipeBuffer buffer;
+    std::istream input(&buffer);
+    std::ostringstream output;
+    mcp_sandtimer::MCPSandTimerServer server(mcp_sandtimer::TimerClient("127.0.0.1", stub.port()), input, output);
+    std::thread serving([&] { server.Serve(); });
+
+    buffer.write(R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{}})" "\n");
+    buffer.write(R"({"jsonrpc":"2.0","id":2,"method":"resources/subscribe","params":{"uri":"timer://tea%20time"}})" "\n");
+    buffer.write(R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"start_timer","arguments":{"label":"tea time","time":1}}})" "\n");
+    std::this_thread::sleep_for(milliseconds{2000});
+    buffer.write(R"({"jsonrpc":"2.0","id":4,"method":"resources/read","params":{"uri":"timer://tea%20time"}})" "\n");
+    buffer.write(R"({"jsonrpc":"2.0","id":5,"method":"resources/list"})" "\n");
+    buffer.close();
+    serving.join();
+
+    const auto lines = ParseLines(output.str());
+    const auto expired = Notifications(lines, "notifications/timer/expired");
+    const auto updated = Notifications(lines, "notifications/resources/updated");
+    if (expired.size() != 1 || expired[0]->find("label")->as_string() != "tea time" ||
+        expired[0]->find("firedAt") == nullptr || expired[0]->find("startedAt") == nullptr) {
+        std::cerr << "Missing timer/expired notification: " << output.str() << std::endl;
+        return false;
+    }
+    // 启动一次、到期一次
+    if (updated.size() != 2 || updated[1]->find("uri")->as_string() != "timer://tea%20time") {
+        std::cerr << "Unexpected resources/updated notifications: " << output.str() << std::endl;
+        return false;
+    }
+    bool read_expired = false;
+    bool listed = false;
+    for (const auto& line : lines) {
+        const Value* id = line.find("id");
+        const Value* result = line.find("result");
+        if (id == nullptr || result == nullptr) {
+            continue;
+        }
+        if (id->as_number() == 4) {
+            const Value state = Value::parse(result->find("contents")->as_array()[0].find("text")->as_string());
+            read_expired = state.find("state")->as_string() == "expired";
+        } else if (id->as_number() == 5) {
+            listed = result->find("resources")->as_array().size() == 1;
+        } else if (id->as_number() == 1) {
+            const Value* resources = result->find("capabilities")->find("resources");
+            if (resources == nullptr || !resources->find("subscribe")->as_bool()) {
+                std::cerr << "resources capability not advertised" << std::endl;
+                return false;
+            }
+        }
+    }
+    if (!read_expired || !listed) {
+        std::cerr << "Unexpected resource responses: " << output.str() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestEngineFiresOnce()) {
+        return 1;
+    }
+    if (!TestServerPushesExpiry()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "mcp_sandtimer/MCPSandTimerServer.h"
+#include "mcp_sandtimer/ToolRegistry.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using mcp_sandtimer::json::Value;
+
+std::string Frame(const std::string& payload) {
+    return "Content-Length: " + std::to_string(payload.size()) + "\r\n\r\n" + payload;
+}
+
+std::vector<Value> ReadResponses(const std::string& output) {
+    std::vector<Value> responses;
+    std::size_t pos = 0;
+    while ((pos = output.find("Content-Length: ", pos)) != std::string::npos) {
+        pos += 16;
+        const std::size_t length = std::stoul(output.substr(pos));
+        pos = output.find("\r\n\r\n", pos) + 4;
+        responses.push_back(Value::parse(output.substr(pos, length)));
+        pos += length;
+    }
+    return responses;
+}
+
+bool TestManyTools() {
+    mcp_sandtimer::ToolRegistry registry;
+    for (int i = 0; i < 300; ++i) {
+        mcp_sandtimer::ToolDefinition definition{"tool_" + std::to_string(i), "Generated tool.",
+                                                 Value::parse(R"({"type":"object"})")};
+        registry.register_tool(definition, [i](const Value&) { return std::to_string(i); });
+    }
+    for (int i = 0; i < 300; ++i) {
+        const auto* entry = registry.find_tool("tool_" + std::to_string(i));
+        if (entry == nullptr || entry->handler(Value()) != std::to_string(i)) {
+            std::cerr << "Lookup failed for tool_" << i << std::endl;
+            return false;
+        }
+    }
+    if (registry.find_tool("tool_300") != nullptr || registry.tool_count() != 300) {
+        std::cerr << "Registry reported unexpected tools" << std::endl;
+        return false;
+    }
+    // 重复注册替换原条目
+    registry.register_tool(mcp_sandtimer::ToolDefinition{"tool_7", "Replaced.", Value::parse(R"({"type":"object"})")},
+                           [](const Value&) { return std::string("replaced"); });
+    if (registry.tool_count() != 300 || registry.find_tool("tool_7")->handler(Value()) != "replaced") {
+        std::cerr << "Re-registration did not replace the tool" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 嵌入方注册的工具可以通过 tools/list 和 tools/call 访问
+bool TestEmbedderTool() {
+    std::istringstream input(
+        Frame(R"({"jsonrpc":"2.0","id":1,"method":"tools/list"})") +
+        Frame(R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"echo","arguments":{"text":"hi"}}})") +
+        Frame(R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"echo","arguments":{}}})") +
+        Frame(R"({"jsonrpc":"2.0","id":4,"method":"custom/version"})"));
+    std::ostringstream output;
+    mcp_sandtimer::MCPSandTimerServer server(mcp_sandtimer::TimerClient(), input, output);
+    server.registry().register_tool(
+        mcp_sandtimer::ToolDefinition{"echo", "Echo text back.",
+                                      Value::parse(R"({"type":"object","properties":{"text":{"type":"string"}},"required":["text"]})")},
+        [](const Value& arguments) { return arguments.as_object().at("text").as_string(); });
+    server.registry().register_method("custom/version", [](const Value&) { return Value("1"); });
+    server.Serve();
+
+    const auto responses = ReadResponses(output.str());
+    if (responses.size() != 4) {
+        std::cerr << "Expected 4 responses, got " << responses.size() << std::endl;
+        return false;
+    }
+    if (responses[0].as_object().at("result").as_object().at("tools").as_array().size() != 4) {
+        std::cerr << "tools/list did not include the embedder tool" << std::endl;
+        return false;
+    }
+    const auto& content = responses[1].as_object().at("result").as_object().at("content").as_array();
+    if (content.at(0).as_object().at("text").as_string() != "hi") {
+        std::cerr << "Embedder tool handler was not invoked" << std::endl;
+        return false;
+    }
+    const auto& error = responses[2].as_object().at("error").as_object();
+    if (error.at("code").as_number() != -32602 || error.at("data").as_object().at("path").as_string() != "/text") {
+        std::cerr << "Embedder tool schema was not enforced: " << responses[2].dump() << std::endl;
+        return false;
+    }
+    if (responses[3].as_object().at("result").as_string() != "1") {
+        std::cerr << "Embedder method was not dispatched" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!TestManyTools()) {
+        return 1;
+    }
+    if (!TestEmbedderTool()) {
+        return 1;
+    }
+    return 0;
+}